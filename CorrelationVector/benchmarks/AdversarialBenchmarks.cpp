@@ -0,0 +1,105 @@
+//---------------------------------------------------------------------
+// <copyright file="AdversarialBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_c.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct adversarial_input
+{
+    const char* name;
+    std::string value;
+};
+
+// Malformed values an attacker controls through the MS-CV header. Each
+// check must cost about as much as for a short value, whatever the size.
+std::vector<adversarial_input> make_corpus()
+{
+    const std::string base{"KZY+dsX2jEaZesgCPjJ2Ng"};
+    const size_t huge = 4 << 20;
+    return {
+        {"valid", base + ".1.2.3"},
+        {"huge base", std::string(huge, 'A')},
+        {"huge, whitespace at the end",
+         base + '.' + std::string(huge, '1') + ' '},
+        {"huge, many dots", base + std::string(huge, '.')},
+        {"huge, many segments", base + [&]() {
+             std::string segments;
+             while (segments.size() < huge)
+             {
+                 segments += ".4294967295";
+             }
+
+             return segments;
+         }()},
+        {"huge, terminators", base + ".1" + std::string(huge, '!')},
+        {"longest + 1", base + '.' + std::string(127 - base.size(), '1')},
+        {"many dots", base + std::string(105, '.')},
+        {"overflowing digits", base + '.' + std::string(104, '9')},
+        {"overflowing spin", base + ".99999999999999999999.1"},
+        {"stray terminators", base + ".1!.2!.3!"},
+        {"whitespace", base + ".1 .2"},
+    };
+}
+} // namespace
+
+// The cost of rejecting each input of the corpus through validate, the
+// throwing extend and the C API.
+CV_BENCHMARK(adversarial_inputs)
+{
+    const size_t count = microsoft::benchmarks::scaled(20000, scale);
+    const std::vector<adversarial_input> corpus{make_corpus()};
+    size_t accepted = 0;
+    for (const adversarial_input& input : corpus)
+    {
+        const std::string& value = input.value;
+        microsoft::benchmarks::stopwatch watch;
+        for (size_t i = 0; i < count; ++i)
+        {
+            accepted += microsoft::correlation_vector::validate(
+                            value.data(), value.size()) ==
+                        microsoft::validation_result::valid;
+        }
+
+        const double validateSeconds = watch.seconds();
+        watch.restart();
+        for (size_t i = 0; i < count; ++i)
+        {
+            try
+            {
+                microsoft::correlation_vector::extend(value);
+                ++accepted;
+            }
+            catch (const std::invalid_argument&)
+            {
+            }
+        }
+
+        const double extendSeconds = watch.seconds();
+        watch.restart();
+        for (size_t i = 0; i < count; ++i)
+        {
+            cv_handle handle;
+            accepted += cv_extend(&handle, value.data(), value.size()) == CV_OK;
+        }
+
+        const double cSeconds = watch.seconds();
+        std::printf("  %-30s %9zu bytes %8.1f ns validate %8.1f ns extend "
+                    "%8.1f ns cv_extend\n",
+                    input.name,
+                    value.size(),
+                    validateSeconds * 1e9 / count,
+                    extendSeconds * 1e9 / count,
+                    cSeconds * 1e9 / count);
+    }
+
+    std::printf("  %zu accepted\n", accepted);
+}
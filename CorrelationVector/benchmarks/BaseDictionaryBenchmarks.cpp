@@ -0,0 +1,66 @@
+//---------------------------------------------------------------------
+// <copyright file="BaseDictionaryBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/base_dictionary.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A logger interning the base of every record, with a few thousand live
+// bases: a locked map of strings against the dictionary. The record then
+// carries the id and the extensions instead of the value.
+CV_BENCHMARK(base_dictionary_intern)
+{
+    const size_t count = microsoft::benchmarks::scaled(2000000, scale);
+    const size_t baseCount = 4096;
+    const std::vector<std::string> values{
+        microsoft::benchmarks::make_vectors(count, baseCount, 13)};
+
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> map;
+    uint64_t checksum = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (const std::string& value : values)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        checksum += map.emplace(value.substr(0, value.find('.')),
+                                static_cast<uint32_t>(map.size()))
+                        .first->second;
+    }
+
+    microsoft::benchmarks::report(
+        "locked unordered_map", count, 0, watch.seconds());
+
+    microsoft::base_dictionary dictionary{baseCount * 2};
+    size_t valueBytes = 0;
+    size_t recordBytes = 0;
+    watch.restart();
+    for (const std::string& value : values)
+    {
+        checksum += dictionary.intern(value);
+    }
+
+    microsoft::benchmarks::report("base_dictionary", count, 0, watch.seconds());
+
+    // The bytes of the values against the bytes of the ids in decimal
+    // followed by the extensions.
+    for (const std::string& value : values)
+    {
+        const size_t baseLength = value.find('.');
+        valueBytes += value.size();
+        recordBytes += std::to_string(dictionary.find(value)).size() +
+                       value.size() - baseLength;
+    }
+
+    std::printf("  %zu bases, %.1f bytes per value, %.1f per record "
+                "(checksum %llu)\n",
+                dictionary.size(),
+                static_cast<double>(valueBytes) / count,
+                static_cast<double>(recordBytes) / count,
+                static_cast<unsigned long long>(checksum));
+}
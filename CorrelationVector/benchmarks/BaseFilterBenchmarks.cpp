@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------
+// <copyright file="BaseFilterBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/base_filter.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Ingestion dedup: insert the base of every incoming vector, many of which
+// repeat, into an exact set and into the filter.
+CV_BENCHMARK(base_filter_dedup)
+{
+    const size_t count = microsoft::benchmarks::scaled(1000000, scale);
+    std::vector<std::string> values{
+        microsoft::benchmarks::make_vectors(count, count * 9 / 10, 5)};
+
+    microsoft::benchmarks::stopwatch watch;
+    std::unordered_set<std::string> exact;
+    size_t exactNew = 0;
+    for (const std::string& value : values)
+    {
+        exactNew += exact.insert(value.substr(0, value.find('.'))).second;
+    }
+
+    // The nodes of the set: a bucket pointer, the node links and hash, and
+    // the heap block of each base.
+    const size_t exactBytes =
+        exact.bucket_count() * sizeof(void*) +
+        exact.size() * (sizeof(std::string) + 2 * sizeof(void*) + 32);
+    microsoft::benchmarks::report("unordered_set", count, 0, watch.seconds());
+    std::printf("  unordered_set: %zu new bases, %.1f MB\n",
+                exactNew,
+                exactBytes / 1e6);
+
+    for (const double rate : {0.01, 0.001})
+    {
+        microsoft::base_filter filter{count, rate};
+        size_t filterNew = 0;
+        watch.restart();
+        for (const std::string& value : values)
+        {
+            filterNew += filter.insert(value) ? 1 : 0;
+        }
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "base_filter (rate %g)", rate);
+        microsoft::benchmarks::report(label, count, 0, watch.seconds());
+        std::printf("  base_filter: %zu new bases, %.1f MB\n",
+                    filterNew,
+                    filter.memory_size() / 1e6);
+    }
+}
+
+// Lookups of bases never inserted, on every hardware thread.
+CV_BENCHMARK(base_filter_query)
+{
+    const size_t count = microsoft::benchmarks::scaled(1000000, scale);
+    microsoft::base_filter filter{count, 0.01};
+    for (const std::string& value :
+         microsoft::benchmarks::make_vectors(count, count, 7))
+    {
+        filter.insert(value);
+    }
+
+    const std::vector<std::string> queries{
+        microsoft::benchmarks::make_vectors(count, count, 11)};
+    const unsigned int threadCount =
+        std::max<unsigned int>(1, std::thread::hardware_concurrency());
+    std::vector<size_t> found(threadCount, 0);
+    microsoft::benchmarks::stopwatch watch;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (size_t i = t; i < queries.size(); i += threadCount)
+            {
+                found[t] += filter.contains(queries[i]) ? 1 : 0;
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    microsoft::benchmarks::report("contains", count, 0, watch.seconds());
+    size_t falsePositives = 0;
+    for (size_t f : found)
+    {
+        falsePositives += f;
+    }
+
+    std::printf("  %u threads, false positive rate %.4f\n",
+                threadCount,
+                static_cast<double>(falsePositives) / count);
+}
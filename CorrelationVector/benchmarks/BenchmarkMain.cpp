@@ -0,0 +1,51 @@
+//---------------------------------------------------------------------
+// <copyright file="BenchmarkMain.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Usage: cv_benchmarks [--scale <factor>] [name-filter...]
+// The scale factor multiplies every workload size, e.g. --scale 0.01 for a
+// quick smoke run. Filters select benchmarks whose name contains them.
+int main(int argc, char** argv)
+{
+    double scale = 1.0;
+    std::vector<std::string> filters;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+        {
+            scale = std::atof(argv[++i]);
+        }
+        else
+        {
+            filters.push_back(argv[i]);
+        }
+    }
+
+    for (const microsoft::benchmarks::benchmark_case& benchmark :
+         microsoft::benchmarks::registry())
+    {
+        bool selected = filters.empty();
+        for (const std::string& filter : filters)
+        {
+            selected = selected ||
+                       std::string{benchmark.name}.find(filter) !=
+                           std::string::npos;
+        }
+
+        if (selected)
+        {
+            std::printf("%s\n", benchmark.name);
+            benchmark.run(scale);
+        }
+    }
+
+    return 0;
+}
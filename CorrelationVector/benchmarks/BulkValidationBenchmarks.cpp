@@ -0,0 +1,65 @@
+//---------------------------------------------------------------------
+// <copyright file="BulkValidationBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/bulk_validation.h"
+#include "correlation_vector/correlation_vector.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+CV_BENCHMARK(bulk_validation)
+{
+    // Archived vectors of varying depth, one in 20 malformed.
+    const size_t targetBytes = microsoft::benchmarks::scaled(64 << 20, scale);
+    std::vector<std::string> vectors =
+        microsoft::benchmarks::make_vectors(4096, 512);
+    std::string buffer;
+    buffer.reserve(targetBytes + 256);
+    for (size_t i = 0; buffer.size() < targetBytes; ++i)
+    {
+        buffer += i % 20 == 0 ? "tul4NUsfs9Cl7mOf.1.x" : vectors[i % 4096];
+        buffer += '\n';
+    }
+
+    size_t records = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t offset = 0; offset < buffer.size();)
+    {
+        size_t end = buffer.find('\n', offset);
+        try
+        {
+            microsoft::correlation_vector::parse(
+                buffer.substr(offset, end - offset));
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        ++records;
+        offset = end + 1;
+    }
+
+    microsoft::benchmarks::report(
+        "parse per line", records, buffer.size(), watch.seconds());
+
+    const unsigned int cores =
+        std::max<unsigned int>(1, std::thread::hardware_concurrency());
+    for (unsigned int threads = 1; threads <= cores * 2; threads *= 2)
+    {
+        watch.restart();
+        const microsoft::bulk_result result{
+            microsoft::bulk_validation::validate(
+                buffer.data(), buffer.size(), threads)};
+        const std::string label{"bulk, " + std::to_string(threads) +
+                                " thread(s)"};
+        microsoft::benchmarks::report(label.c_str(),
+                                      result.records.size(),
+                                      buffer.size(),
+                                      watch.seconds());
+    }
+}
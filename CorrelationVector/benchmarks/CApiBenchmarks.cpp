@@ -0,0 +1,57 @@
+//---------------------------------------------------------------------
+// <copyright file="CApiBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_c.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The work of a server module per request: extend the incoming vector and
+// write the value of two outbound calls.
+CV_BENCHMARK(c_api_request)
+{
+    const size_t count = microsoft::benchmarks::scaled(1000000, scale);
+    std::vector<std::string> incoming;
+    for (size_t i = 0; i < 256; ++i)
+    {
+        incoming.push_back(
+            microsoft::correlation_vector{
+                microsoft::correlation_vector_version::v2}
+                .increment());
+    }
+
+    size_t sink = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t i = 0; i < count; ++i)
+    {
+        microsoft::correlation_vector cv{
+            microsoft::correlation_vector::extend(incoming[i & 255])};
+        sink += cv.increment().size();
+        sink += cv.increment().size();
+    }
+
+    microsoft::benchmarks::report("correlation_vector", count, 0, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string& value = incoming[i & 255];
+        cv_handle cv;
+        char buffer[CV_MAX_VALUE_LENGTH];
+        size_t length = 0;
+        if (cv_extend(&cv, value.data(), value.size()) == CV_OK &&
+            cv_increment(&cv, buffer, sizeof(buffer), &length) == CV_OK)
+        {
+            sink += length;
+            cv_increment(&cv, buffer, sizeof(buffer), &length);
+            sink += length;
+        }
+    }
+
+    microsoft::benchmarks::report("C interface", count, 0, watch.seconds());
+    std::printf("  (checksum %zu)\n", sink);
+}
@@ -0,0 +1,78 @@
+//---------------------------------------------------------------------
+// <copyright file="CausalOrderBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/causal_order.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct event_record
+{
+    std::string cv;
+    uint64_t timestamp;
+};
+} // namespace
+
+CV_BENCHMARK(causal_compare_pairs)
+{
+    std::vector<std::string> vectors{
+        microsoft::benchmarks::make_vectors(
+            microsoft::benchmarks::scaled(1 << 20, scale), 1000)};
+
+    microsoft::benchmarks::stopwatch watch;
+    int sink = 0;
+    for (size_t i = 1; i < vectors.size(); ++i)
+    {
+        sink += microsoft::causal_compare(vectors[i - 1], vectors[i]);
+    }
+
+    microsoft::benchmarks::report(
+        "causal_compare", vectors.size() - 1, 0, watch.seconds());
+    std::printf("  (checksum %d)\n", sink);
+}
+
+CV_BENCHMARK(causal_sort_strings)
+{
+    const size_t count = microsoft::benchmarks::scaled(10000000, scale);
+    std::vector<std::string> vectors{
+        microsoft::benchmarks::make_vectors(count, count / 100 + 1)};
+    std::vector<std::string> copy{vectors};
+
+    microsoft::benchmarks::stopwatch watch;
+    std::sort(copy.begin(), copy.end(), microsoft::causal_less{});
+    microsoft::benchmarks::report(
+        "std::sort + causal_less", count, 0, watch.seconds());
+
+    watch.restart();
+    microsoft::causal_sort(vectors.begin(), vectors.end());
+    microsoft::benchmarks::report("causal_sort", count, 0, watch.seconds());
+}
+
+CV_BENCHMARK(causal_sort_records)
+{
+    const size_t count = microsoft::benchmarks::scaled(10000000, scale);
+    std::vector<std::string> vectors{
+        microsoft::benchmarks::make_vectors(count, count / 100 + 1)};
+    std::vector<event_record> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        records.push_back({std::move(vectors[i]), i});
+    }
+
+    microsoft::benchmarks::stopwatch watch;
+    microsoft::causal_sort_by(
+        records.begin(),
+        records.end(),
+        [](const event_record& record) -> const std::string& {
+            return record.cv;
+        });
+    microsoft::benchmarks::report(
+        "causal_sort (records)", count, 0, watch.seconds());
+}
@@ -0,0 +1,111 @@
+//---------------------------------------------------------------------
+// <copyright file="ColumnarBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/causal_order.h"
+#include "correlation_vector/columnar.h"
+#include "mapped_file.h"
+#include "simd.h"
+#include "synthetic_traces.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+CV_BENCHMARK(columnar_archive)
+{
+    const size_t count = microsoft::benchmarks::scaled(5000000, scale);
+    std::vector<std::string> vectors{
+        microsoft::benchmarks::make_traces(count)};
+    microsoft::causal_sort(vectors.begin(), vectors.end());
+
+    const std::string textPath{"cv_benchmarks_columnar.txt"};
+    const std::string archivePath{"cv_benchmarks_columnar.cvcol"};
+    {
+        std::ofstream text{textPath, std::ios::binary | std::ios::trunc};
+        for (const std::string& v : vectors)
+        {
+            text << v << '\n';
+        }
+    }
+
+    microsoft::benchmarks::stopwatch watch;
+    {
+        std::ofstream out{archivePath, std::ios::binary | std::ios::trunc};
+        microsoft::columnar_writer writer{out};
+        for (const std::string& v : vectors)
+        {
+            writer.write(v);
+        }
+
+        writer.close();
+    }
+
+    double seconds = watch.seconds();
+    {
+        microsoft::utilities::mapped_file text{textPath};
+        microsoft::utilities::mapped_file archive{archivePath};
+        microsoft::benchmarks::report("write", count, text.size(), seconds);
+        std::printf("  text %zu bytes, archive %zu bytes, ratio %.2fx\n",
+                    text.size(),
+                    archive.size(),
+                    static_cast<double>(text.size()) / archive.size());
+
+        // Baseline: splitting the text file into lines without parsing.
+        watch.restart();
+        size_t lines = 0;
+        const char* end = text.data() + text.size();
+        for (const char* p = text.data(); p < end; ++p)
+        {
+            p = microsoft::utilities::find_byte(p, end, '\n');
+            ++lines;
+        }
+
+        microsoft::benchmarks::report(
+            "text line scan", lines, text.size(), watch.seconds());
+    }
+
+    microsoft::columnar_reader reader{archivePath};
+    watch.restart();
+    size_t segments = 0;
+    microsoft::columnar_reader::cursor cursor{reader.scan()};
+    while (cursor.next())
+    {
+        segments += cursor.segments().size();
+    }
+
+    microsoft::benchmarks::report("columnar scan", count, 0, watch.seconds());
+
+    watch.restart();
+    size_t bytes = 0;
+    cursor = reader.scan();
+    while (cursor.next())
+    {
+        bytes += cursor.value().size();
+    }
+
+    microsoft::benchmarks::report(
+        "columnar scan with value()", count, bytes, watch.seconds());
+
+    const std::string base{vectors[vectors.size() / 2].substr(0, 22)};
+    watch.restart();
+    size_t matches = 0;
+    const size_t iterations = 1000;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        cursor = reader.scan(base);
+        while (cursor.next())
+        {
+            ++matches;
+        }
+    }
+
+    microsoft::benchmarks::report(
+        "filtered scan (one base)", iterations, 0, watch.seconds());
+    std::printf("  (%zu segments, %zu matches)\n", segments, matches);
+
+    std::remove(textPath.c_str());
+    std::remove(archivePath.c_str());
+}
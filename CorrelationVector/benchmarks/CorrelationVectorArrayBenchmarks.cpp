@@ -0,0 +1,69 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorArrayBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_array.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Runs one thread per slot, each incrementing its own vector, and reports
+// the total rate.
+template <typename Slots>
+void increment_slots(const char* label,
+                     Slots& slots,
+                     unsigned int threadCount,
+                     size_t perThread)
+{
+    microsoft::benchmarks::stopwatch watch;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+            for (size_t i = 0; i < perThread; ++i)
+            {
+                slots[t].increment_into(buffer, sizeof(buffer));
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    microsoft::benchmarks::report(
+        label, perThread * threadCount, 0, watch.seconds());
+}
+} // namespace
+
+// Worker slots on adjacent vectors, each incremented by its own thread: a
+// plain vector of correlation_vector against correlation_vector_array.
+CV_BENCHMARK(correlation_vector_array_increment)
+{
+    const unsigned int threadCount =
+        std::max<unsigned int>(2, std::thread::hardware_concurrency());
+    const size_t perThread = microsoft::benchmarks::scaled(2000000, scale);
+
+    std::vector<microsoft::correlation_vector> packed;
+    packed.reserve(threadCount);
+    for (unsigned int t = 0; t < threadCount; ++t)
+    {
+        packed.emplace_back(microsoft::correlation_vector_version::v2);
+    }
+
+    microsoft::correlation_vector_array padded{threadCount};
+    increment_slots("packed", packed, threadCount, perThread);
+    increment_slots("padded", padded, threadCount, perThread);
+    std::printf("  %u threads, %zu bytes per vector, %zu per slot\n",
+                threadCount,
+                sizeof(microsoft::correlation_vector),
+                microsoft::correlation_vector_array::SLOT_SIZE);
+}
@@ -0,0 +1,91 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_view.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The reads of a request that increments its vector for an outbound call and
+// then reads the value for a log line, the header and a metric.
+CV_BENCHMARK(value_reads)
+{
+    const size_t count = microsoft::benchmarks::scaled(2000000, scale);
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    size_t sink = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t i = 0; i < count; ++i)
+    {
+        cv.increment();
+        sink += cv.value().size();
+        sink += cv.value().size();
+        sink += cv.value().size();
+    }
+
+    microsoft::benchmarks::report("value()", count, 0, watch.seconds());
+
+    char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += cv.increment_into(buffer, sizeof(buffer));
+        sink += cv.copy_value(buffer, sizeof(buffer));
+        sink += cv.copy_value(buffer, sizeof(buffer));
+    }
+
+    microsoft::benchmarks::report("copy_value()", count, 0, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        cv.increment();
+        sink += cv.view().size();
+        sink += cv.view().size();
+        sink += cv.view().size();
+    }
+
+    microsoft::benchmarks::report("view()", count, 0, watch.seconds());
+    std::printf("  (checksum %zu)\n", sink);
+}
+
+// A broadcast handler spinning one child per partition.
+CV_BENCHMARK(spin_broadcast)
+{
+    const size_t partitions = 16;
+    const size_t count = microsoft::benchmarks::scaled(100000, scale);
+    const std::string parent{
+        microsoft::correlation_vector{microsoft::correlation_vector_version::v2}
+            .increment()};
+    size_t sink = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t p = 0; p < partitions; ++p)
+        {
+            sink += microsoft::correlation_vector::spin(parent).value().size();
+        }
+    }
+
+    microsoft::benchmarks::report(
+        "spin", count * partitions, 0, watch.seconds());
+
+    std::vector<microsoft::correlation_vector> children(partitions);
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        microsoft::correlation_vector::spin_many(
+            parent, {}, partitions, children.data());
+        for (const microsoft::correlation_vector& child : children)
+        {
+            sink += child.view().size();
+        }
+    }
+
+    microsoft::benchmarks::report(
+        "spin_many", count * partitions, 0, watch.seconds());
+    std::printf("  (checksum %zu)\n", sink);
+}
@@ -0,0 +1,162 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorRegistryBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_registry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+// The map the registry replaces.
+class locked_map
+{
+private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, microsoft::correlation_vector> m_vectors;
+
+public:
+    void insert(const std::string& base,
+                const microsoft::correlation_vector& cv)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_vectors.emplace(base, cv);
+    }
+
+    std::string increment(const std::string& base)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        auto found = m_vectors.find(base);
+        return found == m_vectors.end() ? std::string{}
+                                        : found->second.increment();
+    }
+};
+
+/**
+Draws session indexes with a Zipf distribution of exponent 0.99, so a few
+sessions get most of the events.
+*/
+std::vector<size_t> zipf_keys(size_t sessions, size_t count, unsigned seed)
+{
+    std::vector<double> cumulative(sessions);
+    double total = 0;
+    for (size_t i = 0; i < sessions; ++i)
+    {
+        total += 1.0 / std::pow(static_cast<double>(i + 1), 0.99);
+        cumulative[i] = total;
+    }
+
+    std::mt19937_64 random{seed};
+    std::uniform_real_distribution<double> uniform{0, total};
+    std::vector<size_t> keys(count);
+    for (size_t& key : keys)
+    {
+        key = static_cast<size_t>(
+            std::lower_bound(
+                cumulative.begin(), cumulative.end(), uniform(random)) -
+            cumulative.begin());
+        key = std::min<size_t>(key, sessions - 1);
+    }
+
+    return keys;
+}
+
+template <typename Work>
+double run_threads(size_t threadCount, Work work)
+{
+    std::vector<std::thread> threads;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back(work, t);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return watch.seconds();
+}
+} // namespace
+
+CV_BENCHMARK(registry_increment)
+{
+    const size_t sessions = microsoft::benchmarks::scaled(200000, scale);
+    const size_t perThread = microsoft::benchmarks::scaled(1000000, scale);
+    std::vector<std::string> bases;
+    bases.reserve(sessions);
+    microsoft::correlation_vector_registry registry{sessions};
+    locked_map map;
+    for (size_t i = 0; i < sessions; ++i)
+    {
+        microsoft::correlation_vector cv{
+            microsoft::correlation_vector_version::v2};
+        const std::string value{cv.value()};
+        bases.push_back(value.substr(0, value.rfind('.')));
+        registry.insert(cv);
+        map.insert(bases.back(), cv);
+    }
+
+    for (size_t threadCount : {1, 2, 4})
+    {
+        std::vector<std::vector<size_t>> keys;
+        for (size_t t = 0; t < threadCount; ++t)
+        {
+            keys.push_back(
+                zipf_keys(sessions, perThread, static_cast<unsigned>(t + 1)));
+        }
+
+        const size_t operations = perThread * threadCount;
+        std::vector<size_t> sinks(threadCount);
+        double seconds = run_threads(threadCount, [&](size_t t) {
+            size_t sink = 0;
+            for (size_t key : keys[t])
+            {
+                // The service receives the base as a string, so the map
+                // lookup pays for the key and the returned value.
+                sink += map.increment(std::string{bases[key]}).size();
+            }
+
+            sinks[t] = sink;
+        });
+
+        std::string label{"locked unordered_map, " +
+                          std::to_string(threadCount) + " threads"};
+        microsoft::benchmarks::report(label.c_str(), operations, 0, seconds);
+
+        seconds = run_threads(threadCount, [&](size_t t) {
+            char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+            size_t sink = 0;
+            for (size_t key : keys[t])
+            {
+                const std::string& base = bases[key];
+                sink += registry.increment(
+                    base.data(), base.size(), buffer, sizeof(buffer));
+            }
+
+            sinks[t] += sink;
+        });
+
+        label = "registry, " + std::to_string(threadCount) + " threads";
+        microsoft::benchmarks::report(label.c_str(), operations, 0, seconds);
+
+        size_t sink = 0;
+        for (size_t value : sinks)
+        {
+            sink += value;
+        }
+
+        std::printf("  (checksum %zu)\n", sink);
+    }
+}
@@ -0,0 +1,74 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorViewBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_view.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The read-only work of a logging path: the depth and last extension of an
+// incoming vector, and its base hash for sampling.
+CV_BENCHMARK(view_inspect)
+{
+    const size_t count = microsoft::benchmarks::scaled(1000000, scale);
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 1024; ++i)
+    {
+        microsoft::correlation_vector cv{microsoft::correlation_vector::extend(
+            microsoft::correlation_vector{
+                microsoft::correlation_vector_version::v2}
+                .increment())};
+        for (size_t j = 0; j < i % 7; ++j)
+        {
+            cv.increment();
+        }
+
+        values.push_back(cv.value());
+    }
+
+    size_t sink = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const microsoft::correlation_vector cv{
+            microsoft::correlation_vector::parse(values[i & 1023])};
+        const std::string value{cv.value()};
+        size_t depth = 0;
+        for (char c : value)
+        {
+            depth += c == '.' ? 1 : 0;
+        }
+
+        sink += depth + value.size() + static_cast<size_t>(cv.base_hash());
+    }
+
+    microsoft::benchmarks::report("parse", count, 0, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const microsoft::correlation_vector_view view{values[i & 1023]};
+        sink += view.depth() + static_cast<size_t>(view.last_extension()) +
+                static_cast<size_t>(view.base_hash());
+    }
+
+    microsoft::benchmarks::report("view", count, 0, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const microsoft::correlation_vector_view view{values[i & 1023]};
+        if (view.validate() == microsoft::validation_result::valid)
+        {
+            sink += view.depth() + static_cast<size_t>(view.last_extension()) +
+                    static_cast<size_t>(view.base_hash());
+        }
+    }
+
+    microsoft::benchmarks::report("view, validated", count, 0, watch.seconds());
+    std::printf("  (checksum %zu)\n", sink);
+}
@@ -0,0 +1,217 @@
+//---------------------------------------------------------------------
+// <copyright file="EventRingBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/event_ring.h"
+#include "correlation_vector/latency.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// The logger the ring replaces: each event is formatted into a string and
+// pushed onto a locked queue, which a background thread writes to a file.
+class formatted_logger
+{
+private:
+    std::FILE* m_file;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::string> m_queue;
+    bool m_stopping{false};
+    std::thread m_consumer;
+
+    void _consume()
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        for (;;)
+        {
+            m_wake.wait(lock,
+                        [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                break;
+            }
+
+            std::deque<std::string> batch;
+            batch.swap(m_queue);
+            lock.unlock();
+            for (const std::string& line : batch)
+            {
+                std::fwrite(line.data(), 1, line.size(), m_file);
+            }
+
+            std::fflush(m_file);
+            lock.lock();
+        }
+    }
+
+public:
+    explicit formatted_logger(const char* path)
+        : m_file{std::fopen(path, "wb")}
+        , m_consumer{&formatted_logger::_consume, this}
+    {
+    }
+
+    ~formatted_logger()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopping = true;
+        }
+
+        m_wake.notify_one();
+        m_consumer.join();
+        std::fclose(m_file);
+    }
+
+    void log(const microsoft::correlation_vector& cv,
+             uint32_t eventId,
+             const char* payload)
+    {
+        char line[256];
+        int length = std::snprintf(line,
+                                   sizeof(line),
+                                   "%llu %s %u %s\n",
+                                   static_cast<unsigned long long>(
+                                       microsoft::event_ring::now()),
+                                   cv.value().c_str(),
+                                   eventId,
+                                   payload);
+        std::string entry{line, static_cast<size_t>(length)};
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_queue.push_back(std::move(entry));
+        }
+
+        m_wake.notify_one();
+    }
+};
+
+void print_percentiles(const char* label,
+                       const microsoft::latency_histogram& histogram)
+{
+    std::printf("  %-44s p50 %6llu ns  p99 %7llu ns  p99.9 %8llu ns\n",
+                label,
+                static_cast<unsigned long long>(
+                    histogram.value_at_percentile(50)),
+                static_cast<unsigned long long>(
+                    histogram.value_at_percentile(99)),
+                static_cast<unsigned long long>(
+                    histogram.value_at_percentile(99.9)));
+}
+
+// Runs emit on several threads, timing every call.
+template <typename Emit>
+microsoft::latency_histogram run_producers(unsigned int threadCount,
+                                           size_t eventsPerThread,
+                                           Emit emit,
+                                           double& seconds)
+{
+    std::vector<microsoft::latency_histogram> histograms(threadCount);
+    std::vector<std::thread> threads;
+    microsoft::benchmarks::stopwatch watch;
+    for (unsigned int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&histograms, &emit, t, eventsPerThread]() {
+            microsoft::correlation_vector cv{
+                microsoft::correlation_vector_version::v2};
+            microsoft::latency_histogram& histogram = histograms[t];
+            for (size_t i = 0; i < eventsPerThread; ++i)
+            {
+                auto start = std::chrono::steady_clock::now();
+                emit(cv, static_cast<uint32_t>(i));
+                histogram.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count()));
+                cv.increment();
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    seconds = watch.seconds();
+    microsoft::latency_histogram merged;
+    for (const microsoft::latency_histogram& histogram : histograms)
+    {
+        merged.merge(histogram);
+    }
+
+    return merged;
+}
+} // namespace
+
+// Producer-side latency of tagging an event with a Correlation Vector. Each
+// call is timed with steady_clock, which adds the same clock overhead to
+// both sides.
+CV_BENCHMARK(event_ring_emit)
+{
+    const unsigned int threadCount =
+        std::max<unsigned int>(2, std::thread::hardware_concurrency());
+    const size_t events = microsoft::benchmarks::scaled(500000, scale);
+    const char payload[] = "order.created";
+    const char* path = "cv_benchmark_events.tmp";
+    double seconds = 0;
+
+    {
+        formatted_logger logger{path};
+        microsoft::latency_histogram histogram{run_producers(
+            threadCount,
+            events,
+            [&logger, &payload](const microsoft::correlation_vector& cv,
+                                uint32_t eventId) {
+                logger.log(cv, eventId, payload);
+            },
+            seconds)};
+        microsoft::benchmarks::report(
+            "mutex queue + formatting", events * threadCount, 0, seconds);
+        print_percentiles("mutex queue + formatting", histogram);
+    }
+
+    const microsoft::backpressure policies[] = {
+        microsoft::backpressure::drop, microsoft::backpressure::block};
+    for (microsoft::backpressure policy : policies)
+    {
+        microsoft::file_event_sink sink{path};
+        microsoft::event_ring_options options;
+        options.capacity = 65536;
+        options.policy = policy;
+        microsoft::event_ring ring{sink, options};
+        microsoft::latency_histogram histogram{run_producers(
+            threadCount,
+            events,
+            [&ring, &payload](const microsoft::correlation_vector& cv,
+                              uint32_t eventId) {
+                ring.emit(cv, eventId, payload, sizeof(payload) - 1);
+            },
+            seconds)};
+        ring.flush();
+
+        const char* label = policy == microsoft::backpressure::drop
+                                ? "event_ring (drop)"
+                                : "event_ring (block)";
+        microsoft::benchmarks::report(
+            label, events * threadCount, 0, seconds);
+        print_percentiles(label, histogram);
+        std::printf("  %-44s %llu dropped\n",
+                    label,
+                    static_cast<unsigned long long>(ring.dropped()));
+    }
+
+    std::remove(path);
+}
@@ -0,0 +1,56 @@
+//---------------------------------------------------------------------
+// <copyright file="FlightRecorderBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/flight_recorder.h"
+#include <cstdio>
+#include <string>
+
+namespace
+{
+size_t run(const char* label, size_t count)
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    microsoft::benchmarks::stopwatch watch;
+    size_t sink = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += cv.increment().size();
+    }
+
+    std::string name{std::string{"increment, "} + label};
+    microsoft::benchmarks::report(name.c_str(), count, 0, watch.seconds());
+
+    const std::string value{cv.value()};
+    watch.restart();
+    for (size_t i = 0; i < count / 10; ++i)
+    {
+        sink += microsoft::correlation_vector::extend(value).value().size();
+    }
+
+    name = std::string{"extend, "} + label;
+    microsoft::benchmarks::report(name.c_str(), count / 10, 0, watch.seconds());
+    return sink;
+}
+} // namespace
+
+// Run from a build with USE_FLIGHT_RECORDER; without it, starting the
+// recorder only creates the file.
+CV_BENCHMARK(flight_recorder_overhead)
+{
+    std::printf("  flight recorder %s\n",
+                microsoft::flight_recorder::enabled() ? "enabled"
+                                                      : "disabled");
+    const size_t count = microsoft::benchmarks::scaled(5000000, scale);
+    size_t sink = run("stopped", count);
+
+    const char* path = "cv_benchmark_flight.tmp";
+    microsoft::flight_recorder::start(path);
+    sink += run("recording", count);
+    microsoft::flight_recorder::stop();
+    std::remove(path);
+    std::printf("  (checksum %zu)\n", sink);
+}
@@ -0,0 +1,104 @@
+//---------------------------------------------------------------------
+// <copyright file="GuidBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/guid.h"
+#include "utilities.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Encoding guids with the existing encoders and decoding them back.
+CV_BENCHMARK(guid_codec)
+{
+    const size_t count = microsoft::benchmarks::scaled(2000000, scale);
+    std::vector<microsoft::guid> guids;
+    std::vector<std::string> base64;
+    std::vector<std::string> hex;
+    for (size_t i = 0; i < 1024; ++i)
+    {
+        guids.push_back(microsoft::guid::create());
+        base64.push_back(guids.back().to_base64_string());
+        hex.push_back(guids.back().to_string());
+    }
+
+    size_t sink = 0;
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += guids[i & 1023].to_base64_string().size();
+    }
+
+    microsoft::benchmarks::report("to_base64_string", count, 0, watch.seconds());
+
+    char buffer[22];
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += guids[i & 1023].to_base64(buffer);
+    }
+
+    microsoft::benchmarks::report("to_base64", count, 0, watch.seconds());
+
+    unsigned char bytes[16];
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string& s = base64[i & 1023];
+        sink += microsoft::utilities::base64_decode(s.data(), s.size(), bytes)
+                    ? bytes[0]
+                    : 0;
+    }
+
+    microsoft::benchmarks::report(
+        "base64_decode (scalar)", count, 0, watch.seconds());
+
+    microsoft::guid decoded{microsoft::guid::empty()};
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string& s = base64[i & 1023];
+        sink += microsoft::guid::try_from_base64(s.data(), s.size(), decoded)
+                    ? 1
+                    : 0;
+    }
+
+    microsoft::benchmarks::report("try_from_base64", count, 0, watch.seconds());
+
+    std::vector<const char*> bases;
+    for (const std::string& s : base64)
+    {
+        bases.push_back(s.data());
+    }
+
+    std::vector<microsoft::guid> out(bases.size(), microsoft::guid::empty());
+    watch.restart();
+    for (size_t i = 0; i < count; i += bases.size())
+    {
+        sink += microsoft::guid::from_base64_many(
+            bases.data(), bases.size(), out.data());
+    }
+
+    microsoft::benchmarks::report(
+        "from_base64_many", count, 0, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += guids[i & 1023].to_string().size();
+    }
+
+    microsoft::benchmarks::report("to_string", count, 0, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string& s = hex[i & 1023];
+        sink += microsoft::guid::try_parse(s.data(), s.size(), decoded) ? 1 : 0;
+    }
+
+    microsoft::benchmarks::report("try_parse", count, 0, watch.seconds());
+    std::printf("  (checksum %zu)\n", sink);
+}
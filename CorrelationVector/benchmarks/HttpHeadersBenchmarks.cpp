@@ -0,0 +1,107 @@
+//---------------------------------------------------------------------
+// <copyright file="HttpHeadersBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/http_headers.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+std::string make_block(const std::string& cv)
+{
+    return "GET /api/orders/42?expand=items HTTP/1.1\r\n"
+           "Host: orders.contoso.com\r\n"
+           "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64)\r\n"
+           "Accept: application/json\r\n"
+           "Accept-Language: en-US,en;q=0.9\r\n"
+           "Cookie: MUID=1B2C3D4E5F60718293A4B5C6D7E8F901; mkt=en-US\r\n"
+           "Max-Forwards: 10\r\n"
+           "MS-CV: " +
+           cv +
+           "\r\n"
+           "Connection: keep-alive\r\n\r\n";
+}
+
+// What a proxy does without the helpers: copy the value out of the block,
+// extend it and build the outbound line, all with std::string.
+std::string extend_with_strings(const std::string& block)
+{
+    size_t begin = 0;
+    while (begin < block.size())
+    {
+        size_t end = block.find("\r\n", begin);
+        if (end == begin)
+        {
+            break;
+        }
+
+        std::string line{block.substr(begin, end - begin)};
+        if (line.size() > 6 && (line[0] | 0x20) == 'm' &&
+            (line[1] | 0x20) == 's' && line[2] == '-' &&
+            (line[3] | 0x20) == 'c' && (line[4] | 0x20) == 'v' &&
+            line[5] == ':')
+        {
+            size_t valueBegin = line.find_first_not_of(" \t", 6);
+            std::string value{line.substr(valueBegin)};
+            microsoft::correlation_vector cv{
+                microsoft::correlation_vector::extend(value)};
+            return std::string{microsoft::correlation_vector::HEADER_NAME} +
+                   ": " + cv.increment() + "\r\n";
+        }
+
+        begin = end + 2;
+    }
+
+    return {};
+}
+} // namespace
+
+CV_BENCHMARK(http_header_extend)
+{
+    const size_t count = microsoft::benchmarks::scaled(1000000, scale);
+    std::vector<std::string> vectors{
+        microsoft::benchmarks::make_vectors(1024, 256)};
+    std::vector<std::string> blocks;
+    size_t bytes = 0;
+    for (const std::string& v : vectors)
+    {
+        blocks.push_back(make_block(v));
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        bytes += blocks[i % blocks.size()].size();
+    }
+
+    microsoft::benchmarks::stopwatch watch;
+    size_t sink = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += extend_with_strings(blocks[i % blocks.size()]).size();
+    }
+
+    microsoft::benchmarks::report(
+        "std::string extend + increment", count, bytes, watch.seconds());
+
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::string& block = blocks[i % blocks.size()];
+        char value[128];
+        char line[137];
+        microsoft::header_result extended{microsoft::http_headers::extend(
+            block.data(), block.size(), value, sizeof(value))};
+        size_t valueLength = extended.length;
+        sink += microsoft::http_headers::increment(
+                    value, valueLength, sizeof(value), line, sizeof(line))
+                    .length;
+    }
+
+    microsoft::benchmarks::report(
+        "http_headers extend + increment", count, bytes, watch.seconds());
+    std::printf("  (checksum %zu)\n", sink);
+}
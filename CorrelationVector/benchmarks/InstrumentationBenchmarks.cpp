@@ -0,0 +1,112 @@
+//---------------------------------------------------------------------
+// <copyright file="InstrumentationBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/instrumentation.h"
+#include "correlation_vector/latency.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+void print_latency(const char* name, microsoft::timed_operation operation)
+{
+    microsoft::latency_summary summary{microsoft::latency::summary(operation)};
+    std::printf("  %-10s %10llu calls  p50 %6llu ns  p99 %6llu ns  "
+                "p99.9 %7llu ns  max %9llu ns\n",
+                name,
+                static_cast<unsigned long long>(summary.count),
+                static_cast<unsigned long long>(summary.p50),
+                static_cast<unsigned long long>(summary.p99),
+                static_cast<unsigned long long>(summary.p999),
+                static_cast<unsigned long long>(summary.max));
+}
+} // namespace
+
+// Run from builds with and without USE_INSTRUMENTATION and
+// USE_LATENCY_HISTOGRAMS to compare their cost on the hot path.
+CV_BENCHMARK(instrumentation_overhead)
+{
+    std::printf("  instrumentation %s, latency histograms %s\n",
+                microsoft::instrumentation::enabled() ? "enabled"
+                                                      : "disabled",
+                microsoft::latency::enabled() ? "enabled" : "disabled");
+
+    const size_t count = microsoft::benchmarks::scaled(5000000, scale);
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    microsoft::benchmarks::stopwatch watch;
+    size_t sink = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += cv.increment().size();
+    }
+
+    microsoft::benchmarks::report("increment", count, 0, watch.seconds());
+
+    const std::string value{cv.value()};
+    watch.restart();
+    for (size_t i = 0; i < count / 10; ++i)
+    {
+        sink += microsoft::correlation_vector::extend(value).version() ==
+                microsoft::correlation_vector_version::v2;
+    }
+
+    microsoft::benchmarks::report("extend", count / 10, 0, watch.seconds());
+
+    const unsigned int threadCount =
+        std::max<unsigned int>(2, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    watch.restart();
+    for (unsigned int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([count]() {
+            microsoft::correlation_vector local{
+                microsoft::correlation_vector_version::v2};
+            for (size_t i = 0; i < count; ++i)
+            {
+                local.increment();
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::string label{"increment, " + std::to_string(threadCount) +
+                      " threads"};
+    microsoft::benchmarks::report(
+        label.c_str(), count * threadCount, 0, watch.seconds());
+
+    watch.restart();
+    const size_t snapshots = 10000;
+    for (size_t i = 0; i < snapshots; ++i)
+    {
+        sink += microsoft::instrumentation::snapshot().increments;
+    }
+
+    microsoft::benchmarks::report("snapshot", snapshots, 0, watch.seconds());
+
+    if (microsoft::latency::enabled())
+    {
+        watch.restart();
+        for (size_t i = 0; i < snapshots / 100; ++i)
+        {
+            sink += microsoft::latency::summary(
+                        microsoft::timed_operation::increment)
+                        .count;
+        }
+
+        microsoft::benchmarks::report(
+            "latency summary", snapshots / 100, 0, watch.seconds());
+        print_latency("extend", microsoft::timed_operation::extend);
+        print_latency("increment", microsoft::timed_operation::increment);
+    }
+    std::printf("  (checksum %zu)\n", sink);
+}
@@ -0,0 +1,419 @@
+//---------------------------------------------------------------------
+// <copyright file="MeshSimulator.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "allocation_counter.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/http_headers.h"
+#include "correlation_vector/latency.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Usage: cv_mesh [--services <n>] [--threads <n>] [--fan-out <n>]
+//                [--depth <n>] [--spin <probability>] [--requests <n>]
+//                [--in-flight <n>]
+// Simulates a call graph of in-process services, each a thread pool behind a
+// queue. A request enters the first service; every hop reads the MS-CV
+// header of its message, extends or spins it, and calls fan-out services
+// with incremented vectors until the depth is reached. The graph runs once
+// passing an opaque header instead, and once with Correlation Vectors, to
+// report what they add per hop and end to end.
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+    size_t services{8};
+    size_t threads{2};
+    size_t fan_out{3};
+    size_t depth{4};
+    double spin{0.1};
+    size_t requests{2000};
+    size_t in_flight{16};
+};
+
+struct request
+{
+    clock_type::time_point start;
+    std::atomic<size_t> pending;
+};
+
+struct message
+{
+    std::shared_ptr<request> owner;
+    size_t depth;
+    // The raw header block of the call, e.g. "MS-CV: <value>\r\n\r\n".
+    std::string headers;
+};
+
+// The totals of one run, summed over the worker threads.
+struct totals
+{
+    uint64_t hops{0};
+    uint64_t cv_nanoseconds{0};
+    uint64_t cv_allocations{0};
+    uint64_t terminated{0};
+    uint64_t errors{0};
+};
+
+class service
+{
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::deque<message> m_queue;
+    bool m_stopped{false};
+
+public:
+    void push(message&& m)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_queue.push_back(std::move(m));
+        }
+
+        m_ready.notify_one();
+    }
+
+    bool pop(message& m)
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_ready.wait(lock,
+                     [this]() { return m_stopped || !m_queue.empty(); });
+        if (m_queue.empty())
+        {
+            return false;
+        }
+
+        m = std::move(m_queue.front());
+        m_queue.pop_front();
+        return true;
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stopped = true;
+        }
+
+        m_ready.notify_all();
+    }
+};
+
+class mesh
+{
+private:
+    const options& m_options;
+    const bool m_correlate;
+    std::vector<std::unique_ptr<service>> m_services;
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    size_t m_in_flight{0};
+    microsoft::latency_histogram m_latency;
+    totals m_totals;
+
+    void _complete(const std::shared_ptr<request>& r)
+    {
+        const uint64_t nanoseconds = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock_type::now() - r->start)
+                .count());
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_latency.record(nanoseconds);
+            --m_in_flight;
+        }
+
+        m_done.notify_all();
+    }
+
+    // The Correlation Vector work of one hop: read the incoming header,
+    // extend or spin it, and write the header of every outgoing call.
+    void _correlate(const std::string& headers,
+                    std::mt19937_64& random,
+                    size_t calls,
+                    std::vector<std::string>& outgoing,
+                    totals& local)
+    {
+        const microsoft::header_field field =
+            microsoft::http_headers::find(headers.data(), headers.size());
+        const std::string value{headers.data() + field.offset, field.length};
+        const bool isSpin =
+            std::generate_canonical<double, 32>(random) < m_options.spin;
+        microsoft::correlation_vector cv{
+            isSpin ? microsoft::correlation_vector::spin(value)
+                   : microsoft::correlation_vector::extend(value)};
+        for (size_t c = 0; c < calls; ++c)
+        {
+            const std::string next{cv.increment()};
+            const bool isTerminated =
+                next.back() == microsoft::correlation_vector::TERMINATOR;
+            local.terminated += isTerminated ? 1 : 0;
+            outgoing[c] = "MS-CV: " + next + "\r\n\r\n";
+        }
+    }
+
+    void _work(size_t index, totals& local)
+    {
+        service& self = *m_services[index];
+        std::mt19937_64 random{index * 7919 + 1};
+        std::vector<std::string> outgoing(m_options.fan_out);
+        message m;
+        while (self.pop(m))
+        {
+            ++local.hops;
+            const size_t calls =
+                m.depth < m_options.depth ? m_options.fan_out : 0;
+            if (m_correlate)
+            {
+                const uint64_t allocations = microsoft::tests::allocations();
+                const clock_type::time_point start = clock_type::now();
+                try
+                {
+                    _correlate(m.headers, random, calls, outgoing, local);
+                }
+                catch (const std::exception&)
+                {
+                    ++local.errors;
+                    std::fill(outgoing.begin(), outgoing.end(), m.headers);
+                }
+
+                local.cv_nanoseconds += static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock_type::now() - start)
+                        .count());
+                local.cv_allocations +=
+                    microsoft::tests::allocations() - allocations;
+            }
+            else
+            {
+                std::fill(
+                    outgoing.begin(), outgoing.begin() + calls, m.headers);
+            }
+
+            // The calls of the hop replace it in the pending count.
+            std::shared_ptr<request> owner = std::move(m.owner);
+            owner->pending.fetch_add(calls, std::memory_order_relaxed);
+            for (size_t c = 0; c < calls; ++c)
+            {
+                const size_t target =
+                    (index + 1 + c + m.depth * m_options.fan_out) %
+                    m_services.size();
+                m_services[target]->push(
+                    message{owner, m.depth + 1, std::move(outgoing[c])});
+            }
+
+            if (owner->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                _complete(owner);
+            }
+        }
+    }
+
+public:
+    mesh(const options& options, bool correlate)
+        : m_options{options}, m_correlate{correlate}
+    {
+        for (size_t s = 0; s < options.services; ++s)
+        {
+            m_services.emplace_back(new service{});
+        }
+    }
+
+    void run()
+    {
+        const size_t workerCount = m_options.services * m_options.threads;
+        std::vector<totals> locals(workerCount);
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < workerCount; ++w)
+        {
+            workers.emplace_back([this, w, &locals]() {
+                _work(w % m_services.size(), locals[w]);
+            });
+        }
+
+        for (size_t r = 0; r < m_options.requests; ++r)
+        {
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                m_done.wait(lock, [this]() {
+                    return m_in_flight < m_options.in_flight;
+                });
+                ++m_in_flight;
+            }
+
+            std::shared_ptr<request> owner{new request{}};
+            owner->start = clock_type::now();
+            owner->pending.store(1, std::memory_order_relaxed);
+            const std::string root{
+                m_correlate ? microsoft::correlation_vector{
+                                  microsoft::correlation_vector_version::v2}
+                                  .value()
+                            : std::string(24, 'x')};
+            m_services[0]->push(
+                message{owner, 0, "MS-CV: " + root + "\r\n\r\n"});
+        }
+
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_done.wait(lock, [this]() { return m_in_flight == 0; });
+        }
+
+        for (std::unique_ptr<service>& s : m_services)
+        {
+            s->stop();
+        }
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        for (const totals& local : locals)
+        {
+            m_totals.hops += local.hops;
+            m_totals.cv_nanoseconds += local.cv_nanoseconds;
+            m_totals.cv_allocations += local.cv_allocations;
+            m_totals.terminated += local.terminated;
+            m_totals.errors += local.errors;
+        }
+    }
+
+    const microsoft::latency_histogram& latency() const { return m_latency; }
+
+    const totals& result() const { return m_totals; }
+};
+
+struct run_result
+{
+    double cpu_seconds;
+    uint64_t allocations;
+};
+
+run_result run(mesh& m)
+{
+    const std::clock_t cpu = std::clock();
+    const uint64_t allocations = microsoft::tests::total_allocations();
+    m.run();
+    return {static_cast<double>(std::clock() - cpu) / CLOCKS_PER_SEC,
+            microsoft::tests::total_allocations() - allocations};
+}
+
+void print_latency(const char* label, const microsoft::latency_histogram& h)
+{
+    std::printf("  %-12s p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+                label,
+                h.value_at_percentile(50) / 1e3,
+                h.value_at_percentile(99) / 1e3,
+                h.max() / 1e3);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options o;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (std::strcmp(name, "--services") == 0)
+        {
+            o.services = std::max<size_t>(std::atoi(value), 1);
+        }
+        else if (std::strcmp(name, "--threads") == 0)
+        {
+            o.threads = std::max<size_t>(std::atoi(value), 1);
+        }
+        else if (std::strcmp(name, "--fan-out") == 0)
+        {
+            o.fan_out = std::max<size_t>(std::atoi(value), 1);
+        }
+        else if (std::strcmp(name, "--depth") == 0)
+        {
+            o.depth = static_cast<size_t>(std::atoi(value));
+        }
+        else if (std::strcmp(name, "--spin") == 0)
+        {
+            o.spin = std::atof(value);
+        }
+        else if (std::strcmp(name, "--requests") == 0)
+        {
+            o.requests = std::max<size_t>(std::atoi(value), 1);
+        }
+        else if (std::strcmp(name, "--in-flight") == 0)
+        {
+            o.in_flight = std::max<size_t>(std::atoi(value), 1);
+        }
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s\n", name);
+            return 1;
+        }
+    }
+
+    std::printf("%zu services x %zu threads, fan-out %zu, depth %zu, "
+                "spin %.2f, %zu requests, %zu in flight\n",
+                o.services,
+                o.threads,
+                o.fan_out,
+                o.depth,
+                o.spin,
+                o.requests,
+                o.in_flight);
+
+    mesh baseline{o, false};
+    const run_result base = run(baseline);
+    mesh correlated{o, true};
+    const run_result cv = run(correlated);
+
+    const totals& t = correlated.result();
+    const double hops = static_cast<double>(t.hops);
+    std::printf("  %llu hops per run, %.0f per request\n",
+                static_cast<unsigned long long>(t.hops),
+                hops / o.requests);
+    std::printf("  cV work per hop:   %8.1f ns, %.2f allocations\n",
+                t.cv_nanoseconds / hops,
+                t.cv_allocations / hops);
+    std::printf("  CPU per hop:       %8.1f ns baseline, %8.1f ns with cV\n",
+                base.cpu_seconds * 1e9 / baseline.result().hops,
+                cv.cpu_seconds * 1e9 / hops);
+    std::printf("  allocations/hop:   %8.2f baseline, %8.2f with cV\n",
+                static_cast<double>(base.allocations) /
+                    baseline.result().hops,
+                cv.allocations / hops);
+    std::printf("  terminated calls:  %llu (%.4f%%), %llu errors\n",
+                static_cast<unsigned long long>(t.terminated),
+                100.0 * t.terminated /
+                    std::max<double>(hops - o.requests, 1),
+                static_cast<unsigned long long>(t.errors));
+    print_latency("baseline", baseline.latency());
+    print_latency("with cV", correlated.latency());
+    for (const double percentile : {50.0, 99.0})
+    {
+        const double added =
+            static_cast<double>(
+                correlated.latency().value_at_percentile(percentile)) -
+            static_cast<double>(
+                baseline.latency().value_at_percentile(percentile));
+        std::printf("  added at p%-3g     %8.1f us\n", percentile, added / 1e3);
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+//---------------------------------------------------------------------
+// <copyright file="SharedCorrelationVectorBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/shared_correlation_vector.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+CV_BENCHMARK(shared_increment)
+{
+    const size_t count = microsoft::benchmarks::scaled(2000000, scale);
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    microsoft::shared_correlation_vector::remove(cv);
+    size_t sink = 0;
+
+    microsoft::correlation_vector local{
+        microsoft::correlation_vector::parse(cv.value())};
+    microsoft::benchmarks::stopwatch watch;
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += local.increment().size();
+    }
+
+    microsoft::benchmarks::report(
+        "correlation_vector::increment", count, 0, watch.seconds());
+
+    microsoft::shared_correlation_vector shared{cv};
+    watch.restart();
+    for (size_t i = 0; i < count; ++i)
+    {
+        sink += shared.increment().size();
+    }
+
+    microsoft::benchmarks::report(
+        "shared increment, 1 process", count, 0, watch.seconds());
+
+#if !defined(_WIN32)
+    // Total throughput of forked workers that attach by base and increment
+    // the same counter, as pre-fork servers would.
+    for (int processes : {2, 4})
+    {
+        const size_t perProcess = count / processes;
+        std::vector<pid_t> children;
+        watch.restart();
+        for (int p = 0; p < processes; ++p)
+        {
+            pid_t child = fork();
+            if (child == 0)
+            {
+                microsoft::shared_correlation_vector attached{cv};
+                size_t length = 0;
+                for (size_t i = 0; i < perProcess; ++i)
+                {
+                    length += attached.increment().size();
+                }
+
+                _exit(length == 0 ? 1 : 0);
+            }
+
+            if (child > 0)
+            {
+                children.push_back(child);
+            }
+        }
+
+        for (pid_t child : children)
+        {
+            int status = 0;
+            waitpid(child, &status, 0);
+        }
+
+        const std::string label{"shared increment, " +
+                                std::to_string(processes) + " processes"};
+        microsoft::benchmarks::report(label.c_str(),
+                                      perProcess * children.size(),
+                                      0,
+                                      watch.seconds());
+    }
+#endif
+
+    std::printf("  final %s (checksum %zu)\n", shared.value().c_str(), sink);
+    microsoft::shared_correlation_vector::remove(cv);
+}
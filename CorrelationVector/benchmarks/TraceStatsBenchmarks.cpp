@@ -0,0 +1,64 @@
+//---------------------------------------------------------------------
+// <copyright file="TraceStatsBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/trace_stats.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per-base statistics of an event stream, on one thread and sharded over
+// every hardware thread.
+CV_BENCHMARK(trace_stats_aggregate)
+{
+    const size_t count = microsoft::benchmarks::scaled(4000000, scale);
+    const std::vector<std::string> values{
+        microsoft::benchmarks::make_vectors(count, count / 16 + 1)};
+    size_t bytes = 0;
+    for (const std::string& value : values)
+    {
+        bytes += value.size();
+    }
+
+    microsoft::benchmarks::stopwatch watch;
+    microsoft::trace_stats stats;
+    for (const std::string& value : values)
+    {
+        stats.add(value);
+    }
+
+    microsoft::benchmarks::report("add", count, bytes, watch.seconds());
+
+    // With few bases the table stays in cache, leaving the cost of parsing.
+    const std::vector<std::string> hot{
+        microsoft::benchmarks::make_vectors(count, 1000)};
+    size_t hotBytes = 0;
+    for (const std::string& value : hot)
+    {
+        hotBytes += value.size();
+    }
+
+    watch.restart();
+    microsoft::trace_stats hotStats;
+    for (const std::string& value : hot)
+    {
+        hotStats.add(value);
+    }
+
+    microsoft::benchmarks::report(
+        "add, 1000 bases", count, hotBytes, watch.seconds());
+
+    const unsigned int threadCount =
+        std::max<unsigned int>(1, std::thread::hardware_concurrency());
+    watch.restart();
+    const microsoft::trace_stats merged{microsoft::trace_stats::aggregate(
+        values.data(), values.size(), threadCount)};
+    microsoft::benchmarks::report("aggregate", count, bytes, watch.seconds());
+    std::printf("  %u threads, %zu bases, %zu summaries\n",
+                threadCount,
+                merged.size(),
+                merged.summaries().size());
+}
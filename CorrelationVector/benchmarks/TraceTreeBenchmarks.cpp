@@ -0,0 +1,63 @@
+//---------------------------------------------------------------------
+// <copyright file="TraceTreeBenchmarks.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "benchmark.h"
+#include "correlation_vector/trace_tree.h"
+#include "synthetic_traces.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+CV_BENCHMARK(trace_forest_build)
+{
+    const size_t count = microsoft::benchmarks::scaled(10000000, scale);
+    microsoft::benchmarks::stopwatch watch;
+    std::vector<std::string> vectors{
+        microsoft::benchmarks::make_traces(count)};
+    microsoft::benchmarks::report(
+        "make_traces (generator)", count, 0, watch.seconds());
+
+    size_t bytes = 0;
+    for (const std::string& v : vectors)
+    {
+        bytes += v.size() + 1;
+    }
+
+    for (unsigned int threads : {1u, std::thread::hardware_concurrency()})
+    {
+        microsoft::trace_forest_builder builder;
+        builder.reserve(count);
+        for (const std::string& v : vectors)
+        {
+            builder.add(v);
+        }
+
+        watch.restart();
+        microsoft::trace_forest forest{builder.build(threads)};
+        double seconds = watch.seconds();
+        std::string label{"build, " + std::to_string(threads) + " thread(s), " +
+                          std::to_string(forest.trees().size()) + " trees"};
+        microsoft::benchmarks::report(label.c_str(), count, bytes, seconds);
+
+        if (threads == std::thread::hardware_concurrency())
+        {
+            watch.restart();
+            size_t found = 0;
+            for (size_t i = 0; i < vectors.size(); i += 16)
+            {
+                found += forest.children(vectors[i]).size();
+            }
+
+            microsoft::benchmarks::report(
+                "children queries", count / 16 + 1, 0, watch.seconds());
+            std::printf("  (%zu children found)\n", found);
+        }
+
+        if (threads == 1 && std::thread::hardware_concurrency() == 1)
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+//---------------------------------------------------------------------
+// <copyright file="benchmark.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/guid.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+namespace benchmarks
+{
+using benchmark_function = void (*)(double scale);
+
+struct benchmark_case
+{
+    const char* name;
+    benchmark_function run;
+};
+
+inline std::vector<benchmark_case>& registry()
+{
+    static std::vector<benchmark_case> cases;
+    return cases;
+}
+
+struct registrar
+{
+    registrar(const char* name, benchmark_function run)
+    {
+        registry().push_back({name, run});
+    }
+};
+
+/**
+Defines a benchmark that is registered with the cv_benchmarks runner. The
+body receives a scale factor that should be applied to its workload size.
+*/
+#define CV_BENCHMARK(name)                                                     \
+    static void name(double scale);                                            \
+    static ::microsoft::benchmarks::registrar name##_registrar{#name, &name};   \
+    static void name(double scale)
+
+class stopwatch
+{
+private:
+    std::chrono::steady_clock::time_point m_start{
+        std::chrono::steady_clock::now()};
+
+public:
+    void restart() { m_start = std::chrono::steady_clock::now(); }
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             m_start)
+            .count();
+    }
+};
+
+inline size_t scaled(size_t count, double scale)
+{
+    size_t result = static_cast<size_t>(static_cast<double>(count) * scale);
+    return result == 0 ? 1 : result;
+}
+
+/**
+Prints one result line. Bytes may be zero when throughput is not meaningful.
+*/
+inline void report(const char* label,
+                   size_t operations,
+                   size_t bytes,
+                   double seconds)
+{
+    std::printf("  %-44s %12.0f ops/s %10.1f ns/op",
+                label,
+                operations / seconds,
+                seconds * 1e9 / operations);
+    if (bytes > 0)
+    {
+        std::printf(" %8.3f GB/s", bytes / seconds / 1e9);
+    }
+
+    std::printf("\n");
+}
+
+/**
+Generates realistic Correlation Vector strings: v2 bases created from guids,
+each followed by a few extensions of varying magnitude.
+*/
+inline std::vector<std::string> make_vectors(size_t count,
+                                             size_t baseCount,
+                                             uint64_t seed = 42)
+{
+    std::vector<std::string> bases;
+    bases.reserve(baseCount);
+    for (size_t i = 0; i < baseCount; ++i)
+    {
+        bases.push_back(guid::create().to_base64_string());
+    }
+
+    std::mt19937_64 random{seed};
+    std::vector<std::string> vectors;
+    vectors.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string cv{bases[random() % baseCount]};
+        size_t depth = 1 + random() % 6;
+        for (size_t d = 0; d < depth; ++d)
+        {
+            cv += '.';
+            cv += std::to_string(random() % (d == 0 ? 4 : 16));
+        }
+
+        vectors.push_back(std::move(cv));
+    }
+
+    return vectors;
+}
+} // namespace benchmarks
+} // namespace microsoft
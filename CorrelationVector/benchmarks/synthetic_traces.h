@@ -0,0 +1,79 @@
+//---------------------------------------------------------------------
+// <copyright file="synthetic_traces.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+namespace benchmarks
+{
+struct trace_shape
+{
+    // Maximum number of outbound calls made by each service.
+    unsigned int max_fan_out{4};
+    // Maximum number of hops below the root service.
+    unsigned int max_depth{5};
+    // Probability that a callee spins instead of extending.
+    double spin_probability{0.05};
+};
+
+/**
+Generates the Correlation Vectors a fleet of services would log, using the
+library itself: every service extends (or spins) the inbound vector, logs it,
+and increments it once per outbound call. Traces are generated until count
+vectors exist and are then shuffled, as if collected from many log files.
+*/
+inline std::vector<std::string> make_traces(size_t count,
+                                            const trace_shape& shape = {},
+                                            uint64_t seed = 42)
+{
+    std::mt19937_64 random{seed};
+    std::uniform_real_distribution<double> coin{0.0, 1.0};
+    std::vector<std::string> vectors;
+    vectors.reserve(count);
+
+    while (vectors.size() < count)
+    {
+        std::deque<std::pair<correlation_vector, unsigned int>> services;
+        services.emplace_back(
+            correlation_vector{correlation_vector_version::v2}, 0);
+        while (!services.empty() && vectors.size() < count)
+        {
+            correlation_vector& cv = services.front().first;
+            const unsigned int depth = services.front().second;
+            vectors.push_back(cv.value());
+
+            const unsigned int calls =
+                depth < shape.max_depth
+                    ? static_cast<unsigned int>(random() %
+                                                (shape.max_fan_out + 1))
+                    : 0;
+            for (unsigned int i = 0; i < calls && vectors.size() < count; ++i)
+            {
+                std::string header{cv.increment()};
+                vectors.push_back(header);
+                services.emplace_back(coin(random) < shape.spin_probability
+                                          ? correlation_vector::spin(header)
+                                          : correlation_vector::extend(header),
+                                      depth + 1);
+            }
+
+            services.pop_front();
+        }
+    }
+
+    std::shuffle(vectors.begin(), vectors.end(), random);
+    return vectors;
+}
+} // namespace benchmarks
+} // namespace microsoft
@@ -5,6 +5,31 @@ set (BUILD_TESTS
      CACHE BOOL
            "Indicates if tests should be built.")
 
+set (BUILD_BENCHMARKS
+     OFF
+     CACHE BOOL
+           "Indicates if benchmarks should be built.")
+
+set (BUILD_TOOLS
+     OFF
+     CACHE BOOL
+           "Indicates if command-line tools should be built.")
+
+set (USE_INSTRUMENTATION
+     OFF
+     CACHE BOOL
+           "Indicates if lifecycle counters should be compiled in.")
+
+set (USE_LATENCY_HISTOGRAMS
+     OFF
+     CACHE BOOL
+           "Indicates if latency histograms should be compiled in.")
+
+set (USE_FLIGHT_RECORDER
+     OFF
+     CACHE BOOL
+           "Indicates if the flight recorder should be compiled in.")
+
 set (USE_STATIC_C_RUNTIME
      OFF
      CACHE BOOL
@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------
+// <copyright file="base_dictionary.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_view.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+/**
+A concurrent dictionary of the live Correlation Vector bases of a process,
+each mapped to a small integer id, so that log records can carry the id and
+the extensions instead of the whole base. The mapping from ids to bases is
+written to a side file with dump().
+
+Looking up a base that has an id takes no lock: the index is probed with
+atomic loads and each entry is read under a sequence lock. Only new bases
+take a mutex. Time is split into epochs by advance_epoch(): a base that was
+not looked up during the last few epochs is evicted and its id is reused
+for a later base, so a log record resolves through the dump of the epoch it
+was written in.
+*/
+class base_dictionary
+{
+private:
+    // A base and its length, zero-padded to three words.
+    struct key
+    {
+        uint64_t words[3];
+    };
+
+    struct entry
+    {
+        // Odd while the entry is being written.
+        std::atomic<uint32_t> sequence;
+        // The low half of the hash of the base, only used under the mutex.
+        uint32_t hash;
+        // The last epoch the base was looked up in.
+        std::atomic<uint64_t> epoch;
+        std::atomic<uint64_t> words[3];
+    };
+
+    std::unique_ptr<entry[]> m_entries;
+    // The ids of the entries, by hash: the low half of the hash in the top
+    // 32 bits and the id plus one in the bottom 32 bits, or 0 if free.
+    std::unique_ptr<std::atomic<uint64_t>[]> m_slots;
+    size_t m_capacity{0};
+    size_t m_mask{0};
+    uint32_t m_retained_epochs{0};
+    std::atomic<uint64_t> m_epoch{0};
+    mutable std::mutex m_mutex;
+    // The ids without a base, used under the mutex.
+    std::vector<uint32_t> m_free;
+
+    static size_t _base_length(
+        correlation_vector_view correlationVector) noexcept;
+
+    static bool _key(const char* base, size_t length, key& out) noexcept;
+
+    uint32_t _find(const key& key, uint64_t hash) const noexcept;
+
+    uint32_t _insert(const key& key, uint64_t hash);
+
+    void _erase_slot(uint32_t id) noexcept;
+
+    bool _read(uint32_t id, key& out) const noexcept;
+
+    uint32_t _intern(const char* base, size_t length, uint64_t hash);
+
+public:
+    // The id of bases that are not in the dictionary.
+    static constexpr const uint32_t NO_ID = UINT32_MAX;
+
+    // The longest base the dictionary holds: the base of a v2 vector.
+    static constexpr const size_t MAX_BASE_LENGTH = 22;
+
+    /**
+    Initializes an empty dictionary.
+    @param capacity The number of bases the dictionary holds at once. Ids are
+    below the capacity.
+    @param retainedEpochs The number of epochs a base stays in the dictionary
+    after the epoch it was last looked up in. It is at least 1, so an id
+    obtained in an epoch resolves to the same base until the next one ends.
+    @throw std::invalid_argument if the capacity is 0 or above 2^30, or
+    retainedEpochs is 0
+    */
+    explicit base_dictionary(size_t capacity = 4096,
+                             uint32_t retainedEpochs = 2);
+
+    base_dictionary(const base_dictionary&) = delete;
+    base_dictionary& operator=(const base_dictionary&) = delete;
+
+    /**
+    Gets the id of the base of a Correlation Vector, adding the base if it is
+    new.
+    @param correlationVector The Correlation Vector.
+    @return The id, or NO_ID if the dictionary is full
+    */
+    uint32_t intern(const correlation_vector& correlationVector);
+
+    /**
+    Gets the id of a base, adding it if it is new. The base is not
+    validated, e.g. a header value may be passed as is.
+    @param correlationVector The base, or a value starting with it.
+    @return The id, or NO_ID if the dictionary is full or the base is empty
+    or longer than MAX_BASE_LENGTH
+    */
+    uint32_t intern(correlation_vector_view correlationVector);
+
+    /**
+    Gets the id of a base without adding it. Finding a base counts as a use
+    for eviction, like intern.
+    @param correlationVector The base, or a value starting with it.
+    @return The id, or NO_ID if the base is not in the dictionary
+    */
+    uint32_t find(correlation_vector_view correlationVector) const noexcept;
+
+    /**
+    Gets the base that has an id.
+    @param id The id.
+    @return The base, or an empty string if no base has the id
+    */
+    std::string resolve(uint32_t id) const;
+
+    /**
+    Gets the current epoch, starting at 0.
+    */
+    uint64_t epoch() const noexcept
+    {
+        return m_epoch.load(std::memory_order_relaxed);
+    }
+
+    /**
+    Starts a new epoch and evicts the bases that were not looked up during
+    the retained epochs. Call dump() first to keep the mapping of the epoch
+    that ends.
+    @return The number of evicted bases
+    */
+    size_t advance_epoch();
+
+    /**
+    Writes the current mapping as text: a line "epoch <epoch>", then one
+    line "<id> <base>" per base, by id.
+    @param out The stream, e.g. a side file of the log.
+    */
+    void dump(std::ostream& out) const;
+
+    /**
+    Gets the number of bases in the dictionary.
+    */
+    size_t size() const;
+
+    /**
+    Gets the number of bases the dictionary holds at once.
+    */
+    size_t capacity() const noexcept { return m_capacity; }
+};
+} // namespace microsoft
@@ -0,0 +1,149 @@
+//---------------------------------------------------------------------
+// <copyright file="base_filter.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/guid.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace microsoft
+{
+/**
+A fixed-size approximate set of Correlation Vector bases, e.g. to drop
+duplicate trace roots at ingestion without an exact set that grows with
+traffic. A base that was inserted is always found; a base that was not is
+found with about the false positive rate chosen at construction, as long as
+no more than the expected number of bases are inserted.
+
+The filter is a blocked Bloom filter: each base sets and tests a few bits in
+one 64-byte block, so a lookup touches a single cache line. Inserts and
+lookups are lock-free and may run on any number of threads at once. Bases
+are hashed straight from the given bytes; a value with extensions, e.g. a
+header value, may be passed as is and only its base is used.
+*/
+class base_filter
+{
+private:
+    static constexpr const size_t BLOCK_WORDS = 8;
+    static constexpr const size_t BLOCK_BITS = BLOCK_WORDS * 64;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> m_storage;
+    // The blocks, aligned to cache lines within m_storage.
+    std::atomic<uint64_t>* m_words{nullptr};
+    size_t m_block_count{0};
+    int m_hash_count{0};
+
+    static uint64_t _hash(const char* correlationVector,
+                          size_t length) noexcept;
+
+    // The top half of the hash picks the block.
+    size_t _block(uint64_t hash) const noexcept
+    {
+        return static_cast<size_t>((hash >> 32) * m_block_count >> 32);
+    }
+
+    // The positions of the bits in the block, 9 bits each: seven of them
+    // per round, starting with the given bit.
+    static uint64_t _bits(uint64_t hash, int bit) noexcept
+    {
+        uint64_t bits = hash + static_cast<uint64_t>(bit + 1) *
+                                   0x9E3779B97F4A7C15ULL;
+        bits = (bits ^ (bits >> 32)) * 0xD6E8FEB86659FD93ULL;
+        return bits ^ (bits >> 32);
+    }
+
+    double _false_positive_rate(double count) const noexcept;
+
+    bool _insert(uint64_t hash) noexcept;
+
+    bool _contains(uint64_t hash) const noexcept;
+
+public:
+    /**
+    Initializes an empty filter.
+    @param expectedCount The number of bases the filter is sized for.
+    Inserting more raises the false positive rate.
+    @param falsePositiveRate The fraction of bases never inserted that are
+    found anyway, between 0 and 1 exclusive. Each halving costs about 1.44
+    bits of memory per expected base.
+    @throw std::invalid_argument if falsePositiveRate is out of range
+    */
+    base_filter(size_t expectedCount, double falsePositiveRate);
+
+    base_filter(const base_filter&) = delete;
+    base_filter& operator=(const base_filter&) = delete;
+
+    /**
+    Adds the base of a Correlation Vector.
+    @param correlationVector The base, or a value starting with it.
+    @param length The length of the value.
+    @return true if the base was certainly not in the filter before. When
+    threads insert the same base at once, more than one may get true.
+    */
+    bool insert(const char* correlationVector, size_t length) noexcept
+    {
+        return _insert(_hash(correlationVector, length));
+    }
+
+    bool insert(const std::string& correlationVector) noexcept
+    {
+        return insert(correlationVector.data(), correlationVector.size());
+    }
+
+    /**
+    Adds the base of the v2 Correlation Vectors created from a guid, i.e.
+    its base64 encoding.
+    @param guid The guid.
+    @return true if the base was certainly not in the filter before
+    */
+    bool insert(const guid& guid) noexcept;
+
+    /**
+    Determines whether the base of a Correlation Vector may have been
+    inserted.
+    @param correlationVector The base, or a value starting with it.
+    @param length The length of the value.
+    @return false if the base was certainly never inserted
+    */
+    bool contains(const char* correlationVector, size_t length) const noexcept
+    {
+        return _contains(_hash(correlationVector, length));
+    }
+
+    bool contains(const std::string& correlationVector) const noexcept
+    {
+        return contains(correlationVector.data(), correlationVector.size());
+    }
+
+    /**
+    Determines whether the base of the v2 Correlation Vectors created from
+    a guid may have been inserted.
+    */
+    bool contains(const guid& guid) const noexcept;
+
+    /**
+    Removes every base. This must not run concurrently with inserts, which
+    may otherwise be lost.
+    */
+    void clear() noexcept;
+
+    /**
+    Gets the size of the filter in bytes, which does not change.
+    */
+    size_t memory_size() const noexcept
+    {
+        return m_block_count * BLOCK_WORDS * sizeof(uint64_t);
+    }
+
+    /**
+    Gets the number of bits each base sets.
+    */
+    int hash_count() const noexcept { return m_hash_count; }
+};
+} // namespace microsoft
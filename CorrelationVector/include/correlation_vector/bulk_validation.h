@@ -0,0 +1,74 @@
+//---------------------------------------------------------------------
+// <copyright file="bulk_validation.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace microsoft
+{
+/**
+The outcome of validating one line of a bulk buffer. The record points into
+the buffer rather than copying the value.
+*/
+struct bulk_record
+{
+    // The position of the line in the buffer.
+    uint64_t offset;
+    // The length of the line, without its "\n" or "\r\n".
+    uint32_t length;
+    validation_result status;
+    // The number of characters before the first '.', when status is valid.
+    uint8_t base_length;
+    // The length of the value without its last extension and terminator,
+    // i.e. the key of correlation_vector_registry, when status is valid.
+    uint8_t base_vector_length;
+    // Whether the line ends with the terminator, when status is valid.
+    bool is_immutable;
+    uint8_t reserved;
+};
+
+struct bulk_result
+{
+    // One record per line, in the order of the buffer.
+    std::vector<bulk_record> records;
+    // The number of records of each validation_result.
+    size_t counts[static_cast<size_t>(validation_result::invalid_extension) +
+                  1];
+
+    size_t count(validation_result status) const
+    {
+        return counts[static_cast<size_t>(status)];
+    }
+};
+
+/**
+Validates large buffers of newline-separated Correlation Vectors, such as
+archived logs, with the rules of correlation_vector::validate. The buffer is
+split into chunks at line boundaries that are validated on a pool of
+threads; every record is written directly into its final place, so nothing
+is copied or merged afterwards.
+*/
+class bulk_validation
+{
+public:
+    /**
+    Validates every line of a buffer. Lines end with "\n" or "\r\n"; a final
+    line without a line ending is included, but no empty record is added
+    after a final line ending.
+    @param data The buffer.
+    @param length The length of the buffer.
+    @param threadCount The maximum number of threads to use, or 0 to use the
+    hardware concurrency.
+    @return The record of every line and the number of records per status
+    */
+    static bulk_result validate(const char* data,
+                                size_t length,
+                                unsigned int threadCount = 0);
+};
+} // namespace microsoft
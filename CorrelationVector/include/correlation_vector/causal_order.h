@@ -0,0 +1,132 @@
+//---------------------------------------------------------------------
+// <copyright file="causal_order.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string>
+
+namespace microsoft
+{
+/**
+Compares two Correlation Vectors in causal order without allocating. Vectors
+are grouped by base and then ordered segment by segment numerically, so
+"base.9" precedes "base.10" and a vector precedes all of its descendants
+("base.1" precedes "base.1.0"). A terminated vector follows its
+non-terminated counterpart. Malformed input is ordered consistently but
+without any causal meaning.
+@param lhs The first Correlation Vector in its string representation.
+@param lhsLength The length of the first Correlation Vector.
+@param rhs The second Correlation Vector in its string representation.
+@param rhsLength The length of the second Correlation Vector.
+@return A negative value if lhs precedes rhs, zero if they are equal and a
+positive value if lhs follows rhs.
+*/
+int causal_compare(const char* lhs,
+                   size_t lhsLength,
+                   const char* rhs,
+                   size_t rhsLength) noexcept;
+
+inline int causal_compare(const std::string& lhs,
+                          const std::string& rhs) noexcept
+{
+    return causal_compare(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+}
+
+/**
+Strict weak ordering of Correlation Vector strings in causal order, suitable
+for standard containers and algorithms.
+*/
+struct causal_less
+{
+    bool operator()(const std::string& lhs, const std::string& rhs) const
+        noexcept
+    {
+        return causal_compare(lhs, rhs) < 0;
+    }
+};
+
+namespace impl
+{
+/**
+Sorts the positions [0, count) of a range in chunks on up to threadCount
+threads. sortRange(begin, end) sorts a range of positions and
+mergeRanges(begin, middle, end) merges two sorted neighbouring ranges; the
+threads are run by the library.
+*/
+void sort_in_chunks(
+    size_t count,
+    unsigned int threadCount,
+    const std::function<void(size_t, size_t)>& sortRange,
+    const std::function<void(size_t, size_t, size_t)>& mergeRanges);
+
+// Sorts a range like std::sort, on the threads of sort_in_chunks.
+template <typename RandomIt, typename Compare>
+void parallel_sort(RandomIt first,
+                   RandomIt last,
+                   Compare comp,
+                   unsigned int threadCount)
+{
+    typedef typename std::iterator_traits<RandomIt>::difference_type
+        difference_type;
+    sort_in_chunks(
+        static_cast<size_t>(std::distance(first, last)),
+        threadCount,
+        [first, &comp](size_t begin, size_t end) {
+            std::sort(first + static_cast<difference_type>(begin),
+                      first + static_cast<difference_type>(end),
+                      comp);
+        },
+        [first, &comp](size_t begin, size_t middle, size_t end) {
+            std::inplace_merge(first + static_cast<difference_type>(begin),
+                               first + static_cast<difference_type>(middle),
+                               first + static_cast<difference_type>(end),
+                               comp);
+        });
+}
+} // namespace impl
+
+/**
+Sorts records carrying a Correlation Vector in causal order, grouping them by
+base. Large ranges are sorted in parallel chunks that are merged afterwards.
+@param first The beginning of the range of records.
+@param last The end of the range of records.
+@param projection Callable returning the record's Correlation Vector as a
+const std::string&.
+@param threadCount The maximum number of threads to use, or 0 to use the
+hardware concurrency.
+*/
+template <typename RandomIt, typename Projection>
+void causal_sort_by(RandomIt first,
+                    RandomIt last,
+                    Projection projection,
+                    unsigned int threadCount = 0)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type record_type;
+    impl::parallel_sort(
+        first,
+        last,
+        [&projection](const record_type& lhs, const record_type& rhs) {
+            return causal_compare(projection(lhs), projection(rhs)) < 0;
+        },
+        threadCount);
+}
+
+/**
+Sorts Correlation Vector strings in causal order, grouping them by base.
+@param first The beginning of the range of Correlation Vectors.
+@param last The end of the range of Correlation Vectors.
+@param threadCount The maximum number of threads to use, or 0 to use the
+hardware concurrency.
+*/
+template <typename RandomIt>
+void causal_sort(RandomIt first, RandomIt last, unsigned int threadCount = 0)
+{
+    impl::parallel_sort(first, last, causal_less{}, threadCount);
+}
+} // namespace microsoft
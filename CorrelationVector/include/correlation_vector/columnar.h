@@ -0,0 +1,208 @@
+//---------------------------------------------------------------------
+// <copyright file="columnar.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace microsoft
+{
+/**
+Writes Correlation Vectors in the columnar archive format.
+
+Records are grouped into blocks. Each block stores four columns: base ids
+(delta-encoded against the previous record), the shape of each vector (the
+number of segments shared with the previous record of the same base and the
+number of new ones), the new extension segments as varints (the first one
+delta-encoded against the previous record) and a terminator bitmap. Bases are
+stored once, as raw 16-byte values, in a dictionary at the end of the file.
+
+Input should be grouped by base (e.g. with causal_sort) for the best ratio.
+*/
+class columnar_writer
+{
+private:
+    std::ostream& m_out;
+    size_t m_block_size;
+    uint64_t m_offset{0};
+    uint64_t m_block_count{0};
+    uint64_t m_record_count{0};
+    bool m_closed{false};
+
+    std::unordered_map<std::string, uint32_t> m_base_ids;
+    std::vector<std::array<unsigned char, 17>> m_dictionary;
+
+    std::vector<unsigned char> m_base_column;
+    std::vector<unsigned char> m_shape_column;
+    std::vector<unsigned char> m_segment_column;
+    std::vector<unsigned char> m_terminator_column;
+    uint32_t m_block_records{0};
+    uint32_t m_block_min_base{0};
+    uint32_t m_block_max_base{0};
+    uint32_t m_previous_base{0};
+    std::vector<uint32_t> m_previous_segments;
+    std::vector<uint32_t> m_segments;
+
+    uint32_t _base_id(const char* base, size_t length);
+    void _flush_block();
+    void _write(const void* data, size_t length);
+
+public:
+    /**
+    Starts a new archive.
+    @param out The stream receiving the archive. It must outlive the writer.
+    @param blockSize The number of records per block.
+    */
+    explicit columnar_writer(std::ostream& out, size_t blockSize = 65536);
+    ~columnar_writer();
+
+    columnar_writer(const columnar_writer&) = delete;
+    columnar_writer& operator=(const columnar_writer&) = delete;
+
+    /**
+    Appends a Correlation Vector to the archive. Throws std::invalid_argument
+    if the value cannot be stored losslessly: the base must be 16 or 22
+    base64 characters encoding 12 or 16 bytes, every extension must be a
+    canonical unsigned 32-bit number, and the value cannot be longer than
+    correlation_vector::MAX_VALUE_LENGTH.
+    @param correlationVector The Correlation Vector in its string
+    representation.
+    */
+    void write(const std::string& correlationVector);
+
+    /**
+    Flushes the last block and writes the dictionary and footer. Called by the
+    destructor if needed.
+    */
+    void close();
+
+    uint64_t size() const { return m_record_count; }
+};
+
+/**
+Reads a columnar archive through a read-only memory mapping. Columns are
+decoded straight from the mapping; values are only rebuilt as text, and
+correlation_vector objects only created, when asked for.
+*/
+class columnar_reader
+{
+private:
+    struct state;
+    std::shared_ptr<const state> m_state;
+
+public:
+    /**
+    Iterates over the records of an archive, optionally only those of one
+    base. Blocks that cannot contain the base are skipped without decoding.
+    */
+    class cursor
+    {
+    private:
+        friend class columnar_reader;
+
+        std::shared_ptr<const state> m_state;
+        uint32_t m_filter;
+        bool m_filtered;
+        const unsigned char* m_next_block;
+        const unsigned char* m_base_column{nullptr};
+        const unsigned char* m_shape_column{nullptr};
+        const unsigned char* m_segment_column{nullptr};
+        const unsigned char* m_terminator_column{nullptr};
+        // The ends of the columns, which varints must not run past.
+        const unsigned char* m_base_end{nullptr};
+        const unsigned char* m_shape_end{nullptr};
+        const unsigned char* m_segment_end{nullptr};
+        uint32_t m_block_records{0};
+        uint32_t m_index{0};
+        uint32_t m_base{0};
+        bool m_terminated{false};
+        std::vector<uint32_t> m_segments;
+        mutable std::string m_value;
+        mutable bool m_value_ready{false};
+
+        cursor(std::shared_ptr<const state> state,
+               uint32_t filter,
+               bool filtered);
+        bool _next_block();
+
+    public:
+        /**
+        Advances to the next record. Throws std::invalid_argument if the
+        block of the record is corrupt.
+        @return false once there are no more records.
+        */
+        bool next();
+
+        /**
+        Gets the id of the base of the current record in the dictionary.
+        */
+        uint32_t base_id() const { return m_base; }
+
+        /**
+        Gets the extension segments of the current record.
+        */
+        const std::vector<uint32_t>& segments() const { return m_segments; }
+
+        bool is_terminated() const { return m_terminated; }
+
+        /**
+        Gets the current record in its string representation. The reference
+        is invalidated by the next call to next().
+        */
+        const std::string& value() const;
+
+        /**
+        Creates a correlation_vector from the current record.
+        */
+        correlation_vector materialize() const
+        {
+            return correlation_vector::parse(value());
+        }
+    };
+
+    /**
+    Opens an archive. Throws std::system_error if the file cannot be mapped
+    and std::invalid_argument if it is not a valid archive.
+    @param path The path of the archive.
+    */
+    explicit columnar_reader(const std::string& path);
+
+    /**
+    Gets the number of records in the archive.
+    */
+    uint64_t size() const;
+
+    /**
+    Gets the number of distinct bases in the archive.
+    */
+    size_t base_count() const;
+
+    /**
+    Gets a base from the dictionary.
+    @param id The id of the base.
+    */
+    const std::string& base(uint32_t id) const;
+
+    /**
+    Starts an iteration over all records.
+    */
+    cursor scan() const;
+
+    /**
+    Starts an iteration over the records of one base. The iteration is empty
+    if the base does not occur in the archive.
+    @param base The base to filter on.
+    */
+    cursor scan(const std::string& base) const;
+};
+} // namespace microsoft
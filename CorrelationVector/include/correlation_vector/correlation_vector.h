@@ -6,8 +6,11 @@
 #pragma once
 #include "correlation_vector/guid.h"
 #include "correlation_vector/spin_parameters.h"
+#include <algorithm>
 #include <atomic>
-#include <cmath>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace microsoft
@@ -18,31 +21,113 @@ enum class correlation_vector_version
     v2
 };
 
+/**
+The outcome of validating a Correlation Vector, in the order the checks are
+made.
+*/
+enum class validation_result
+{
+    valid,
+    empty,
+    whitespace,
+    too_long,
+    invalid_base,
+    invalid_extension
+};
+
+class c_api;
+class correlation_vector_registry;
+class correlation_vector_view;
+class http_headers;
+class shared_correlation_vector;
+class trace_stats;
+
 class correlation_vector
 {
 private:
+    friend class base_dictionary;
+    friend class c_api;
+    friend class correlation_vector_registry;
+    friend class correlation_vector_view;
+    friend class http_headers;
+    friend class shared_correlation_vector;
+    friend class trace_stats;
+
     static constexpr const size_t MAX_VECTOR_LENGTH_V1 = 63;
     static constexpr const size_t MAX_VECTOR_LENGTH_V2 = 127;
     static constexpr const size_t BASE_LENGTH_V1 = 16;
     static constexpr const size_t BASE_LENGTH_V2 = 22;
 
-    static std::string _base_from_guid(const guid& guid)
-    {
-        return guid.to_base64_string().substr(
-            0, correlation_vector::BASE_LENGTH_V2);
-    }
+    static std::string _base_from_guid(const guid& guid);
 
     static std::string _unique_value(correlation_vector_version version);
 
+    static uint64_t _hash_base(const std::string& baseVector);
+
+    static correlation_vector_version _infer_version(
+        const char* correlationVector,
+        size_t length) noexcept;
+
     static correlation_vector_version _infer_version(
-        const std::string& correlationVector);
+        const std::string& correlationVector)
+    {
+        return _infer_version(correlationVector.data(),
+                              correlationVector.size());
+    }
+
+    static size_t _max_length(correlation_vector_version version)
+    {
+        return version == correlation_vector_version::v2
+                   ? MAX_VECTOR_LENGTH_V2
+                   : MAX_VECTOR_LENGTH_V1;
+    }
+
+    static validation_result _check(const char* correlationVector,
+                                    size_t length,
+                                    correlation_vector_version version,
+                                    size_t& segmentOffset,
+                                    size_t& segmentLength) noexcept;
 
     static void _validate(const std::string& correlationVector,
                           correlation_vector_version version);
 
+    static correlation_vector _parse(const std::string& correlationVector);
+
     static int _int_length(int i)
     {
-        return (i == 0) ? 1 : static_cast<int>(std::log10(i)) + 1;
+        int length = 1;
+        for (; i >= 10; i /= 10)
+        {
+            ++length;
+        }
+
+        return length;
+    }
+
+    // The largest extension that keeps a vector with a base vector of the
+    // given length within the maximum length of its version.
+    static int _max_extension(size_t baseLength,
+                              correlation_vector_version version)
+    {
+        const size_t maxLength = _max_length(version);
+        if (baseLength + 1 >= maxLength)
+        {
+            return 0;
+        }
+
+        const size_t digits = maxLength - 1 - baseLength;
+        if (digits >= 10)
+        {
+            return INT_MAX;
+        }
+
+        int maxExtension = 0;
+        for (size_t i = 0; i < digits; ++i)
+        {
+            maxExtension = maxExtension * 10 + 9;
+        }
+
+        return maxExtension;
     }
 
     static bool _is_immutable(const std::string& correlationVector)
@@ -52,9 +137,20 @@ private:
                    TERMINATOR;
     }
 
+    static bool _is_oversized(size_t baseLength,
+                              int extension,
+                              correlation_vector_version version)
+    {
+        return baseLength != 0 &&
+               baseLength + 1 + _int_length(extension) > _max_length(version);
+    }
+
     static bool _is_oversized(const std::string& baseVector,
                               int extension,
-                              correlation_vector_version version);
+                              correlation_vector_version version)
+    {
+        return _is_oversized(baseVector.length(), extension, version);
+    }
 
     static bool _is_oversized(const std::string& baseVector,
                               correlation_vector_version version)
@@ -70,19 +166,40 @@ private:
         , m_extension{extension}
         , m_version{version}
         , m_is_immutable{isImmutable}
+        , m_base_hash{_hash_base(baseVector)}
     {
+        _init_value();
     }
 
     correlation_vector(const std::string& baseVector,
                        correlation_vector_version version)
-        : m_base_vector{baseVector}, m_version{version}
+        : m_base_vector{baseVector}
+        , m_version{version}
+        , m_base_hash{_hash_base(baseVector)}
     {
+        _init_value();
     }
 
+    size_t _copy_value(char* buffer,
+                       size_t capacity,
+                       int extension,
+                       bool isImmutable) const noexcept;
+
+    int _increment(bool& isImmutable) noexcept;
+
+    void _init_value() noexcept;
+
     std::string m_base_vector;
     std::atomic<int> m_extension{0};
     correlation_vector_version m_version{correlation_vector_version::v1};
-    bool m_is_immutable{false};
+    std::atomic<bool> m_is_immutable{false};
+    uint64_t m_base_hash{0};
+
+    // The base vector and its '.', written when the base is set so that
+    // view() only formats the extension after them.
+    mutable char m_value[MAX_VECTOR_LENGTH_V2 + 1];
+    // Incrementing past this extension makes the vector oversized.
+    int m_max_extension{INT_MAX};
 
 public:
     /**
@@ -96,13 +213,21 @@ public:
     */
     static constexpr const char TERMINATOR = '!';
 
+    /**
+    The length of the longest string representation of a Correlation Vector:
+    a terminated v2 vector of the maximum length.
+    */
+    static constexpr const size_t MAX_VALUE_LENGTH = MAX_VECTOR_LENGTH_V2 + 1;
+
     /**
     Initializes a new instance of the Correlation Vector. This should only
     be called when no existing Correlation Vector was found.
     */
     correlation_vector()
         : m_base_vector{_unique_value(correlation_vector_version::v1)}
+        , m_base_hash{_hash_base(m_base_vector)}
     {
+        _init_value();
     }
 
     /**
@@ -113,7 +238,9 @@ public:
     correlation_vector(const guid& guid)
         : m_base_vector{_base_from_guid(guid)}
         , m_version{correlation_vector_version::v2}
+        , m_base_hash{_hash_base(m_base_vector)}
     {
+        _init_value();
     }
 
     /**
@@ -122,8 +249,11 @@ public:
     Vector was found in the message header.
     */
     correlation_vector(correlation_vector_version version)
-        : m_base_vector{_unique_value(version)}, m_version{version}
+        : m_base_vector{_unique_value(version)}
+        , m_version{version}
+        , m_base_hash{_hash_base(m_base_vector)}
     {
+        _init_value();
     }
 
     // NOTE: we need to implement the special member functions due to
@@ -137,16 +267,20 @@ public:
         : m_base_vector{other.m_base_vector}
         , m_extension{other.m_extension.load()}
         , m_version{other.m_version}
-        , m_is_immutable{other.m_is_immutable}
+        , m_is_immutable{other.m_is_immutable.load()}
+        , m_base_hash{other.m_base_hash}
     {
+        _init_value();
     }
 
     correlation_vector(correlation_vector&& other)
         : m_base_vector{std::move(other.m_base_vector)}
         , m_extension{other.m_extension.load()}
         , m_version{other.m_version}
-        , m_is_immutable{other.m_is_immutable}
+        , m_is_immutable{other.m_is_immutable.load()}
+        , m_base_hash{other.m_base_hash}
     {
+        _init_value();
     }
 
     correlation_vector& operator=(const correlation_vector& other)
@@ -154,7 +288,9 @@ public:
         m_base_vector = other.m_base_vector;
         m_extension.store(other.m_extension.load());
         m_version = other.m_version;
-        m_is_immutable = other.m_is_immutable;
+        m_is_immutable.store(other.m_is_immutable.load());
+        m_base_hash = other.m_base_hash;
+        _init_value();
         return *this;
     }
 
@@ -163,7 +299,9 @@ public:
         m_base_vector = std::move(other.m_base_vector);
         m_extension.store(other.m_extension.load());
         m_version = other.m_version;
-        m_is_immutable = other.m_is_immutable;
+        m_is_immutable.store(other.m_is_immutable.load());
+        m_base_hash = other.m_base_hash;
+        _init_value();
         return *this;
     }
 
@@ -197,6 +335,24 @@ public:
     static correlation_vector spin(const std::string& correlationVector,
                                    const spin_parameters& parameters);
 
+    /**
+    Creates sibling Correlation Vectors by applying the spin operator to an
+    existing value several times, e.g. for the branches of a broadcast. The
+    value is validated and the clock is read once for the whole batch, and
+    the children are guaranteed to be distinct. The children are assigned
+    over existing vectors, so reusing them across calls avoids allocating.
+    @param correlationVector The existing Correlation Vector.
+    @param parameters The parameters to use when applying the spin operator.
+    @param count The number of children to create. It cannot exceed
+    2^(8 * entropy), the number of distinct entropy values.
+    @param children The vectors receiving the children; at least count of
+    them.
+    */
+    static void spin_many(const std::string& correlationVector,
+                          const spin_parameters& parameters,
+                          size_t count,
+                          correlation_vector* children);
+
     /**
     Creates a new Correlation Vector by parsing its string representation
     @param correlationVector The Correlation Vector in its string representation
@@ -204,6 +360,21 @@ public:
     */
     static correlation_vector parse(const std::string& correlationVector);
 
+    /**
+    Validates a Correlation Vector without allocating or throwing. The
+    version is inferred from the length of the base, as in parse. The check
+    is stricter than parse and extend, which keep accepting empty segments
+    ("a..1"), signed extensions ("+1") and bases that are not base64 for
+    compatibility with earlier versions.
+    @param correlationVector The Correlation Vector in its string
+    representation
+    @param length The length of the Correlation Vector
+    @return validation_result::valid if the value is well-formed, otherwise
+    the reason it is not
+    */
+    static validation_result validate(const char* correlationVector,
+                                      size_t length) noexcept;
+
 
     /**
     Gets the value of the Correlation Vector as a string
@@ -211,15 +382,32 @@ public:
     */
     std::string value() const
     {
-        std::string value{m_base_vector + '.' + std::to_string(m_extension)};
-        if (m_is_immutable)
-        {
-            value += TERMINATOR;
-        }
-
-        return value;
+        char buffer[MAX_VALUE_LENGTH];
+        return {buffer, copy_value(buffer, sizeof(buffer))};
     }
 
+    /**
+    Writes the value of the Correlation Vector into a buffer without
+    allocating. The value is not null-terminated.
+    @param buffer The buffer receiving the value. MAX_VALUE_LENGTH bytes are
+    always enough.
+    @param capacity The size of the buffer.
+    @return The length of the value, or 0 if it does not fit in the buffer
+    */
+    size_t copy_value(char* buffer, size_t capacity) const noexcept;
+
+    /**
+    Gets a view of the value of the Correlation Vector without copying or
+    allocating; include correlation_vector/correlation_vector_view.h to use
+    it. The view points into this object and shows the value when it was
+    taken: it must not be used after the next call to view(), or after the
+    vector is destroyed or assigned. view() writes into this object, so
+    threads sharing a vector must not call it at the same time. Use value()
+    or copy_value() to take a copy instead.
+    @return A view of the current value
+    */
+    correlation_vector_view view() const noexcept;
+
     /**
     Increments the current extension by one. Do this before passing the value to
     an outbound message header.
@@ -228,12 +416,54 @@ public:
     */
     std::string increment();
 
+    /**
+    Increments the current extension by one and writes the new value into a
+    buffer without allocating, like copy_value.
+    @param buffer The buffer receiving the value. MAX_VALUE_LENGTH bytes are
+    always enough.
+    @param capacity The size of the buffer.
+    @return The length of the new value, or 0 if it does not fit in the
+    buffer. The extension is incremented either way.
+    */
+    size_t increment_into(char* buffer, size_t capacity) noexcept;
+
     /**
     Gets the version of the Correlation Vector implementation.
     @return The version of the Correlation Vector implementation
     */
     correlation_vector_version version() const { return m_version; }
 
+    /**
+    Gets the hash of the base of the Correlation Vector: the 64-bit FNV-1a
+    hash of the base64 characters before the first '.'. It is computed once
+    when the vector is created, extended, spun or parsed, and is the same at
+    every hop of a trace.
+    @return The hash of the base
+    */
+    uint64_t base_hash() const { return m_base_hash; }
+
+    /**
+    Makes a deterministic head sampling decision for the trace this vector
+    belongs to. A trace is sampled if the top 53 bits of base_hash() are less
+    than rate * 2^53, so every hop (and every implementation using the same
+    rule) makes the same decision without looking at the value.
+    @param rate The fraction of traces to keep, between 0 and 1. Values out
+    of range are clamped; NaN samples nothing.
+    @return true if the trace should be sampled
+    */
+    bool should_sample(double rate) const
+    {
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+        const double clamped = std::min(1.0, std::max(0.0, rate));
+#pragma pop_macro("max")
+#pragma pop_macro("min")
+        return (m_base_hash >> 11) <
+               static_cast<uint64_t>(clamped * 9007199254740992.0);
+    }
+
     /**
     Gets the value of the Correlation Vector as a string
     @return The string representation of the Correlation Vector
@@ -0,0 +1,78 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_array.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <memory>
+
+namespace microsoft
+{
+/**
+A fixed-size array of Correlation Vectors, e.g. one per worker slot, that
+are incremented concurrently. In a plain array the atomic extension and the
+cached value of a vector share cache lines with its neighbours, so
+increments on adjacent slots bounce those lines between cores. Here every
+vector starts on its own pair of cache lines and is padded to a whole
+number of pairs, so no two slots share a line.
+*/
+class correlation_vector_array
+{
+public:
+    // Adjacent-line prefetchers fetch 64-byte lines in pairs, so slots are
+    // aligned to 128 bytes rather than 64.
+    static constexpr const size_t ALIGNMENT = 128;
+
+    // The distance between two slots.
+    static constexpr const size_t SLOT_SIZE =
+        (sizeof(correlation_vector) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+private:
+    std::unique_ptr<unsigned char[]> m_storage;
+    // The first slot, aligned within m_storage.
+    unsigned char* m_slots{nullptr};
+    // The number of constructed vectors.
+    size_t m_size{0};
+
+    void _destroy() noexcept;
+
+public:
+    /**
+    Initializes an array of new Correlation Vectors, each with its own
+    random base.
+    @param size The number of vectors.
+    @param version The version of the vectors.
+    */
+    explicit correlation_vector_array(
+        size_t size,
+        correlation_vector_version version = correlation_vector_version::v2);
+
+    ~correlation_vector_array();
+
+    correlation_vector_array(const correlation_vector_array&) = delete;
+    correlation_vector_array& operator=(const correlation_vector_array&) =
+        delete;
+
+    /**
+    Gets a vector. Assign a vector to a slot, e.g. the result of
+    correlation_vector::extend, to replace it in place.
+    @param index The index of the vector, less than size().
+    */
+    correlation_vector& operator[](size_t index) noexcept
+    {
+        return *reinterpret_cast<correlation_vector*>(m_slots +
+                                                      index * SLOT_SIZE);
+    }
+
+    const correlation_vector& operator[](size_t index) const noexcept
+    {
+        return *reinterpret_cast<const correlation_vector*>(
+            m_slots + index * SLOT_SIZE);
+    }
+
+    size_t size() const noexcept { return m_size; }
+};
+} // namespace microsoft
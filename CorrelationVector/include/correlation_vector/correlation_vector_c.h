@@ -0,0 +1,128 @@
+/*---------------------------------------------------------------------
+ * <copyright file="correlation_vector_c.h" company="Microsoft">
+ *     Copyright (c) Microsoft Corporation.  All rights reserved.
+ * </copyright>
+ *---------------------------------------------------------------------*/
+#ifndef CORRELATION_VECTOR_C_H
+#define CORRELATION_VECTOR_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+A C interface to Correlation Vectors for embedding in C programs. Vectors
+live in fixed-size handles owned by the caller, e.g. on its stack or in a
+request arena, and values are written into caller buffers. No function
+allocates from the heap or lets an exception escape; errors are returned as
+cv_status codes. The semantics are those of microsoft::correlation_vector.
+
+A handle is not synchronized: it must not be used by several threads at
+once.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The length of the longest value: a terminated v2 vector. */
+#define CV_MAX_VALUE_LENGTH 128
+
+typedef enum cv_status
+{
+    CV_OK = 0,
+    /* The value is empty. */
+    CV_EMPTY,
+    /* The value contains whitespace. */
+    CV_WHITESPACE,
+    /* The value is longer than its version allows. */
+    CV_TOO_LONG,
+    /* The base is not 16 or 22 base64 characters. */
+    CV_INVALID_BASE,
+    /* An extension is not a decimal number in range. */
+    CV_INVALID_EXTENSION,
+    /* The output buffer cannot hold the value. */
+    CV_BUFFER_TOO_SMALL,
+    /* A required pointer is NULL or a parameter is out of range. */
+    CV_INVALID_ARGUMENT,
+    /* An unexpected failure, e.g. of the platform guid generator. */
+    CV_ERROR
+} cv_status;
+
+typedef enum cv_version
+{
+    CV_VERSION_1 = 0,
+    CV_VERSION_2 = 1
+} cv_version;
+
+/* The parameters of cv_spin, with the values of spin_parameters. */
+typedef struct cv_spin_parameters
+{
+    /* 24 (coarse) or 16 (fine). */
+    int interval;
+    /* 0, 16, 24 or 32. */
+    int periodicity;
+    /* 0 to 4. */
+    int entropy;
+} cv_spin_parameters;
+
+/* A Correlation Vector. The contents are private. */
+typedef struct cv_handle
+{
+    uint64_t opaque[17];
+} cv_handle;
+
+/*
+Creates a new Correlation Vector with a random base.
+*/
+cv_status cv_create(cv_handle* cv, cv_version version);
+
+/*
+Parses a Correlation Vector, like correlation_vector::parse.
+*/
+cv_status cv_parse(cv_handle* cv, const char* value, size_t length);
+
+/*
+Extends a Correlation Vector taken from a message header, like
+correlation_vector::extend.
+*/
+cv_status cv_extend(cv_handle* cv, const char* value, size_t length);
+
+/*
+Applies the spin operator to a Correlation Vector, like
+correlation_vector::spin. parameters may be NULL for the defaults.
+*/
+cv_status cv_spin(cv_handle* cv,
+                  const char* value,
+                  size_t length,
+                  const cv_spin_parameters* parameters);
+
+/*
+Increments the extension of a Correlation Vector and writes its new value,
+not null-terminated, into out. out may be NULL to skip writing the value;
+the vector is incremented even if the buffer is too small.
+*/
+cv_status cv_increment(cv_handle* cv,
+                       char* out,
+                       size_t capacity,
+                       size_t* length);
+
+/*
+Writes the value of a Correlation Vector, not null-terminated, into out.
+CV_MAX_VALUE_LENGTH bytes are always enough.
+*/
+cv_status cv_value(const cv_handle* cv,
+                   char* out,
+                   size_t capacity,
+                   size_t* length);
+
+/*
+Determines whether a Correlation Vector is terminated. Returns 1 if it is
+and 0 otherwise.
+*/
+int cv_is_immutable(const cv_handle* cv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORRELATION_VECTOR_C_H */
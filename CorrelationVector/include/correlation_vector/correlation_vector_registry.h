@@ -0,0 +1,139 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_registry.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+/**
+A concurrent map of long-lived Correlation Vectors, e.g. one per session,
+keyed by their base: the value without the last extension.
+
+The map is split into 64 shards, each an open-addressing table behind its
+own mutex, so threads working on different keys rarely contend. Lookups hash
+the key as given and compare it in place, without allocating. The mutex is
+only held while probing: increments run on the stored vector afterwards,
+with its own atomics, and the vector is shared, so erasing a key while other
+threads still use its vector is safe.
+*/
+class correlation_vector_registry
+{
+private:
+    static constexpr const size_t SHARDS = 64;
+
+    struct slot
+    {
+        uint64_t hash;
+        std::shared_ptr<correlation_vector> vector;
+        bool erased;
+    };
+
+    struct shard
+    {
+        mutable std::mutex mutex;
+        std::vector<slot> slots;
+        // The number of slots holding a vector, and of slots that ever did:
+        // erased slots keep probes going until the table is rebuilt.
+        size_t live{0};
+        size_t used{0};
+    };
+
+    std::unique_ptr<shard[]> m_shards;
+
+    static uint64_t _hash(const char* baseVector, size_t length) noexcept;
+
+    shard& _shard(uint64_t hash) const noexcept
+    {
+        return m_shards[hash >> 58];
+    }
+
+    static const slot* _find(const shard& shard,
+                             uint64_t hash,
+                             const char* baseVector,
+                             size_t length) noexcept;
+
+    static void _grow(shard& shard);
+
+public:
+    /**
+    Initializes an empty registry.
+    @param expectedSize The number of vectors to reserve room for.
+    */
+    explicit correlation_vector_registry(size_t expectedSize = 0);
+
+    correlation_vector_registry(const correlation_vector_registry&) = delete;
+    correlation_vector_registry& operator=(const correlation_vector_registry&) =
+        delete;
+
+    /**
+    Adds a copy of a Correlation Vector under its base, unless a vector with
+    the same base is registered already.
+    @param correlationVector The Correlation Vector.
+    @return The registered vector: the new copy, or the existing vector
+    */
+    std::shared_ptr<correlation_vector> insert(
+        const correlation_vector& correlationVector);
+
+    /**
+    Looks up the vector registered under a base, without allocating.
+    @param baseVector The base of the vector, i.e. its value without the last
+    extension
+    @param length The length of the base
+    @return The registered vector, or nullptr
+    */
+    std::shared_ptr<correlation_vector> find(const char* baseVector,
+                                             size_t length) const;
+
+    std::shared_ptr<correlation_vector> find(
+        const std::string& baseVector) const
+    {
+        return find(baseVector.data(), baseVector.size());
+    }
+
+    /**
+    Increments the vector registered under a base in place and writes its new
+    value into a buffer, without allocating.
+    @param baseVector The base of the vector
+    @param length The length of the base
+    @param buffer The buffer receiving the value.
+    correlation_vector::MAX_VALUE_LENGTH bytes are always enough.
+    @param capacity The size of the buffer
+    @return The length of the new value, or 0 if no vector is registered
+    under the base or the value does not fit in the buffer
+    */
+    size_t increment(const char* baseVector,
+                     size_t length,
+                     char* buffer,
+                     size_t capacity);
+
+    /**
+    Removes the vector registered under a base. Threads still holding the
+    vector can keep using it; it is freed when the last of them releases it.
+    @param baseVector The base of the vector
+    @param length The length of the base
+    @return true if a vector was removed
+    */
+    bool erase(const char* baseVector, size_t length);
+
+    bool erase(const std::string& baseVector)
+    {
+        return erase(baseVector.data(), baseVector.size());
+    }
+
+    /**
+    Gets the number of registered vectors. Concurrent inserts and erases may
+    or may not be counted.
+    */
+    size_t size() const;
+};
+} // namespace microsoft
@@ -0,0 +1,202 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_view.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+
+namespace microsoft
+{
+/**
+A read-only view of a Correlation Vector in existing bytes, e.g. a header
+value or a log line, for code that only looks at the vector. Creating a view
+stores a pointer and a length; nothing is validated, copied or allocated.
+Every accessor scans the bytes when it is called.
+
+The accessors assume a valid vector and return unspecified but safe results
+otherwise; call validate() first for untrusted input. The bytes must outlive
+the view.
+*/
+class correlation_vector_view
+{
+private:
+    const char* m_data{nullptr};
+    size_t m_length{0};
+
+    // The length without the terminator.
+    size_t _length() const noexcept
+    {
+        return is_immutable() ? m_length - 1 : m_length;
+    }
+
+public:
+    /**
+    Iterates over the extension segments of a vector, i.e. the numbers after
+    the base, including the ones added by the spin operator.
+    */
+    class segment_iterator
+    {
+    private:
+        const char* m_position{nullptr};
+        const char* m_end{nullptr};
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        segment_iterator() = default;
+
+        segment_iterator(const char* position, const char* end) noexcept
+            : m_position{position}, m_end{end}
+        {
+        }
+
+        uint32_t operator*() const noexcept
+        {
+            uint32_t value = 0;
+            for (const char* c = m_position; c != m_end && *c != '.'; ++c)
+            {
+                value = value * 10 + static_cast<uint32_t>(*c - '0');
+            }
+
+            return value;
+        }
+
+        segment_iterator& operator++() noexcept
+        {
+            while (m_position != m_end && *m_position++ != '.')
+            {
+            }
+
+            return *this;
+        }
+
+        segment_iterator operator++(int) noexcept
+        {
+            segment_iterator previous{*this};
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const segment_iterator& other) const noexcept
+        {
+            return m_position == other.m_position;
+        }
+
+        bool operator!=(const segment_iterator& other) const noexcept
+        {
+            return m_position != other.m_position;
+        }
+    };
+
+    struct segment_range
+    {
+        segment_iterator first;
+        segment_iterator last;
+
+        segment_iterator begin() const noexcept { return first; }
+        segment_iterator end() const noexcept { return last; }
+    };
+
+    correlation_vector_view() = default;
+
+    /**
+    Initializes a view of a Correlation Vector in its string representation.
+    @param correlationVector The Correlation Vector. It is not copied.
+    @param length The length of the Correlation Vector
+    */
+    correlation_vector_view(const char* correlationVector,
+                            size_t length) noexcept
+        : m_data{correlationVector}, m_length{length}
+    {
+    }
+
+    correlation_vector_view(const std::string& correlationVector) noexcept
+        : m_data{correlationVector.data()}, m_length{correlationVector.size()}
+    {
+    }
+
+    const char* data() const noexcept { return m_data; }
+
+    size_t size() const noexcept { return m_length; }
+
+    /**
+    Validates the viewed vector like correlation_vector::validate.
+    @return validation_result::valid if the value is well-formed, otherwise
+    the reason it is not
+    */
+    validation_result validate() const noexcept
+    {
+        return correlation_vector::validate(m_data, m_length);
+    }
+
+    /**
+    Gets the version, inferred from the length of the base as in
+    correlation_vector::parse.
+    */
+    correlation_vector_version version() const noexcept;
+
+    /**
+    Determines whether the vector ends with the terminator.
+    */
+    bool is_immutable() const noexcept
+    {
+        return m_length != 0 &&
+               m_data[m_length - 1] == correlation_vector::TERMINATOR;
+    }
+
+    /**
+    Gets the base: the base64 characters before the first '.'.
+    */
+    correlation_vector_view base() const noexcept;
+
+    /**
+    Gets the vector without its last extension and terminator, i.e. the key
+    of correlation_vector_registry.
+    */
+    correlation_vector_view base_vector() const noexcept;
+
+    /**
+    Gets the hash of the base, equal to correlation_vector::base_hash() of
+    the parsed vector.
+    */
+    uint64_t base_hash() const noexcept;
+
+    /**
+    Gets the extension segments after the base.
+    */
+    segment_range segments() const noexcept;
+
+    /**
+    Gets the number of extension segments after the base.
+    */
+    size_t depth() const noexcept;
+
+    /**
+    Gets the last extension, the one increment() advances.
+    @return The last extension, or -1 if the vector has no extension
+    */
+    int last_extension() const noexcept;
+
+    /**
+    Parses the viewed vector into a correlation_vector, with the checks and
+    exceptions of correlation_vector::parse.
+    */
+    correlation_vector to_correlation_vector() const;
+
+    std::string to_string() const { return {m_data, m_length}; }
+};
+
+static_assert(std::is_trivially_copyable<correlation_vector_view>::value,
+              "correlation_vector_view must be trivially copyable");
+} // namespace microsoft
@@ -0,0 +1,244 @@
+//---------------------------------------------------------------------
+// <copyright file="event_ring.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace microsoft
+{
+/**
+A telemetry event tagged with a Correlation Vector. Records have a fixed size
+so they can be copied into a ring and written to a file without formatting.
+*/
+struct event_record
+{
+    static constexpr const size_t PAYLOAD_CAPACITY = 112;
+
+    // Nanoseconds since the system clock epoch.
+    uint64_t timestamp;
+    uint32_t event_id;
+    uint8_t cv_length;
+    uint8_t payload_length;
+    uint16_t reserved;
+    // The value of the Correlation Vector, not null-terminated.
+    char cv[correlation_vector::MAX_VALUE_LENGTH];
+    char payload[PAYLOAD_CAPACITY];
+};
+
+static_assert(sizeof(event_record) == 256, "event_record must be 256 bytes");
+
+/**
+What emit does when the ring is full.
+*/
+enum class backpressure
+{
+    // The event is discarded and counted in event_ring::dropped().
+    drop,
+    // The producer yields until the consumer frees a slot.
+    block
+};
+
+struct event_ring_options
+{
+    // The number of records the ring holds. Must be a power of two.
+    size_t capacity{8192};
+    // The largest number of records handed to the sink at once.
+    size_t batch_size{256};
+    backpressure policy{backpressure::drop};
+    // How long the consumer sleeps when the ring is empty. Producers never
+    // wake it, so this bounds the delay before an event reaches the sink.
+    std::chrono::microseconds idle_wait{1000};
+};
+
+/**
+Receives batches of records on the consumer thread of an event_ring. Sinks
+must not throw.
+*/
+class event_sink
+{
+public:
+    virtual ~event_sink() = default;
+
+    virtual void write(const event_record* records, size_t count) = 0;
+
+    /**
+    Called when the ring runs empty after records were written.
+    */
+    virtual void flush() {}
+};
+
+/**
+Appends records to a local file: an 8-byte magic "CVEVT01", the record size
+as a 32-bit integer, 4 reserved bytes and then the raw records in native byte
+order.
+*/
+class file_event_sink : public event_sink
+{
+private:
+    std::FILE* m_file;
+    bool m_failed{false};
+
+public:
+    /**
+    Creates or truncates the file. Throws std::system_error if it cannot be
+    opened.
+    */
+    explicit file_event_sink(const std::string& path);
+    ~file_event_sink() override;
+
+    file_event_sink(const file_event_sink&) = delete;
+    file_event_sink& operator=(const file_event_sink&) = delete;
+
+    void write(const event_record* records, size_t count) override;
+    void flush() override;
+
+    /**
+    Determines whether a write to the file has failed. Records of failed
+    writes are lost.
+    */
+    bool failed() const { return m_failed; }
+
+    /**
+    Reads all records of a file written by a file_event_sink. Throws
+    std::system_error if the file cannot be opened and std::invalid_argument
+    if it is not an event file.
+    */
+    static std::vector<event_record> read(const std::string& path);
+};
+
+/**
+A bounded multi-producer, single-consumer queue of event records, drained by
+a background thread into an event_sink. Producers on any thread claim a slot
+with a single compare-and-swap and copy the Correlation Vector bytes into it;
+they never lock, allocate or format. The consumer copies ready records out in
+batches and hands them to the sink.
+*/
+class event_ring
+{
+private:
+    struct cell;
+
+    // Keeps the position producers contend on in its own cache line.
+    struct padded_position
+    {
+        std::atomic<size_t> value{0};
+        char padding[64 - sizeof(std::atomic<size_t>)];
+    };
+
+    event_sink& m_sink;
+    const event_ring_options m_options;
+    const size_t m_mask;
+    std::unique_ptr<cell[]> m_cells;
+
+    padded_position m_enqueue_position;
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_written{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    size_t m_flushed_position{0};
+    bool m_stopping{false};
+    std::thread m_consumer;
+
+    cell* _claim(size_t& position) noexcept;
+    void _publish(cell* claimed, size_t position) noexcept;
+    void _consume();
+
+public:
+    /**
+    Starts the consumer thread. Throws std::invalid_argument if the capacity
+    is not a power of two or the batch size is zero.
+    @param sink The sink receiving the records. It must outlive the ring.
+    @param options The size of the ring and its backpressure policy.
+    */
+    explicit event_ring(
+        event_sink& sink,
+        const event_ring_options& options = event_ring_options{});
+
+    /**
+    Writes the remaining records to the sink, flushes it and stops the
+    consumer thread. No producer may emit concurrently.
+    */
+    ~event_ring();
+
+    event_ring(const event_ring&) = delete;
+    event_ring& operator=(const event_ring&) = delete;
+
+    /**
+    Gets the current time in the unit of event_record::timestamp.
+    */
+    static uint64_t now() noexcept;
+
+    /**
+    Queues an event tagged with the current value of a Correlation Vector.
+    @param correlationVector The Correlation Vector.
+    @param eventId The id of the event.
+    @param payload The payload, copied into the record.
+    @param payloadLength The length of the payload, at most
+    event_record::PAYLOAD_CAPACITY bytes.
+    @return true if the event was queued; false if it was dropped because
+    the ring was full or the payload is too long
+    */
+    bool emit(const correlation_vector& correlationVector,
+              uint32_t eventId,
+              const void* payload = nullptr,
+              size_t payloadLength = 0) noexcept;
+
+    /**
+    Queues an event tagged with a Correlation Vector value.
+    @param cv The value of the Correlation Vector.
+    @param cvLength The length of the value, at most
+    correlation_vector::MAX_VALUE_LENGTH bytes.
+    @param eventId The id of the event.
+    @param timestamp The time of the event, in the unit of now().
+    @param payload The payload, copied into the record.
+    @param payloadLength The length of the payload, at most
+    event_record::PAYLOAD_CAPACITY bytes.
+    @return true if the event was queued; false if it was dropped because
+    the ring was full or the value or payload is too long
+    */
+    bool emit(const char* cv,
+              size_t cvLength,
+              uint32_t eventId,
+              uint64_t timestamp,
+              const void* payload = nullptr,
+              size_t payloadLength = 0) noexcept;
+
+    /**
+    Waits until every event queued before the call has been written to the
+    sink and the sink has been flushed.
+    */
+    void flush();
+
+    /**
+    Gets the number of events dropped because the ring was full.
+    */
+    uint64_t dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+    Gets the number of records handed to the sink.
+    */
+    uint64_t written() const
+    {
+        return m_written.load(std::memory_order_relaxed);
+    }
+};
+} // namespace microsoft
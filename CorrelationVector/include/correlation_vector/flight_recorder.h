@@ -0,0 +1,119 @@
+//---------------------------------------------------------------------
+// <copyright file="flight_recorder.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+enum class flight_operation : uint8_t
+{
+    create = 1,
+    extend,
+    spin,
+    increment
+};
+
+/**
+A Correlation Vector recorded by the flight recorder, in the layout of the
+recorder file.
+*/
+struct flight_record
+{
+    // The position of the record in its region, starting at 1. Zero
+    // while the record is being written.
+    uint64_t sequence;
+    // The operating system id of the thread that wrote the record.
+    uint32_t thread_id;
+    // A flight_operation.
+    uint8_t operation;
+    uint8_t length;
+    uint16_t reserved;
+    // The value of the Correlation Vector, not null-terminated.
+    char cv[correlation_vector::MAX_VALUE_LENGTH];
+};
+
+static_assert(sizeof(flight_record) == 144, "flight_record must be 144 bytes");
+
+/**
+The most recent records of one region of the recorder file, oldest first. A
+region is written by one thread at a time, but is handed to a new thread when
+its owner exits.
+*/
+struct flight_thread
+{
+    // The operating system id of the thread that wrote the last record.
+    uint64_t thread_id{0};
+    // The number of records written to the region, including overwritten
+    // ones.
+    uint64_t total{0};
+    std::vector<flight_record> records;
+};
+
+/**
+Optional recorder of the last Correlation Vectors each thread created,
+extended, spun or incremented, compiled in when the library is built with
+USE_FLIGHT_RECORDER. Once started, every such vector is copied into a fixed
+slot of a per-thread circular buffer in a memory-mapped file, with plain
+stores: no locks, no allocation and no system calls. The file survives a
+crash of the process and can be decoded with read() or the cv_flight tool.
+
+Threads claim one of 128 regions of the file and release it when they exit.
+Threads beyond that share the last region, using an atomic increment.
+*/
+class flight_recorder
+{
+public:
+    /**
+    Determines whether the library was built with the flight recorder.
+    @return true if start() records anything
+    */
+    static constexpr bool enabled()
+    {
+#if defined(CV_FLIGHT_RECORDER)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+    Creates the recorder file and starts recording. Throws std::logic_error
+    if the recorder is already started, std::invalid_argument if the number
+    of records is not a power of two and std::system_error if the file cannot
+    be created.
+    @param path The path of the recorder file. It is truncated.
+    @param recordsPerThread The number of records kept for each thread.
+    */
+    static void start(const std::string& path, size_t recordsPerThread = 256);
+
+    /**
+    Stops recording and writes the file to disk. Threads may be recording
+    concurrently: the file is unmapped once the records they are writing are
+    complete, and later records are dropped.
+    */
+    static void stop();
+
+    /**
+    Determines whether the recorder is started.
+    */
+    static bool active() noexcept;
+
+    /**
+    Decodes a recorder file, e.g. after the process crashed. A record that
+    was being written when the process stopped is skipped. Throws
+    std::system_error if the file cannot be mapped and std::invalid_argument
+    if it is not a recorder file.
+    @param path The path of the recorder file.
+    @return The threads that recorded anything.
+    */
+    static std::vector<flight_thread> read(const std::string& path);
+};
+} // namespace microsoft
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <string>
 
 #if defined(GUID_WINDOWS)
@@ -63,5 +64,77 @@ public:
 
     std::string to_string() const;
     std::string to_base64_string(int len = 16) const;
+
+    /**
+    Writes the unpadded base64 encoding of the first bytes of the guid into
+    a buffer, without allocating.
+    @param out The buffer. It must hold (len * 8 + 5) / 6 characters.
+    @param len The number of bytes to encode.
+    @return The number of characters written
+    */
+    size_t to_base64(char* out, int len = 16) const noexcept;
+
+    /**
+    Decodes a guid from the 22 characters of to_base64_string(), e.g. the
+    base of a v2 Correlation Vector, without allocating.
+    @param data The characters.
+    @param length The number of characters; anything but 22 is rejected.
+    @param out The guid receiving the bytes. It is unchanged on failure.
+    @return false if the characters are not the base64 encoding of 16 bytes
+    */
+    static bool try_from_base64(const char* data,
+                                size_t length,
+                                guid& out) noexcept;
+
+    /**
+    Decodes a guid from the 22 characters of to_base64_string().
+    @param base64 The characters.
+    @return The guid
+    @throw std::invalid_argument if the characters are not the base64
+    encoding of 16 bytes
+    */
+    static guid from_base64(const std::string& base64);
+
+    /**
+    Decodes the guids of many bases at once, e.g. of a column of Correlation
+    Vectors, without allocating.
+    @param bases The bases; each one points to 22 characters, which may be
+    followed by the rest of a vector.
+    @param count The number of bases.
+    @param out The guids receiving the bytes; the ones of bases that cannot
+    be decoded are set to empty().
+    @return The number of bases that were decoded
+    */
+    static size_t from_base64_many(const char* const* bases,
+                                   size_t count,
+                                   guid* out) noexcept;
+
+    /**
+    Parses the 36 characters of to_string(), hexadecimal digits in either
+    case grouped 8-4-4-4-12 by dashes, without allocating.
+    @param data The characters.
+    @param length The number of characters; anything but 36 is rejected.
+    @param out The guid receiving the bytes. It is unchanged on failure.
+    @return false if the characters are not a guid
+    */
+    static bool try_parse(const char* data, size_t length, guid& out) noexcept;
+
+    /**
+    Parses the 36 characters of to_string().
+    @param value The characters.
+    @return The guid
+    @throw std::invalid_argument if the characters are not a guid
+    */
+    static guid parse(const std::string& value);
+
+    bool operator==(const guid& other) const
+    {
+        return m_bytes == other.m_bytes;
+    }
+
+    bool operator!=(const guid& other) const
+    {
+        return m_bytes != other.m_bytes;
+    }
 };
 } // namespace microsoft
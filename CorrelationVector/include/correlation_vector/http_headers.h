@@ -0,0 +1,100 @@
+//---------------------------------------------------------------------
+// <copyright file="http_headers.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+
+namespace microsoft
+{
+enum class header_status
+{
+    ok,
+    // The header block has no MS-CV field.
+    not_found,
+    // The MS-CV value is not a valid Correlation Vector.
+    invalid,
+    // The output buffer cannot hold the result.
+    buffer_too_small
+};
+
+/**
+The location of the MS-CV value in a header block, with surrounding
+whitespace removed.
+*/
+struct header_field
+{
+    header_status status{header_status::not_found};
+    size_t offset{0};
+    size_t length{0};
+};
+
+struct header_result
+{
+    header_status status{header_status::not_found};
+    // Why the value was rejected when status is header_status::invalid.
+    validation_result validation{validation_result::valid};
+    // The number of bytes written to the output buffer.
+    size_t length{0};
+};
+
+/**
+Works with the MS-CV field of raw HTTP/1.x header blocks without copying the
+block or allocating. None of these functions throw.
+*/
+class http_headers
+{
+public:
+    /**
+    Finds the first MS-CV field in a header block. The field name is matched
+    case-insensitively at the start of each line; the search stops at the
+    empty line that ends the header block. Lines may end with CRLF or LF.
+    @param block The raw header block, optionally starting with the request
+    or status line.
+    @param length The length of the header block.
+    @return The location of the value in the block.
+    */
+    static header_field find(const char* block, size_t length) noexcept;
+
+    /**
+    Validates and extends the MS-CV value of a header block, writing the
+    resulting Correlation Vector into a caller buffer. For values in canonical
+    form the result is the same as correlation_vector::extend(value).value().
+    @param block The raw header block.
+    @param length The length of the header block.
+    @param out The buffer receiving the extended Correlation Vector. It is
+    not null-terminated.
+    @param capacity The size of the buffer. 128 bytes are always enough.
+    @return The status and the length of the extended Correlation Vector.
+    */
+    static header_result extend(const char* block,
+                                size_t length,
+                                char* out,
+                                size_t capacity) noexcept;
+
+    /**
+    Increments a Correlation Vector written by extend in place and writes the
+    outbound header line "MS-CV: <value>\r\n" into a caller buffer. The
+    result is the same as correlation_vector::increment(), including the
+    terminator added when the vector would grow past its maximum length.
+    Unlike correlation_vector, the buffer is not safe to increment from
+    several threads at once.
+    @param value The Correlation Vector written by extend.
+    @param valueLength The length of the Correlation Vector. Updated when
+    the value is incremented.
+    @param valueCapacity The size of the value buffer.
+    @param line The buffer receiving the header line.
+    @param lineCapacity The size of the line buffer. 137 bytes are always
+    enough.
+    @return The status and the length of the header line.
+    */
+    static header_result increment(char* value,
+                                   size_t& valueLength,
+                                   size_t valueCapacity,
+                                   char* line,
+                                   size_t lineCapacity) noexcept;
+};
+} // namespace microsoft
@@ -0,0 +1,73 @@
+//---------------------------------------------------------------------
+// <copyright file="instrumentation.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace microsoft
+{
+/**
+Totals of the Correlation Vector lifecycle events seen by the process.
+Counters only grow; compute rates from the difference of two snapshots.
+*/
+struct instrumentation_counters
+{
+    // Vectors created from a new base.
+    uint64_t creates{0};
+    uint64_t extends{0};
+    uint64_t spins{0};
+    uint64_t parses{0};
+    uint64_t increments{0};
+
+    // Vectors that became immutable because they reached their maximum
+    // length, in extend, spin or increment.
+    uint64_t oversize_terminations{0};
+
+    // Increments that left the extension unchanged at INT_MAX.
+    uint64_t int_max_saturations{0};
+
+    // Rejected input, indexed by validation_result. The entry for
+    // validation_result::valid is always zero.
+    uint64_t validation_failures[6]{};
+
+    uint64_t validation_failure(validation_result reason) const
+    {
+        return validation_failures[static_cast<size_t>(reason)];
+    }
+};
+
+/**
+Optional counters for Correlation Vector lifecycle events, compiled in when
+the library is built with USE_INSTRUMENTATION. Each thread records into its
+own cache line, so counting adds no contention to the hot path; snapshots
+sum all threads on demand.
+*/
+class instrumentation
+{
+public:
+    /**
+    Determines whether the library was built with instrumentation.
+    @return true if events are counted
+    */
+    static constexpr bool enabled()
+    {
+#if defined(CV_INSTRUMENTATION)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+    Sums the counters of all threads. Counts made concurrently with the
+    snapshot may or may not be included.
+    @return The counters, all zero when instrumentation is disabled
+    */
+    static instrumentation_counters snapshot() noexcept;
+};
+} // namespace microsoft
@@ -0,0 +1,136 @@
+//---------------------------------------------------------------------
+// <copyright file="latency.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace microsoft
+{
+/**
+A log-linear histogram of durations in nanoseconds, in the style of
+HdrHistogram: every power of two is split into 16 linear sub-buckets, so a
+recorded value is reported within 1/16 (6.25%) of its true value. Values from
+2^40 ns (about 18 minutes) up are counted in the last bucket.
+*/
+class latency_histogram
+{
+public:
+    static constexpr const unsigned int SUB_BUCKET_BITS = 4;
+    static constexpr const size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr const unsigned int MAX_VALUE_BITS = 40;
+    static constexpr const size_t BUCKETS =
+        (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /**
+    Gets the bucket of a value.
+    */
+    static size_t bucket(uint64_t nanoseconds);
+
+    /**
+    Gets the highest value counted in a bucket.
+    */
+    static uint64_t highest_value(size_t bucket);
+
+    void record(uint64_t nanoseconds)
+    {
+        ++m_counts[bucket(nanoseconds)];
+        ++m_count;
+        m_max = nanoseconds > m_max ? nanoseconds : m_max;
+    }
+
+    /**
+    Adds the counts of a bucket, e.g. when merging per-thread histograms.
+    */
+    void add(size_t bucket, uint64_t count)
+    {
+        m_counts[bucket] += count;
+        m_count += count;
+    }
+
+    void merge(const latency_histogram& other);
+
+    uint64_t count() const { return m_count; }
+
+    /**
+    Gets the highest recorded value, exactly.
+    */
+    uint64_t max() const { return m_max; }
+
+    void set_max(uint64_t nanoseconds)
+    {
+        m_max = nanoseconds > m_max ? nanoseconds : m_max;
+    }
+
+    /**
+    Gets the value below which the given percentage of the recorded values
+    fall, rounded up to the highest value of its bucket.
+    @param percentile The percentile, between 0 and 100.
+    @return The value in nanoseconds, or 0 if nothing was recorded.
+    */
+    uint64_t value_at_percentile(double percentile) const;
+
+private:
+    std::array<uint64_t, BUCKETS> m_counts{};
+    uint64_t m_count{0};
+    uint64_t m_max{0};
+};
+
+enum class timed_operation
+{
+    extend,
+    spin,
+    parse,
+    increment
+};
+
+struct latency_summary
+{
+    uint64_t count{0};
+    uint64_t p50{0};
+    uint64_t p99{0};
+    uint64_t p999{0};
+    uint64_t max{0};
+};
+
+/**
+Optional timings of correlation_vector::extend, spin, parse and increment,
+compiled in when the library is built with USE_LATENCY_HISTOGRAMS. Each
+thread records into its own histograms; they are merged on demand.
+*/
+class latency
+{
+public:
+    /**
+    Determines whether the library was built with latency histograms.
+    @return true if operations are timed
+    */
+    static constexpr bool enabled()
+    {
+#if defined(CV_LATENCY_HISTOGRAMS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+    Merges the histograms of all threads for an operation. Operations
+    recorded concurrently with the merge may or may not be included.
+    @param operation The operation.
+    @return The merged histogram, empty when latency histograms are disabled
+    */
+    static latency_histogram snapshot(timed_operation operation);
+
+    /**
+    Gets the percentiles of an operation from a fresh snapshot.
+    @param operation The operation.
+    @return The count, p50, p99, p99.9 and max in nanoseconds
+    */
+    static latency_summary summary(timed_operation operation);
+};
+} // namespace microsoft
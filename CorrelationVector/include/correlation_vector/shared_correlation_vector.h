@@ -0,0 +1,107 @@
+//---------------------------------------------------------------------
+// <copyright file="shared_correlation_vector.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include "correlation_vector/correlation_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace microsoft
+{
+/**
+A Correlation Vector whose extension lives in named shared memory, so that
+several processes, e.g. pre-fork workers handling parts of one operation,
+increment one counter and never emit the same child vector. Processes attach
+by the vector without its last extension; the first one to attach creates
+the counter with its own extension.
+
+Increments are lock-free atomics on the shared counter with the semantics of
+correlation_vector::increment: the extension stops at INT_MAX, and the vector
+is terminated for every process once it would grow past its maximum length.
+
+The counter is a POSIX shared memory object on UNIX and a named file mapping
+on Windows. POSIX objects persist until remove() is called; Windows mappings
+disappear when the last process detaches.
+*/
+class shared_correlation_vector
+{
+private:
+    struct segment;
+
+    std::string m_base_vector;
+    correlation_vector_version m_version;
+    segment* m_segment{nullptr};
+#if defined(_WIN32)
+    void* m_mapping{nullptr};
+#endif
+
+    void _close() noexcept;
+    std::string _value(uint64_t state) const;
+
+public:
+    /**
+    Attaches to the shared counter of a Correlation Vector, creating it if no
+    process has. Throws std::system_error if the shared memory cannot be
+    created or mapped, or if its creator does not finish initializing it, and
+    std::invalid_argument if it holds the counter of another vector.
+    @param correlationVector The Correlation Vector. Its extension is the
+    initial value of a new counter and is ignored otherwise.
+    */
+    explicit shared_correlation_vector(
+        const correlation_vector& correlationVector);
+
+    ~shared_correlation_vector() { _close(); }
+
+    shared_correlation_vector(const shared_correlation_vector&) = delete;
+    shared_correlation_vector& operator=(const shared_correlation_vector&) =
+        delete;
+
+    shared_correlation_vector(shared_correlation_vector&& other) noexcept;
+    shared_correlation_vector& operator=(
+        shared_correlation_vector&& other) noexcept;
+
+    /**
+    Gets the name of the shared memory holding the counter of a Correlation
+    Vector.
+    */
+    static std::string segment_name(
+        const correlation_vector& correlationVector);
+
+    /**
+    Removes the shared counter of a Correlation Vector, if any. Processes
+    already attached keep using it; the next attach creates a new counter.
+    Does nothing on Windows.
+    */
+    static void remove(const correlation_vector& correlationVector) noexcept;
+
+    /**
+    Gets the current value of the shared Correlation Vector.
+    */
+    std::string value() const;
+
+    /**
+    Increments the shared extension by one.
+    @return The new value, unique across all attached processes
+    */
+    std::string increment();
+
+    /**
+    Determines whether the shared Correlation Vector has been terminated.
+    */
+    bool is_immutable() const;
+
+    correlation_vector_version version() const { return m_version; }
+
+    /**
+    Gets a process-local copy of the current value.
+    */
+    correlation_vector to_correlation_vector() const
+    {
+        return correlation_vector::parse(value());
+    }
+};
+} // namespace microsoft
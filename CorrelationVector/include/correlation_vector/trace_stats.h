@@ -0,0 +1,177 @@
+//---------------------------------------------------------------------
+// <copyright file="trace_stats.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+/**
+The statistics of one base, i.e. one trace, over the vectors aggregated.
+*/
+struct trace_summary
+{
+    std::string base;
+    // The number of vectors of the trace, counting repeats.
+    uint64_t records;
+    // The number of vectors ending with the terminator.
+    uint64_t terminated;
+    // The most extension segments in one vector, including spin segments.
+    uint32_t max_depth;
+    // The largest last extension, i.e. the most outbound calls made by any
+    // one vector of the trace.
+    uint32_t max_fan_out;
+    // The most spins on the path of one vector.
+    uint32_t max_spins;
+};
+
+/**
+Aggregates statistics per base over streams of Correlation Vectors, e.g. for
+capacity planning from event logs. Vectors are validated with
+correlation_vector::validate would, in a single pass that also measures
+them; nothing is stored per vector, so the state only grows with the number
+of bases. Bases live in an open-addressing table of 64-byte entries aligned
+to cache lines, so that a lookup usually touches a single line.
+
+An aggregator is not synchronized. To ingest in parallel, give each thread
+its own aggregator and merge them at the end, as aggregate() does.
+
+Spins are recognized by their segments: segments before the last one that
+are at least SPIN_THRESHOLD are taken as spin values, and consecutive ones
+as a single spin. Spin parameters with less than 16 bits of counter and
+entropy produce values that cannot be told from extensions.
+*/
+class trace_stats
+{
+private:
+    struct entry
+    {
+        uint64_t hash;
+        uint64_t records;
+        uint64_t terminated;
+        uint32_t max_depth;
+        uint32_t max_fan_out;
+        uint32_t max_spins;
+        // 0 for an empty entry.
+        uint8_t base_length;
+        char base[22];
+    };
+
+    // The statistics of one vector, before they are added to its base.
+    struct record
+    {
+        uint64_t hash;
+        const char* base;
+        size_t base_length;
+        bool is_terminated;
+        uint32_t depth;
+        uint32_t fan_out;
+        uint32_t spins;
+    };
+
+    // The entries, aligned to a cache line within m_storage. The capacity is
+    // a power of two.
+    std::unique_ptr<unsigned char[]> m_storage;
+    entry* m_entries{nullptr};
+    size_t m_capacity{0};
+    size_t m_size{0};
+    uint64_t m_records{0};
+    uint64_t m_rejected{0};
+
+    static bool _parse(const char* correlationVector,
+                       size_t length,
+                       record& out) noexcept;
+
+    void _add(const record& r);
+
+    entry& _entry(uint64_t hash, const char* base, size_t length);
+
+    void _allocate(size_t capacity);
+
+    void _grow();
+
+public:
+    static constexpr const uint32_t SPIN_THRESHOLD = 65536;
+
+    /**
+    Initializes an empty aggregator.
+    @param expectedBases The number of bases to reserve room for.
+    */
+    explicit trace_stats(size_t expectedBases = 0);
+
+    trace_stats(trace_stats&& other) noexcept;
+    trace_stats& operator=(trace_stats&& other) noexcept;
+
+    /**
+    Adds a Correlation Vector to the statistics of its base.
+    @param correlationVector The value.
+    @param length The length of the value.
+    @return false if the value is not a valid Correlation Vector; it is only
+    counted as rejected
+    */
+    bool add(const char* correlationVector, size_t length);
+
+    bool add(const std::string& correlationVector)
+    {
+        return add(correlationVector.data(), correlationVector.size());
+    }
+
+    /**
+    Adds many Correlation Vectors. This is faster than adding them one by
+    one: the entries of the next bases are fetched from memory while the
+    current ones are updated.
+    @param values The values.
+    @param count The number of values.
+    */
+    void add(const std::string* values, size_t count);
+
+    /**
+    Adds the statistics of another aggregator, e.g. of another shard of the
+    same stream.
+    @param other The aggregator to merge. It is left unchanged.
+    */
+    void merge(const trace_stats& other);
+
+    /**
+    Gets the number of bases.
+    */
+    size_t size() const noexcept { return m_size; }
+
+    /**
+    Gets the number of valid vectors added.
+    */
+    uint64_t records() const noexcept { return m_records; }
+
+    /**
+    Gets the number of values that were not valid Correlation Vectors.
+    */
+    uint64_t rejected() const noexcept { return m_rejected; }
+
+    /**
+    Gets the statistics of every base.
+    @return The summaries, sorted by base
+    */
+    std::vector<trace_summary> summaries() const;
+
+    /**
+    Aggregates many Correlation Vectors on a pool of threads. The values are
+    split into contiguous shards that are aggregated independently and then
+    merged.
+    @param values The values.
+    @param count The number of values.
+    @param threadCount The maximum number of threads to use, or 0 to use the
+    hardware concurrency.
+    @return The merged statistics
+    */
+    static trace_stats aggregate(const std::string* values,
+                                 size_t count,
+                                 unsigned int threadCount = 0);
+};
+} // namespace microsoft
@@ -0,0 +1,186 @@
+//---------------------------------------------------------------------
+// <copyright file="trace_tree.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace microsoft
+{
+/**
+The call tree of all Correlation Vectors observed for a single base. The tree
+is a prefix trie over extension segments stored in depth-first order, so the
+descendants of any vector occupy a contiguous range of nodes.
+
+Nodes that were never observed themselves, such as the intermediate segment
+introduced by the spin operator, are skipped when answering queries: the
+children of a vector are its nearest observed descendants.
+*/
+class trace_tree
+{
+private:
+    friend class trace_forest_builder;
+
+    static constexpr const uint32_t NPOS = 0xFFFFFFFF;
+
+    struct node
+    {
+        uint32_t extension;
+        uint32_t parent;
+        uint32_t subtree_size;
+        uint8_t observed;
+        uint8_t terminated;
+    };
+
+    std::string m_base;
+    std::vector<node> m_nodes;
+    size_t m_observed{0};
+
+    explicit trace_tree(std::string base);
+
+    // Appends a validated vector. Vectors must be added in causal order.
+    void _append(const std::string& correlationVector,
+                 std::vector<uint32_t>& path);
+    void _close(std::vector<uint32_t>& path, size_t depth);
+
+    uint32_t _find(const std::string& correlationVector) const;
+    uint32_t _observed_parent(uint32_t index) const;
+    std::string _value(uint32_t index) const;
+    void _collect(uint32_t index,
+                  bool recursive,
+                  std::vector<std::string>& out) const;
+
+public:
+    /**
+    Gets the base shared by all vectors of this tree.
+    @return The base of the tree.
+    */
+    const std::string& base() const { return m_base; }
+
+    /**
+    Gets the number of distinct vectors observed for this base.
+    @return The number of observed vectors.
+    */
+    size_t size() const { return m_observed; }
+
+    /**
+    Determines whether the given Correlation Vector was observed.
+    @param correlationVector The Correlation Vector to look for.
+    @return true if the vector was observed, otherwise false.
+    */
+    bool contains(const std::string& correlationVector) const;
+
+    /**
+    Determines whether the given Correlation Vector was observed terminated.
+    @param correlationVector The Correlation Vector to look for.
+    @return true if the vector was observed with a terminator.
+    */
+    bool is_terminated(const std::string& correlationVector) const;
+
+    /**
+    Gets the nearest observed ancestor of a Correlation Vector.
+    @param correlationVector The Correlation Vector, or the base itself.
+    @return The parent vector, or an empty string if there is none.
+    */
+    std::string parent(const std::string& correlationVector) const;
+
+    /**
+    Gets the observed children of a Correlation Vector.
+    @param correlationVector The Correlation Vector, or the base itself to get
+    the roots of the trace.
+    @return The children in causal order.
+    */
+    std::vector<std::string> children(
+        const std::string& correlationVector) const;
+
+    /**
+    Gets all observed descendants of a Correlation Vector.
+    @param correlationVector The Correlation Vector, or the base itself to get
+    every vector of the trace.
+    @return The descendants in causal order.
+    */
+    std::vector<std::string> descendants(
+        const std::string& correlationVector) const;
+};
+
+/**
+Immutable collection of trace trees, one per base, built by a
+trace_forest_builder.
+*/
+class trace_forest
+{
+private:
+    friend class trace_forest_builder;
+
+    std::vector<trace_tree> m_trees;
+    size_t m_rejected{0};
+
+public:
+    /**
+    Finds the tree of the base of the given Correlation Vector.
+    @param correlationVector A Correlation Vector or a bare base.
+    @return The tree, or nullptr if the base was never observed.
+    */
+    const trace_tree* find(const std::string& correlationVector) const;
+
+    /**
+    Gets the trees, sorted by base.
+    @return The trees of the forest.
+    */
+    const std::vector<trace_tree>& trees() const { return m_trees; }
+
+    /**
+    Gets the number of ingested values that were not valid Correlation
+    Vectors and were therefore left out.
+    @return The number of rejected values.
+    */
+    size_t rejected() const { return m_rejected; }
+
+    std::vector<std::string> children(
+        const std::string& correlationVector) const;
+
+    std::vector<std::string> descendants(
+        const std::string& correlationVector) const;
+};
+
+/**
+Collects Correlation Vectors from any number of services and builds the call
+tree of every base. Values are validated with correlation_vector::validate
+when the forest is built, and those with leading zeros in a segment are
+rejected too, so that every node has a single spelling.
+*/
+class trace_forest_builder
+{
+private:
+    std::vector<std::string> m_vectors;
+
+public:
+    void add(const std::string& correlationVector)
+    {
+        m_vectors.push_back(correlationVector);
+    }
+
+    void add(std::string&& correlationVector)
+    {
+        m_vectors.push_back(std::move(correlationVector));
+    }
+
+    void reserve(size_t count) { m_vectors.reserve(count); }
+
+    size_t size() const { return m_vectors.size(); }
+
+    /**
+    Builds the trees of all ingested vectors. Bases are spread across threads
+    and each tree is built independently. The builder is left empty.
+    @param threadCount The maximum number of threads to use, or 0 to use the
+    hardware concurrency.
+    @return The forest of trace trees.
+    */
+    trace_forest build(unsigned int threadCount = 0);
+};
+} // namespace microsoft
@@ -0,0 +1,378 @@
+//---------------------------------------------------------------------
+// <copyright file="base_dictionary.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/base_dictionary.h"
+
+#include "utilities.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace microsoft
+{
+constexpr const uint32_t base_dictionary::NO_ID;
+constexpr const size_t base_dictionary::MAX_BASE_LENGTH;
+
+namespace
+{
+// The low half of the hash of a base, which picks its index slot.
+uint32_t slot_hash(uint64_t hash)
+{
+    return static_cast<uint32_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+uint64_t slot_value(uint32_t hash, uint32_t id)
+{
+    return static_cast<uint64_t>(hash) << 32 | (id + 1);
+}
+} // namespace
+
+base_dictionary::base_dictionary(size_t capacity, uint32_t retainedEpochs)
+    : m_capacity{capacity}, m_retained_epochs{retainedEpochs}
+{
+    if (capacity == 0 || capacity > (1u << 30))
+    {
+        throw std::invalid_argument(
+            "The capacity must be between 1 and 2^30, was " +
+            std::to_string(capacity) + ".");
+    }
+
+    if (retainedEpochs == 0)
+    {
+        throw std::invalid_argument(
+            "At least one epoch must be retained.");
+    }
+
+    // At most half of the slots are used, so probes stay short.
+    size_t slotCount = 16;
+    while (slotCount < capacity * 2)
+    {
+        slotCount *= 2;
+    }
+
+    m_mask = slotCount - 1;
+    m_slots.reset(new std::atomic<uint64_t>[slotCount]);
+    for (size_t i = 0; i < slotCount; ++i)
+    {
+        m_slots[i].store(0, std::memory_order_relaxed);
+    }
+
+    m_entries.reset(new entry[capacity]);
+    m_free.reserve(capacity);
+    for (size_t id = capacity; id-- != 0;)
+    {
+        entry& e = m_entries[id];
+        e.sequence.store(0, std::memory_order_relaxed);
+        e.hash = 0;
+        e.epoch.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint64_t>& word : e.words)
+        {
+            word.store(0, std::memory_order_relaxed);
+        }
+
+        m_free.push_back(static_cast<uint32_t>(id));
+    }
+}
+
+/* static */
+size_t base_dictionary::_base_length(
+    correlation_vector_view correlationVector) noexcept
+{
+    // Bases longer than MAX_BASE_LENGTH are rejected without reading the
+    // rest of the value.
+#pragma push_macro("min")
+#undef min
+    return utilities::base_length(
+        correlationVector.data(),
+        std::min(correlationVector.size(), MAX_BASE_LENGTH + 1));
+#pragma pop_macro("min")
+}
+
+/* static */
+bool base_dictionary::_key(const char* base, size_t length, key& out) noexcept
+{
+    if (length == 0 || length > MAX_BASE_LENGTH)
+    {
+        return false;
+    }
+
+    // The length goes in the last byte, so a free entry, all zeros, never
+    // matches.
+    char bytes[sizeof(out.words)] = {};
+    std::memcpy(bytes, base, length);
+    bytes[sizeof(bytes) - 1] = static_cast<char>(length);
+    std::memcpy(out.words, bytes, sizeof(bytes));
+    return true;
+}
+
+uint32_t base_dictionary::_find(const key& key, uint64_t hash) const noexcept
+{
+    const uint32_t slotHash = slot_hash(hash);
+    const uint64_t epoch = m_epoch.load(std::memory_order_relaxed);
+    for (size_t i = slotHash & m_mask;; i = (i + 1) & m_mask)
+    {
+        const uint64_t slot = m_slots[i].load(std::memory_order_acquire);
+        if (slot == 0)
+        {
+            return NO_ID;
+        }
+
+        if (static_cast<uint32_t>(slot >> 32) != slotHash)
+        {
+            continue;
+        }
+
+        const uint32_t id = static_cast<uint32_t>(slot) - 1;
+        entry& e = m_entries[id];
+        const uint32_t sequence = e.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0 ||
+            e.words[0].load(std::memory_order_relaxed) != key.words[0] ||
+            e.words[1].load(std::memory_order_relaxed) != key.words[1] ||
+            e.words[2].load(std::memory_order_relaxed) != key.words[2])
+        {
+            continue;
+        }
+
+        // Marking the entry used before checking the sequence again pairs
+        // with advance_epoch, which marks the entry written before reading
+        // its epoch: either the eviction sees this epoch and keeps the
+        // entry, or this lookup sees the eviction and fails.
+        if (e.epoch.load(std::memory_order_relaxed) != epoch)
+        {
+            e.epoch.store(epoch, std::memory_order_seq_cst);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.sequence.load(std::memory_order_seq_cst) == sequence)
+        {
+            return id;
+        }
+    }
+}
+
+uint32_t base_dictionary::_insert(const key& key, uint64_t hash)
+{
+    if (m_free.empty())
+    {
+        return NO_ID;
+    }
+
+    const uint32_t id = m_free.back();
+    m_free.pop_back();
+    entry& e = m_entries[id];
+    const uint32_t sequence = e.sequence.load(std::memory_order_relaxed);
+    e.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.hash = slot_hash(hash);
+    e.epoch.store(m_epoch.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+    for (size_t w = 0; w < 3; ++w)
+    {
+        e.words[w].store(key.words[w], std::memory_order_relaxed);
+    }
+
+    e.sequence.store(sequence + 2, std::memory_order_release);
+
+    size_t i = e.hash & m_mask;
+    while (m_slots[i].load(std::memory_order_relaxed) != 0)
+    {
+        i = (i + 1) & m_mask;
+    }
+
+    m_slots[i].store(slot_value(e.hash, id), std::memory_order_release);
+    return id;
+}
+
+void base_dictionary::_erase_slot(uint32_t id) noexcept
+{
+    const uint64_t value = slot_value(m_entries[id].hash, id);
+    size_t hole = m_entries[id].hash & m_mask;
+    while (m_slots[hole].load(std::memory_order_relaxed) != value)
+    {
+        hole = (hole + 1) & m_mask;
+    }
+
+    // Shift the rest of the cluster back instead of leaving a tombstone, so
+    // probes never get longer. A lookup running meanwhile may miss a shifted
+    // base and fall back to intern's locked path, which finds it.
+    for (size_t i = (hole + 1) & m_mask;; i = (i + 1) & m_mask)
+    {
+        const uint64_t slot = m_slots[i].load(std::memory_order_relaxed);
+        if (slot == 0)
+        {
+            break;
+        }
+
+        // Move the slot into the hole unless its home is after the hole,
+        // cyclically.
+        const size_t home = static_cast<uint32_t>(slot >> 32) & m_mask;
+        if (((i - home) & m_mask) >= ((i - hole) & m_mask))
+        {
+            m_slots[hole].store(slot, std::memory_order_release);
+            hole = i;
+        }
+    }
+
+    m_slots[hole].store(0, std::memory_order_release);
+}
+
+bool base_dictionary::_read(uint32_t id, key& out) const noexcept
+{
+    const entry& e = m_entries[id];
+    for (;;)
+    {
+        const uint32_t sequence = e.sequence.load(std::memory_order_acquire);
+        for (size_t w = 0; w < 3; ++w)
+        {
+            out.words[w] = e.words[w].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((sequence & 1) == 0 &&
+            e.sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            return reinterpret_cast<const char*>(
+                       out.words)[sizeof(out.words) - 1] != 0;
+        }
+    }
+}
+
+uint32_t base_dictionary::_intern(const char* base,
+                                  size_t length,
+                                  uint64_t hash)
+{
+    key key;
+    if (!_key(base, length, key))
+    {
+        return NO_ID;
+    }
+
+    uint32_t id = _find(key, hash);
+    if (id == NO_ID)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        id = _find(key, hash);
+        if (id == NO_ID)
+        {
+            id = _insert(key, hash);
+        }
+    }
+
+    return id;
+}
+
+uint32_t base_dictionary::intern(const correlation_vector& correlationVector)
+{
+    const std::string& baseVector = correlationVector.m_base_vector;
+    return _intern(
+        baseVector.data(),
+        utilities::base_length(baseVector.data(), baseVector.size()),
+        correlationVector.m_base_hash);
+}
+
+uint32_t base_dictionary::intern(correlation_vector_view correlationVector)
+{
+    const size_t length = _base_length(correlationVector);
+    return _intern(correlationVector.data(),
+                   length,
+                   utilities::fnv1a_64(correlationVector.data(), length));
+}
+
+uint32_t base_dictionary::find(
+    correlation_vector_view correlationVector) const noexcept
+{
+    const size_t length = _base_length(correlationVector);
+    key key;
+    if (!_key(correlationVector.data(), length, key))
+    {
+        return NO_ID;
+    }
+
+    const uint64_t hash = utilities::fnv1a_64(correlationVector.data(), length);
+    uint32_t id = _find(key, hash);
+    if (id == NO_ID)
+    {
+        // The base may have been shifted by a concurrent eviction.
+        std::lock_guard<std::mutex> lock{m_mutex};
+        id = _find(key, hash);
+    }
+
+    return id;
+}
+
+std::string base_dictionary::resolve(uint32_t id) const
+{
+    key key;
+    if (id >= m_capacity || !_read(id, key))
+    {
+        return {};
+    }
+
+    const char* bytes = reinterpret_cast<const char*>(key.words);
+    return {bytes, static_cast<size_t>(bytes[sizeof(key.words) - 1])};
+}
+
+size_t base_dictionary::advance_epoch()
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const uint64_t epoch = m_epoch.load(std::memory_order_relaxed) + 1;
+    m_epoch.store(epoch, std::memory_order_seq_cst);
+    size_t evicted = 0;
+    for (uint32_t id = 0; id < m_capacity; ++id)
+    {
+        entry& e = m_entries[id];
+        if (e.words[2].load(std::memory_order_relaxed) == 0 ||
+            e.epoch.load(std::memory_order_relaxed) + m_retained_epochs >=
+                epoch)
+        {
+            continue;
+        }
+
+        const uint32_t sequence = e.sequence.load(std::memory_order_relaxed);
+        e.sequence.store(sequence + 1, std::memory_order_seq_cst);
+        if (e.epoch.load(std::memory_order_seq_cst) + m_retained_epochs <
+            epoch)
+        {
+            for (std::atomic<uint64_t>& word : e.words)
+            {
+                word.store(0, std::memory_order_relaxed);
+            }
+
+            _erase_slot(id);
+            m_free.push_back(id);
+            ++evicted;
+        }
+
+        e.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    return evicted;
+}
+
+void base_dictionary::dump(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    out << "epoch " << m_epoch.load(std::memory_order_relaxed) << '\n';
+    for (uint32_t id = 0; id < m_capacity; ++id)
+    {
+        key key;
+        if (_read(id, key))
+        {
+            const char* bytes = reinterpret_cast<const char*>(key.words);
+            out << id << ' ';
+            out.write(bytes,
+                      static_cast<std::streamsize>(
+                          bytes[sizeof(key.words) - 1]));
+            out << '\n';
+        }
+    }
+}
+
+size_t base_dictionary::size() const
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_capacity - m_free.size();
+}
+} // namespace microsoft
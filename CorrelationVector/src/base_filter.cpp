@@ -0,0 +1,165 @@
+//---------------------------------------------------------------------
+// <copyright file="base_filter.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/base_filter.h"
+
+#include "correlation_vector/correlation_vector.h"
+#include "utilities.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace microsoft
+{
+constexpr const size_t base_filter::BLOCK_WORDS;
+constexpr const size_t base_filter::BLOCK_BITS;
+
+base_filter::base_filter(size_t expectedCount, double falsePositiveRate)
+{
+    if (!(falsePositiveRate > 0 && falsePositiveRate < 1))
+    {
+        throw std::invalid_argument(
+            "The false positive rate must be between 0 and 1, was " +
+            std::to_string(falsePositiveRate) + ".");
+    }
+
+    // Start from the bits and hashes of a classic Bloom filter and add
+    // blocks until the rate of the blocked layout is met: bases are spread
+    // unevenly over blocks, and crowded blocks raise the rate.
+    const double ln2 = std::log(2.0);
+    const double bitsPerBase = -std::log(falsePositiveRate) / (ln2 * ln2);
+    const double count =
+        std::max<double>(static_cast<double>(expectedCount), 1);
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+    m_hash_count = std::min(
+        std::max(static_cast<int>(std::lround(bitsPerBase * ln2)), 1), 16);
+#pragma pop_macro("max")
+#pragma pop_macro("min")
+    m_block_count = std::max<size_t>(
+        static_cast<size_t>(std::ceil(count * bitsPerBase / BLOCK_BITS)), 1);
+    while (_false_positive_rate(count) > falsePositiveRate)
+    {
+        m_block_count += m_block_count / 32 + 1;
+    }
+
+    // Room to align the first block to a cache line.
+    const size_t words = m_block_count * BLOCK_WORDS + BLOCK_WORDS - 1;
+    m_storage.reset(new std::atomic<uint64_t>[words]);
+    const uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.get());
+    m_words = m_storage.get() + ((64 - address % 64) % 64) / sizeof(uint64_t);
+    clear();
+}
+
+double base_filter::_false_positive_rate(double count) const noexcept
+{
+    // The number of bases in a block follows a Poisson distribution; a base
+    // is a false positive when all its bits are set in its block.
+    const double load = count / static_cast<double>(m_block_count);
+    const double unset = 1.0 - 1.0 / BLOCK_BITS;
+    const double last = load + 10 * std::sqrt(load) + 10;
+    double probability = std::exp(-load);
+    double rate = 0;
+    for (double bases = 0; bases <= last; ++bases)
+    {
+        rate += probability *
+                std::pow(1 - std::pow(unset, m_hash_count * bases),
+                         m_hash_count);
+        probability *= load / (bases + 1);
+    }
+
+    return rate;
+}
+
+/* static */
+uint64_t base_filter::_hash(const char* correlationVector,
+                            size_t length) noexcept
+{
+    // Only the characters a valid value could have are read.
+#pragma push_macro("min")
+#undef min
+    return utilities::hash_base(
+        correlationVector,
+        utilities::base_length(
+            correlationVector,
+            std::min(length, correlation_vector::MAX_VALUE_LENGTH)));
+#pragma pop_macro("min")
+}
+
+bool base_filter::_insert(uint64_t hash) noexcept
+{
+    std::atomic<uint64_t>* block = m_words + _block(hash) * BLOCK_WORDS;
+    uint64_t masks[BLOCK_WORDS] = {};
+    uint64_t bits = 0;
+    for (int i = 0; i < m_hash_count; ++i, bits >>= 9)
+    {
+        if (i % 7 == 0)
+        {
+            bits = _bits(hash, i);
+        }
+
+        const size_t index = bits % BLOCK_BITS;
+        masks[index / 64] |= 1ULL << (index % 64);
+    }
+
+    bool isNew = false;
+    for (size_t i = 0; i < BLOCK_WORDS; ++i)
+    {
+        if (masks[i] != 0 &&
+            (block[i].load(std::memory_order_relaxed) & masks[i]) != masks[i])
+        {
+            const uint64_t previous =
+                block[i].fetch_or(masks[i], std::memory_order_relaxed);
+            isNew = isNew || (previous & masks[i]) != masks[i];
+        }
+    }
+
+    return isNew;
+}
+
+bool base_filter::_contains(uint64_t hash) const noexcept
+{
+    const std::atomic<uint64_t>* block = m_words + _block(hash) * BLOCK_WORDS;
+    uint64_t bits = 0;
+    for (int i = 0; i < m_hash_count; ++i, bits >>= 9)
+    {
+        if (i % 7 == 0)
+        {
+            bits = _bits(hash, i);
+        }
+
+        const size_t index = bits % BLOCK_BITS;
+        if ((block[index / 64].load(std::memory_order_relaxed) &
+             (1ULL << (index % 64))) == 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool base_filter::insert(const guid& guid) noexcept
+{
+    char base[22];
+    return insert(base, guid.to_base64(base));
+}
+
+bool base_filter::contains(const guid& guid) const noexcept
+{
+    char base[22];
+    return contains(base, guid.to_base64(base));
+}
+
+void base_filter::clear() noexcept
+{
+    for (size_t i = 0; i < m_block_count * BLOCK_WORDS; ++i)
+    {
+        m_words[i].store(0, std::memory_order_relaxed);
+    }
+}
+} // namespace microsoft
@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------
+// <copyright file="bulk_validation.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/bulk_validation.h"
+
+#include "parallel.h"
+#include "utilities.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace microsoft
+{
+namespace
+{
+constexpr const size_t CHUNK_SIZE = 1 << 20;
+constexpr const size_t STATUS_COUNT =
+    static_cast<size_t>(validation_result::invalid_extension) + 1;
+
+// The end of the line starting at position, i.e. the position of its '\n'
+// or the end of the buffer.
+const char* line_end(const char* position, const char* end)
+{
+    const void* newline =
+        std::memchr(position, '\n', static_cast<size_t>(end - position));
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+const char* next_line(const char* lineEnd, const char* end)
+{
+    return lineEnd == end ? end : lineEnd + 1;
+}
+
+bulk_record check(const char* data, const char* line, const char* end)
+{
+    bulk_record record{};
+    record.offset = static_cast<uint64_t>(line - data);
+    size_t length = static_cast<size_t>(end - line);
+    if (length != 0 && line[length - 1] == '\r')
+    {
+        --length;
+    }
+
+    record.length =
+        static_cast<uint32_t>(std::min<size_t>(length, UINT_MAX));
+    record.status = correlation_vector::validate(line, length);
+    if (record.status == validation_result::valid)
+    {
+        record.is_immutable =
+            line[length - 1] == correlation_vector::TERMINATOR;
+        record.base_length =
+            static_cast<uint8_t>(utilities::base_length(line, length));
+        size_t baseVectorLength = length - 1;
+        while (line[baseVectorLength] != '.')
+        {
+            --baseVectorLength;
+        }
+
+        record.base_vector_length = static_cast<uint8_t>(baseVectorLength);
+    }
+
+    return record;
+}
+} // namespace
+
+/* static */
+bulk_result bulk_validation::validate(const char* data,
+                                      size_t length,
+                                      unsigned int threadCount)
+{
+    const char* end = data + length;
+    const size_t chunkCount = (length + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // Each chunk starts at the first line that starts in its nominal range,
+    // so that no line is split between chunks.
+    std::vector<const char*> starts(chunkCount + 1, end);
+    std::vector<size_t> firstRecord(chunkCount + 1, 0);
+    if (chunkCount != 0)
+    {
+        starts[0] = data;
+    }
+
+    utilities::parallel_for(chunkCount, threadCount, [&](size_t c) {
+        if (c != 0)
+        {
+            const char* previous = data + c * CHUNK_SIZE - 1;
+            const char* newline = line_end(previous, end);
+            starts[c] = newline == end ? end : newline + 1;
+        }
+    });
+
+    // Count the lines of each chunk to find where its records go.
+    utilities::parallel_for(chunkCount, threadCount, [&](size_t c) {
+        size_t lines = 0;
+        for (const char* line = starts[c]; line < starts[c + 1];)
+        {
+            line = next_line(line_end(line, end), end);
+            ++lines;
+        }
+
+        firstRecord[c + 1] = lines;
+    });
+
+    for (size_t c = 0; c < chunkCount; ++c)
+    {
+        firstRecord[c + 1] += firstRecord[c];
+    }
+
+    bulk_result result;
+    result.records.resize(firstRecord[chunkCount]);
+    std::vector<size_t> counts(chunkCount * STATUS_COUNT, 0);
+    utilities::parallel_for(chunkCount, threadCount, [&](size_t c) {
+        bulk_record* out = result.records.data() + firstRecord[c];
+        size_t* chunkCounts = counts.data() + c * STATUS_COUNT;
+        for (const char* line = starts[c]; line < starts[c + 1];)
+        {
+            const char* lineEnd = line_end(line, end);
+            *out = check(data, line, lineEnd);
+            ++chunkCounts[static_cast<size_t>(out->status)];
+            ++out;
+            line = next_line(lineEnd, end);
+        }
+    });
+
+    std::fill(std::begin(result.counts), std::end(result.counts), 0);
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        result.counts[i % STATUS_COUNT] += counts[i];
+    }
+
+    return result;
+}
+} // namespace microsoft
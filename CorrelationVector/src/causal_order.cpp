@@ -0,0 +1,123 @@
+//---------------------------------------------------------------------
+// <copyright file="causal_order.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/causal_order.h"
+
+#include "parallel.h"
+#include <cstring>
+
+namespace microsoft
+{
+namespace
+{
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+int compare_bytes(const char* lhs,
+                  size_t lhsLength,
+                  const char* rhs,
+                  size_t rhsLength)
+{
+#pragma push_macro("min")
+#undef min
+    int result = std::memcmp(lhs, rhs, std::min(lhsLength, rhsLength));
+#pragma pop_macro("min")
+    if (result != 0)
+    {
+        return result;
+    }
+
+    return lhsLength < rhsLength ? -1 : (lhsLength > rhsLength ? 1 : 0);
+}
+} // namespace
+
+int causal_compare(const char* lhs,
+                   size_t lhsLength,
+                   const char* rhs,
+                   size_t rhsLength) noexcept
+{
+    // The base is everything up to the first delimiter and compares bytewise.
+    size_t i = 0;
+    size_t j = 0;
+    while (true)
+    {
+        const bool lhsEnd = i == lhsLength || lhs[i] == '.';
+        const bool rhsEnd = j == rhsLength || rhs[j] == '.';
+        if (lhsEnd || rhsEnd)
+        {
+            if (!rhsEnd) return -1;
+            if (!lhsEnd) return 1;
+            break;
+        }
+
+        if (lhs[i] != rhs[j])
+        {
+            return static_cast<unsigned char>(lhs[i]) <
+                           static_cast<unsigned char>(rhs[j])
+                       ? -1
+                       : 1;
+        }
+
+        ++i;
+        ++j;
+    }
+
+    // Extensions compare numerically; a vector precedes its descendants.
+    while (true)
+    {
+        const bool lhsMore = i < lhsLength && lhs[i] == '.';
+        const bool rhsMore = j < rhsLength && rhs[j] == '.';
+        if (!lhsMore || !rhsMore)
+        {
+            if (lhsMore) return 1;
+            if (rhsMore) return -1;
+            break;
+        }
+
+        size_t lhsStart = ++i;
+        size_t rhsStart = ++j;
+        while (i < lhsLength && is_digit(lhs[i])) ++i;
+        while (j < rhsLength && is_digit(rhs[j])) ++j;
+        while (lhsStart + 1 < i && lhs[lhsStart] == '0') ++lhsStart;
+        while (rhsStart + 1 < j && rhs[rhsStart] == '0') ++rhsStart;
+
+        // Without leading zeros, a longer run of digits is a larger number.
+        const size_t lhsDigits = i - lhsStart;
+        const size_t rhsDigits = j - rhsStart;
+        if (lhsDigits != rhsDigits)
+        {
+            return lhsDigits < rhsDigits ? -1 : 1;
+        }
+
+        int result = std::memcmp(lhs + lhsStart, rhs + rhsStart, lhsDigits);
+        if (result != 0)
+        {
+            return result;
+        }
+    }
+
+    const bool lhsTerminated = i < lhsLength && lhs[i] == '!';
+    const bool rhsTerminated = j < rhsLength && rhs[j] == '!';
+    if (lhsTerminated != rhsTerminated)
+    {
+        return lhsTerminated ? 1 : -1;
+    }
+
+    // Causally equivalent (e.g. leading zeros or trailing garbage); fall back
+    // to the raw bytes so that the ordering stays total.
+    return compare_bytes(lhs, lhsLength, rhs, rhsLength);
+}
+
+namespace impl
+{
+void sort_in_chunks(
+    size_t count,
+    unsigned int threadCount,
+    const std::function<void(size_t, size_t)>& sortRange,
+    const std::function<void(size_t, size_t, size_t)>& mergeRanges)
+{
+    utilities::parallel_sort_ranges(count, threadCount, sortRange, mergeRanges);
+}
+} // namespace impl
+} // namespace microsoft
@@ -0,0 +1,534 @@
+//---------------------------------------------------------------------
+// <copyright file="columnar.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/columnar.h"
+
+#include "correlation_vector/guid.h"
+#include "mapped_file.h"
+#include "utilities.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// File layout, all integers in native byte order:
+//   file header    "CVCOL01\0", uint32 block size, uint32 reserved
+//   blocks         block_header followed by its four columns
+//   dictionary     base_count entries of 16 raw bytes and 1 kind byte
+//   footer         uint64 dictionary offset, uint64 block count,
+//                  uint64 record count, uint32 base count, "CVCF"
+namespace microsoft
+{
+namespace
+{
+constexpr const char FILE_MAGIC[8] = {'C', 'V', 'C', 'O', 'L', '0', '1', 0};
+constexpr const char FOOTER_MAGIC[4] = {'C', 'V', 'C', 'F'};
+constexpr const size_t FILE_HEADER_SIZE = 16;
+constexpr const size_t FOOTER_SIZE = 32;
+constexpr const size_t DICTIONARY_ENTRY_SIZE = 17;
+
+// Dictionary entry kinds: the number of raw bytes encoded by the base.
+constexpr const unsigned char KIND_V1 = 12;
+constexpr const unsigned char KIND_V2 = 16;
+
+struct block_header
+{
+    uint32_t record_count;
+    uint32_t min_base;
+    uint32_t max_base;
+    uint32_t base_size;
+    uint32_t shape_size;
+    uint32_t segment_size;
+};
+
+void put_varint(std::vector<unsigned char>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// Reads a varint of a column ending at end. Block contents are not trusted:
+// a varint running past its column or past 64 bits is corrupt.
+uint64_t get_varint(const unsigned char*& in, const unsigned char* end)
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift <= 63 && in != end; shift += 7)
+    {
+        unsigned char byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            return value;
+        }
+    }
+
+    throw std::invalid_argument("Corrupt columnar block.");
+}
+
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void append_number(std::string& out, uint32_t value)
+{
+    char digits[10];
+    int count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0)
+    {
+        out += digits[--count];
+    }
+}
+
+[[noreturn]] void invalid(const std::string& correlationVector,
+                          const char* reason)
+{
+    // Only the start of an over-long value is quoted.
+    throw std::invalid_argument(
+        "Cannot archive correlation vector " +
+        correlationVector.substr(0, correlation_vector::MAX_VALUE_LENGTH) +
+        ": " + reason);
+}
+} // namespace
+
+columnar_writer::columnar_writer(std::ostream& out, size_t blockSize)
+    : m_out{out}, m_block_size{blockSize == 0 ? 1 : blockSize}
+{
+    char header[FILE_HEADER_SIZE] = {};
+    std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    uint32_t size = static_cast<uint32_t>(m_block_size);
+    std::memcpy(header + sizeof(FILE_MAGIC), &size, sizeof(size));
+    _write(header, sizeof(header));
+}
+
+columnar_writer::~columnar_writer()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void columnar_writer::_write(const void* data, size_t length)
+{
+    m_out.write(static_cast<const char*>(data),
+                static_cast<std::streamsize>(length));
+    if (!m_out)
+    {
+        throw std::runtime_error("Failed to write columnar archive.");
+    }
+
+    m_offset += length;
+}
+
+uint32_t columnar_writer::_base_id(const char* base, size_t length)
+{
+    std::string key{base, length};
+    auto it = m_base_ids.find(key);
+    if (it != m_base_ids.end())
+    {
+        return it->second;
+    }
+
+    std::array<unsigned char, DICTIONARY_ENTRY_SIZE> entry{};
+    if (!utilities::base64_decode(base, length, entry.data()))
+    {
+        invalid(key, "the base is not a raw 12 or 16 byte value");
+    }
+
+    entry[16] = length == 16 ? KIND_V1 : KIND_V2;
+    uint32_t id = static_cast<uint32_t>(m_dictionary.size());
+    m_dictionary.push_back(entry);
+    m_base_ids.emplace(std::move(key), id);
+    return id;
+}
+
+void columnar_writer::write(const std::string& correlationVector)
+{
+    if (m_closed)
+    {
+        throw std::logic_error("The columnar archive is already closed.");
+    }
+
+    const char* data = correlationVector.data();
+    size_t length = correlationVector.size();
+    if (length > correlation_vector::MAX_VALUE_LENGTH)
+    {
+        invalid(correlationVector, "too long");
+    }
+
+    const bool terminated =
+        length > 0 && data[length - 1] == correlation_vector::TERMINATOR;
+    if (terminated)
+    {
+        --length;
+    }
+
+    const size_t baseLength = utilities::base_length(data, length);
+    if ((baseLength != 16 && baseLength != 22) || baseLength == length)
+    {
+        invalid(correlationVector, "invalid base");
+    }
+
+    m_segments.clear();
+    for (size_t i = baseLength; i < length;)
+    {
+        size_t start = ++i;
+        uint64_t value = 0;
+        while (i < length && data[i] >= '0' && data[i] <= '9' &&
+               value <= 0xFFFFFFFF)
+        {
+            value = value * 10 + static_cast<uint64_t>(data[i++] - '0');
+        }
+
+        if (i == start || (i < length && data[i] != '.') ||
+            value > 0xFFFFFFFF || (data[start] == '0' && i - start > 1))
+        {
+            invalid(correlationVector, "invalid extension");
+        }
+
+        m_segments.push_back(static_cast<uint32_t>(value));
+    }
+
+    const uint32_t base = _base_id(data, baseLength);
+    if (m_block_records == 0)
+    {
+        m_block_min_base = m_block_max_base = base;
+    }
+
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+    m_block_min_base = std::min(m_block_min_base, base);
+    m_block_max_base = std::max(m_block_max_base, base);
+#pragma pop_macro("max")
+#pragma pop_macro("min")
+
+    size_t shared = 0;
+    if (base == m_previous_base)
+    {
+        while (shared < m_segments.size() &&
+               shared < m_previous_segments.size() &&
+               m_segments[shared] == m_previous_segments[shared])
+        {
+            ++shared;
+        }
+    }
+
+    put_varint(m_base_column,
+               zigzag(static_cast<int64_t>(base) - m_previous_base));
+    put_varint(m_shape_column, shared);
+    put_varint(m_shape_column, m_segments.size() - shared);
+    for (size_t i = shared; i < m_segments.size(); ++i)
+    {
+        if (i == shared && i < m_previous_segments.size())
+        {
+            put_varint(m_segment_column,
+                       zigzag(static_cast<int64_t>(m_segments[i]) -
+                              m_previous_segments[i]));
+        }
+        else
+        {
+            put_varint(m_segment_column, m_segments[i]);
+        }
+    }
+
+    if (m_block_records % 8 == 0)
+    {
+        m_terminator_column.push_back(0);
+    }
+
+    if (terminated)
+    {
+        m_terminator_column.back() |=
+            static_cast<unsigned char>(1 << (m_block_records % 8));
+    }
+
+    m_previous_base = base;
+    m_previous_segments.swap(m_segments);
+    ++m_record_count;
+    if (++m_block_records == m_block_size)
+    {
+        _flush_block();
+    }
+}
+
+void columnar_writer::_flush_block()
+{
+    if (m_block_records == 0)
+    {
+        return;
+    }
+
+    block_header header{m_block_records,
+                        m_block_min_base,
+                        m_block_max_base,
+                        static_cast<uint32_t>(m_base_column.size()),
+                        static_cast<uint32_t>(m_shape_column.size()),
+                        static_cast<uint32_t>(m_segment_column.size())};
+    _write(&header, sizeof(header));
+    _write(m_base_column.data(), m_base_column.size());
+    _write(m_shape_column.data(), m_shape_column.size());
+    _write(m_segment_column.data(), m_segment_column.size());
+    _write(m_terminator_column.data(), m_terminator_column.size());
+
+    m_base_column.clear();
+    m_shape_column.clear();
+    m_segment_column.clear();
+    m_terminator_column.clear();
+    m_block_records = 0;
+    m_previous_base = 0;
+    m_previous_segments.clear();
+    ++m_block_count;
+}
+
+void columnar_writer::close()
+{
+    if (m_closed)
+    {
+        return;
+    }
+
+    m_closed = true;
+    _flush_block();
+
+    const uint64_t dictionaryOffset = m_offset;
+    for (const std::array<unsigned char, DICTIONARY_ENTRY_SIZE>& entry :
+         m_dictionary)
+    {
+        _write(entry.data(), entry.size());
+    }
+
+    char footer[FOOTER_SIZE] = {};
+    const uint32_t baseCount = static_cast<uint32_t>(m_dictionary.size());
+    std::memcpy(footer, &dictionaryOffset, 8);
+    std::memcpy(footer + 8, &m_block_count, 8);
+    std::memcpy(footer + 16, &m_record_count, 8);
+    std::memcpy(footer + 24, &baseCount, 4);
+    std::memcpy(footer + 28, FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+    _write(footer, sizeof(footer));
+    m_out.flush();
+}
+
+struct columnar_reader::state
+{
+    utilities::mapped_file file;
+    const unsigned char* blocks_begin;
+    const unsigned char* blocks_end;
+    uint64_t record_count;
+    std::vector<std::string> bases;
+    std::unordered_map<std::string, uint32_t> base_ids;
+
+    explicit state(const std::string& path) : file{path} {}
+};
+
+columnar_reader::columnar_reader(const std::string& path)
+{
+    std::shared_ptr<state> s = std::make_shared<state>(path);
+    const unsigned char* data =
+        reinterpret_cast<const unsigned char*>(s->file.data());
+    const size_t size = s->file.size();
+    if (size < FILE_HEADER_SIZE + FOOTER_SIZE ||
+        std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        std::memcmp(data + size - sizeof(FOOTER_MAGIC),
+                    FOOTER_MAGIC,
+                    sizeof(FOOTER_MAGIC)) != 0)
+    {
+        throw std::invalid_argument(path + " is not a columnar archive.");
+    }
+
+    const unsigned char* footer = data + size - FOOTER_SIZE;
+    uint64_t dictionaryOffset;
+    uint32_t baseCount;
+    std::memcpy(&dictionaryOffset, footer, 8);
+    std::memcpy(&s->record_count, footer + 16, 8);
+    std::memcpy(&baseCount, footer + 24, 4);
+    if (dictionaryOffset < FILE_HEADER_SIZE ||
+        dictionaryOffset + uint64_t{baseCount} * DICTIONARY_ENTRY_SIZE !=
+            size - FOOTER_SIZE)
+    {
+        throw std::invalid_argument(path + " has a corrupt footer.");
+    }
+
+    s->blocks_begin = data + FILE_HEADER_SIZE;
+    s->blocks_end = data + dictionaryOffset;
+    s->bases.reserve(baseCount);
+    for (uint32_t id = 0; id < baseCount; ++id)
+    {
+        const unsigned char* entry =
+            s->blocks_end + size_t{id} * DICTIONARY_ENTRY_SIZE;
+        std::array<unsigned char, 16> bytes;
+        std::memcpy(bytes.data(), entry, bytes.size());
+        s->bases.push_back(
+            guid::create(bytes).to_base64_string(entry[16] == KIND_V1 ? 12
+                                                                       : 16));
+        s->base_ids.emplace(s->bases.back(), id);
+    }
+
+    m_state = std::move(s);
+}
+
+uint64_t columnar_reader::size() const { return m_state->record_count; }
+
+size_t columnar_reader::base_count() const { return m_state->bases.size(); }
+
+const std::string& columnar_reader::base(uint32_t id) const
+{
+    return m_state->bases.at(id);
+}
+
+columnar_reader::cursor columnar_reader::scan() const
+{
+    return cursor{m_state, 0, false};
+}
+
+columnar_reader::cursor columnar_reader::scan(const std::string& base) const
+{
+    auto it = m_state->base_ids.find(base);
+    cursor c{m_state, it == m_state->base_ids.end() ? 0 : it->second, true};
+    if (it == m_state->base_ids.end())
+    {
+        c.m_next_block = m_state->blocks_end;
+    }
+
+    return c;
+}
+
+columnar_reader::cursor::cursor(std::shared_ptr<const state> state,
+                                uint32_t filter,
+                                bool filtered)
+    : m_state{std::move(state)}
+    , m_filter{filter}
+    , m_filtered{filtered}
+    , m_next_block{m_state->blocks_begin}
+{
+}
+
+bool columnar_reader::cursor::_next_block()
+{
+    while (m_next_block < m_state->blocks_end)
+    {
+        block_header header;
+        if (static_cast<size_t>(m_state->blocks_end - m_next_block) <
+            sizeof(header))
+        {
+            throw std::invalid_argument("Corrupt columnar block.");
+        }
+
+        std::memcpy(&header, m_next_block, sizeof(header));
+        const unsigned char* columns = m_next_block + sizeof(header);
+        const size_t terminatorSize = (header.record_count + 7) / 8;
+        const size_t columnsSize = size_t{header.base_size} +
+                                   header.shape_size + header.segment_size +
+                                   terminatorSize;
+        if (static_cast<size_t>(m_state->blocks_end - columns) < columnsSize)
+        {
+            throw std::invalid_argument("Corrupt columnar block.");
+        }
+
+        m_next_block = columns + columnsSize;
+        if (m_filtered &&
+            (m_filter < header.min_base || m_filter > header.max_base))
+        {
+            continue;
+        }
+
+        m_base_column = columns;
+        m_base_end = m_shape_column = m_base_column + header.base_size;
+        m_shape_end = m_segment_column = m_shape_column + header.shape_size;
+        m_segment_end = m_terminator_column =
+            m_segment_column + header.segment_size;
+        m_block_records = header.record_count;
+        m_index = 0;
+        m_base = 0;
+        m_segments.clear();
+        return true;
+    }
+
+    return false;
+}
+
+bool columnar_reader::cursor::next()
+{
+    while (true)
+    {
+        if (m_index == m_block_records && !_next_block())
+        {
+            return false;
+        }
+
+        m_base = static_cast<uint32_t>(
+            m_base + unzigzag(get_varint(m_base_column, m_base_end)));
+        const uint64_t shared = get_varint(m_shape_column, m_shape_end);
+        const uint64_t fresh = get_varint(m_shape_column, m_shape_end);
+        if (m_base >= m_state->bases.size() || shared > m_segments.size())
+        {
+            throw std::invalid_argument("Corrupt columnar block.");
+        }
+
+        const bool hasPrevious = shared < m_segments.size();
+        const uint32_t previous = hasPrevious ? m_segments[shared] : 0;
+        m_segments.resize(static_cast<size_t>(shared));
+        for (uint64_t i = 0; i < fresh; ++i)
+        {
+            uint64_t raw = get_varint(m_segment_column, m_segment_end);
+            m_segments.push_back(
+                i == 0 && hasPrevious
+                    ? static_cast<uint32_t>(previous + unzigzag(raw))
+                    : static_cast<uint32_t>(raw));
+        }
+
+        m_terminated = (m_terminator_column[m_index / 8] >> (m_index % 8)) & 1;
+        ++m_index;
+        m_value_ready = false;
+        if (!m_filtered || m_base == m_filter)
+        {
+            return true;
+        }
+    }
+}
+
+const std::string& columnar_reader::cursor::value() const
+{
+    if (!m_value_ready)
+    {
+        m_value.assign(m_state->bases[m_base]);
+        for (uint32_t segment : m_segments)
+        {
+            m_value += '.';
+            append_number(m_value, segment);
+        }
+
+        if (m_terminated)
+        {
+            m_value += correlation_vector::TERMINATOR;
+        }
+
+        m_value_ready = true;
+    }
+
+    return m_value;
+}
+} // namespace microsoft
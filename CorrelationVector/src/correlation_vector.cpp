@@ -5,154 +5,345 @@
 //---------------------------------------------------------------------
 #include "correlation_vector/correlation_vector.h"
 
+#include "correlation_vector/correlation_vector_view.h"
 #include "correlation_vector/guid.h"
 #include "correlation_vector/spin_parameters.h"
+#include "counters.h"
+#include "recorder.h"
+#include "spin.h"
+#include "timing.h"
 #include "utilities.h"
-#include <chrono>
-#include <ctime>
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <limits> // std::numeric_limits
 #include <string>
-#include <vector>
 
 namespace microsoft
 {
+constexpr const char correlation_vector::HEADER_NAME[];
+constexpr const char correlation_vector::TERMINATOR;
+constexpr const size_t correlation_vector::MAX_VALUE_LENGTH;
+
+namespace
+{
+// The value quoted in exception messages, cut after the longest valid value
+// so that a huge input does not make a huge message.
+std::string quoted(const std::string& correlationVector)
+{
+    if (correlationVector.size() <= correlation_vector::MAX_VALUE_LENGTH)
+    {
+        return correlationVector;
+    }
+
+    return correlationVector.substr(0, correlation_vector::MAX_VALUE_LENGTH) +
+           "... (" + std::to_string(correlationVector.size()) +
+           " characters)";
+}
+
+// Whether the rules of earlier versions accept a value that _check rejects
+// for its base or an extension. They split the value on '.', skipping empty
+// segments, took the first segment as the base whatever its characters and
+// read each extension with std::stoi, which allows a sign. parse and extend
+// keep accepting such values; validate() rejects them.
+bool is_accepted_by_split(const char* correlationVector,
+                          size_t length,
+                          size_t baseLength) noexcept
+{
+    // Only a first terminator at the end was removed.
+    if (std::memchr(correlationVector,
+                    correlation_vector::TERMINATOR,
+                    length) == correlationVector + length - 1)
+    {
+        --length;
+    }
+
+    size_t segments = 0;
+    size_t position = 0;
+    while (position < length)
+    {
+        const size_t begin = position;
+        while (position < length && correlationVector[position] != '.')
+        {
+            ++position;
+        }
+
+        const size_t end = position++;
+        if (begin == end)
+        {
+            continue;
+        }
+
+        if (segments++ == 0)
+        {
+            if (end - begin != baseLength)
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        size_t i = begin;
+        const char sign = correlationVector[i];
+        if (sign == '+' || sign == '-')
+        {
+            ++i;
+        }
+
+        if (i == end)
+        {
+            return false;
+        }
+
+        uint64_t value = 0;
+        for (; i < end; ++i)
+        {
+            const char c = correlationVector[i];
+            if (c < '0' || c > '9')
+            {
+                return false;
+            }
+
+            value = std::min<uint64_t>(value * 10 + (c - '0'),
+                                       static_cast<uint64_t>(INT_MAX) + 1);
+        }
+
+        // std::stoi accepts "-0", the only signed value that is not negative.
+        if (value > INT_MAX || (sign == '-' && value != 0))
+        {
+            return false;
+        }
+    }
+
+    return segments >= 2;
+}
+} // namespace
+
+/* static */
+std::string correlation_vector::_base_from_guid(const guid& guid)
+{
+    utilities::count(utilities::counter::create);
+    std::string baseVector{
+        guid.to_base64_string().substr(0, correlation_vector::BASE_LENGTH_V2)};
+    utilities::record(flight_operation::create, baseVector, 0, false);
+    return baseVector;
+}
+
 /* static */
 std::string correlation_vector::_unique_value(
     correlation_vector_version version)
 {
+    utilities::count(utilities::counter::create);
+    std::string baseVector;
     switch (version)
     {
         case correlation_vector_version::v1:
-            return guid::create().to_base64_string(12);
+            baseVector = guid::create().to_base64_string(12);
             break;
         case correlation_vector_version::v2:
-            return guid::create().to_base64_string();
+            baseVector = guid::create().to_base64_string();
             break;
         default:
             throw std::invalid_argument(
                 "Unsupported correlation vector version " +
                 std::to_string(static_cast<int>(version)));
     }
+
+    utilities::record(flight_operation::create, baseVector, 0, false);
+    return baseVector;
 }
 
 /* static */
-correlation_vector_version correlation_vector::_infer_version(
-    const std::string& correlationVector)
+uint64_t correlation_vector::_hash_base(const std::string& baseVector)
 {
-    size_t index =
-        correlationVector.empty() ? -1 : correlationVector.find_first_of('.');
-    switch (index)
-    {
-        case BASE_LENGTH_V2: return correlation_vector_version::v2; break;
-        // fallback to v1 if not v2 or invalid.
-        case BASE_LENGTH_V1:
-        default: return correlation_vector_version::v1; break;
-    }
+    return utilities::fnv1a_64(
+        baseVector.data(),
+        utilities::base_length(baseVector.data(), baseVector.size()));
 }
 
 /* static */
-void correlation_vector::_validate(const std::string& correlationVector,
-                                   correlation_vector_version version)
+correlation_vector_version correlation_vector::_infer_version(
+    const char* correlationVector, size_t length) noexcept
 {
-    size_t maxVectorLength;
-    size_t baseLength;
+    // fallback to v1 if not v2 or invalid. Only the characters up to where
+    // the '.' of a v2 base would be are read, whatever the length.
+#pragma push_macro("min")
+#undef min
+    const size_t baseLength = utilities::base_length(
+        correlationVector, std::min(length, BASE_LENGTH_V2 + 1));
+#pragma pop_macro("min")
+    return baseLength == BASE_LENGTH_V2 && baseLength < length
+               ? correlation_vector_version::v2
+               : correlation_vector_version::v1;
+}
 
-    switch (version)
+/* static */
+validation_result correlation_vector::_check(
+    const char* correlationVector,
+    size_t length,
+    correlation_vector_version version,
+    size_t& segmentOffset,
+    size_t& segmentLength) noexcept
+{
+    segmentOffset = 0;
+    segmentLength = 0;
+    if (length == 0)
     {
-        case correlation_vector_version::v1:
-            maxVectorLength = MAX_VECTOR_LENGTH_V1;
-            baseLength = BASE_LENGTH_V1;
-            break;
-        case correlation_vector_version::v2:
-            maxVectorLength = MAX_VECTOR_LENGTH_V2;
-            baseLength = BASE_LENGTH_V2;
-            break;
-        default:
-            throw std::invalid_argument(
-                "Unsupported correlation vector version.");
+        return validation_result::empty;
     }
 
-    if (correlationVector.empty())
+    // Reject longer values before reading them, so that the cost of a check
+    // is bounded whatever the input.
+    if (length > _max_length(version) + 1)
     {
-        throw std::invalid_argument("Correlation vector cannot be empty.");
+        return validation_result::too_long;
     }
 
-    if (utilities::contains_whitespace(correlationVector))
+    for (size_t i = 0; i < length; ++i)
     {
-        throw std::invalid_argument("Correlation vector cannot contain "
-                                    "whitespace. Correlation vector: " +
-                                    correlationVector);
+        const char c = correlationVector[i];
+        if (c == ' ' || c == '\t' || c == '\n')
+        {
+            return validation_result::whitespace;
+        }
     }
 
-    // Check if last char is terminator and remove for further validation.
-    std::string notTerminatedCV{
-        correlationVector.find_first_of(TERMINATOR) ==
-                correlationVector.size() - 1
-            ? correlationVector.substr(0, correlationVector.size() - 1)
-            : correlationVector};
+    // A terminator is only allowed as the last character.
+    if (correlationVector[length - 1] == TERMINATOR)
+    {
+        --length;
+    }
 
-    if (notTerminatedCV.length() > maxVectorLength)
+    if (length > _max_length(version))
     {
-        throw std::invalid_argument("Correlation vector: " + correlationVector +
-                                    ", was bigger than the allowed range of " +
-                                    std::to_string(maxVectorLength) + ".");
+        return validation_result::too_long;
     }
 
-    std::vector<std::string> parts{utilities::split_str(notTerminatedCV, '.')};
-    if (parts.size() < 2 || parts[0].length() != baseLength)
+    const size_t baseLength = utilities::base_length(correlationVector, length);
+    segmentLength = baseLength;
+    if (baseLength != (version == correlation_vector_version::v2
+                           ? BASE_LENGTH_V2
+                           : BASE_LENGTH_V1) ||
+        baseLength == length)
     {
-        throw std::invalid_argument(
-            "Invalid correlation vector: " + correlationVector +
-            ". Invalid base value " + parts[0]);
+        return validation_result::invalid_base;
     }
 
-    // Validate each extension
-    for (size_t i = 1; i < parts.size(); ++i)
+    for (size_t i = 0; i < baseLength; ++i)
     {
-        std::size_t lastChar;
-        int result = -1;
-        try
+        if (utilities::base64_value(correlationVector[i]) < 0)
         {
-            result = std::stoi(parts[i], &lastChar, 10);
+            return validation_result::invalid_base;
         }
-        catch (const std::out_of_range&)
-        {
-        }
-        catch (const std::invalid_argument&)
+    }
+
+    // Each extension is a decimal number. Segments added by the spin operator
+    // are unsigned 32-bit values; only the last one is an int extension.
+    size_t position = baseLength;
+    while (position < length)
+    {
+        segmentOffset = ++position;
+        uint64_t value = 0;
+        bool isNumber = true;
+        while (position < length && correlationVector[position] != '.')
         {
+            const char c = correlationVector[position++];
+            isNumber = isNumber && c >= '0' && c <= '9';
+            value = std::min<uint64_t>(value * 10 + (c - '0'),
+                                       static_cast<uint64_t>(UINT_MAX) + 1);
         }
 
-        if (lastChar != parts[i].length() || result < 0)
+        segmentLength = position - segmentOffset;
+        const uint64_t maxValue = position == length ? INT_MAX : UINT_MAX;
+        if (segmentLength == 0 || !isNumber || value > maxValue)
         {
-            throw std::invalid_argument(
-                "Invalid correlation vector " + correlationVector +
-                ". Invalid extension value " + parts[i]);
+            return validation_result::invalid_extension;
         }
     }
+
+    segmentOffset = 0;
+    segmentLength = 0;
+    return validation_result::valid;
 }
 
-bool correlation_vector::_is_oversized(const std::string& baseVector,
-                                       int extension,
-                                       correlation_vector_version version)
+/* static */
+validation_result correlation_vector::validate(const char* correlationVector,
+                                               size_t length) noexcept
 {
-    if (baseVector.empty())
+    size_t segmentOffset;
+    size_t segmentLength;
+    return _check(correlationVector,
+                  length,
+                  _infer_version(correlationVector, length),
+                  segmentOffset,
+                  segmentLength);
+}
+
+/* static */
+void correlation_vector::_validate(const std::string& correlationVector,
+                                   correlation_vector_version version)
+{
+    size_t segmentOffset;
+    size_t segmentLength;
+    const validation_result result{_check(correlationVector.data(),
+                                          correlationVector.size(),
+                                          version,
+                                          segmentOffset,
+                                          segmentLength)};
+    if ((result == validation_result::invalid_base ||
+         result == validation_result::invalid_extension) &&
+        is_accepted_by_split(correlationVector.data(),
+                             correlationVector.size(),
+                             version == correlation_vector_version::v2
+                                 ? BASE_LENGTH_V2
+                                 : BASE_LENGTH_V1))
+    {
+        return;
+    }
+
+    if (result != validation_result::valid)
     {
-        return false;
+        utilities::count(result);
     }
 
-    size_t cvLen = baseVector.length() + 1 + _int_length(extension);
-    return (version == correlation_vector_version::v1 &&
-            cvLen > MAX_VECTOR_LENGTH_V1) ||
-           (version == correlation_vector_version::v2 &&
-            cvLen > MAX_VECTOR_LENGTH_V2);
+    switch (result)
+    {
+        case validation_result::valid: break;
+        case validation_result::empty:
+            throw std::invalid_argument("Correlation vector cannot be empty.");
+        case validation_result::whitespace:
+            throw std::invalid_argument("Correlation vector cannot contain "
+                                        "whitespace. Correlation vector: " +
+                                        quoted(correlationVector));
+        case validation_result::too_long:
+            throw std::invalid_argument(
+                "Correlation vector: " + quoted(correlationVector) +
+                ", was bigger than the allowed range of " +
+                std::to_string(_max_length(version)) + ".");
+        case validation_result::invalid_base:
+            throw std::invalid_argument(
+                "Invalid correlation vector: " + quoted(correlationVector) +
+                ". Invalid base value " +
+                correlationVector.substr(segmentOffset, segmentLength));
+        case validation_result::invalid_extension:
+            throw std::invalid_argument(
+                "Invalid correlation vector " + quoted(correlationVector) +
+                ". Invalid extension value " +
+                correlationVector.substr(segmentOffset, segmentLength));
+    }
 }
 
 correlation_vector correlation_vector::extend(
     const std::string& correlationVector)
 {
+    utilities::scoped_timer timer{timed_operation::extend};
+    utilities::count(utilities::counter::extend);
     if (_is_immutable(correlationVector))
     {
-        return parse(correlationVector);
+        correlation_vector result{_parse(correlationVector)};
+        utilities::record(flight_operation::extend, result);
+        return result;
     }
 
     correlation_vector_version version{_infer_version(correlationVector)};
@@ -160,9 +351,13 @@ correlation_vector correlation_vector::extend(
 
     if (_is_oversized(correlationVector, 0, version))
     {
-        return parse(correlationVector + TERMINATOR);
+        utilities::count(utilities::counter::oversize_termination);
+        correlation_vector result{_parse(correlationVector + TERMINATOR)};
+        utilities::record(flight_operation::extend, result);
+        return result;
     }
 
+    utilities::record(flight_operation::extend, correlationVector, 0, false);
     return {correlationVector, version};
 }
 
@@ -170,51 +365,138 @@ correlation_vector correlation_vector::extend(
 correlation_vector correlation_vector::spin(
     const std::string& correlationVector, const spin_parameters& parameters)
 {
+    utilities::scoped_timer timer{timed_operation::spin};
+    utilities::count(utilities::counter::spin);
     if (_is_immutable(correlationVector))
     {
-        return parse(correlationVector);
+        correlation_vector result{_parse(correlationVector)};
+        utilities::record(flight_operation::spin, result);
+        return result;
     }
 
     const correlation_vector_version version{_infer_version(correlationVector)};
     _validate(correlationVector, version);
 
-    const int entropyBytes{static_cast<int>(parameters.entropy())};
-    std::vector<unsigned char> entropy(entropyBytes);
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
-
-    for (int i = 0; i < entropyBytes; ++i)
+    const uint64_t value{utilities::spin_value(parameters)};
+    const int totalBits{parameters.total_bits()};
+    std::string s{std::to_string(static_cast<unsigned int>(value))};
+    if (totalBits > 32)
     {
-        entropy[i] = static_cast<unsigned char>(rand());
+        s = std::to_string(static_cast<unsigned int>(value >> 32)) + '.' + s;
     }
 
-    long long ticks{
-        std::chrono::system_clock::now().time_since_epoch().count()};
-    long long value{ticks >> static_cast<int>(parameters.interval())};
-    for (int i = 0; i < entropyBytes; ++i)
+    std::string baseVector;
+    baseVector.reserve(correlationVector.size() + 1 + s.size());
+    baseVector.append(correlationVector).append(1, '.').append(s);
+    if (_is_oversized(baseVector, version))
     {
-        value = (value << 8) | static_cast<uint64_t>(entropy[i]);
+        utilities::count(utilities::counter::oversize_termination);
+        correlation_vector result{_parse(correlationVector + TERMINATOR)};
+        utilities::record(flight_operation::spin, result);
+        return result;
     }
 
-    int totalBits{parameters.total_bits()};
-    value &= (totalBits == 64 ? 0 : (1LL << totalBits)) - 1;
+    utilities::record(flight_operation::spin, baseVector, 0, false);
+    return correlation_vector(baseVector, version);
+}
 
-    std::string s{std::to_string(static_cast<unsigned int>(value))};
-    if (totalBits > 32)
+/* static */
+void correlation_vector::spin_many(const std::string& correlationVector,
+                                   const spin_parameters& parameters,
+                                   size_t count,
+                                   correlation_vector* children)
+{
+    const int entropyBits{static_cast<int>(parameters.entropy()) * 8};
+    if (count > (1ULL << entropyBits))
     {
-        s = std::to_string(static_cast<unsigned int>(value >> 32)) + '.' + s;
+        throw std::invalid_argument(
+            "Cannot spin " + std::to_string(count) +
+            " distinct children with " + std::to_string(entropyBits) +
+            " bits of entropy.");
     }
 
-    std::string baseVector{correlationVector + '.' + s};
-    if (_is_oversized(baseVector, version))
+    if (count == 0)
     {
-        return parse(correlationVector + TERMINATOR);
+        return;
     }
 
-    return correlation_vector(baseVector, version);
+    if (_is_immutable(correlationVector))
+    {
+        const correlation_vector result{_parse(correlationVector)};
+        for (size_t i = 0; i < count; ++i)
+        {
+            utilities::count(utilities::counter::spin);
+            utilities::record(flight_operation::spin, result);
+            children[i] = result;
+        }
+
+        return;
+    }
+
+    const correlation_vector_version version{_infer_version(correlationVector)};
+    _validate(correlationVector, version);
+
+    const uint64_t baseHash{_hash_base(correlationVector)};
+    const bool isSplit{parameters.total_bits() > 32};
+    const utilities::spin_siblings values{parameters};
+    for (size_t i = 0; i < count; ++i)
+    {
+        utilities::count(utilities::counter::spin);
+        correlation_vector& child = children[i];
+
+        // The segments, written backwards: the low 32 bits and, for values
+        // of more than 32 bits, the high 32 bits before them.
+        char segments[22];
+        char* position = segments + sizeof(segments);
+        uint64_t value = values[i];
+        for (int segment = isSplit ? 2 : 1; segment > 0; --segment)
+        {
+            uint32_t part = static_cast<uint32_t>(value);
+            do
+            {
+                *--position = static_cast<char>('0' + part % 10);
+                part /= 10;
+            } while (part != 0);
+
+            *--position = '.';
+            value >>= 32;
+        }
+
+        const size_t segmentsLength =
+            static_cast<size_t>(segments + sizeof(segments) - position);
+        if (_is_oversized(correlationVector.size() + segmentsLength,
+                          0,
+                          version))
+        {
+            utilities::count(utilities::counter::oversize_termination);
+            child = _parse(correlationVector + TERMINATOR);
+            utilities::record(flight_operation::spin, child);
+            continue;
+        }
+
+        child.m_base_vector.assign(correlationVector);
+        child.m_base_vector.append(position, segmentsLength);
+        child.m_extension.store(0);
+        child.m_version = version;
+        child.m_is_immutable = false;
+        child.m_base_hash = baseHash;
+        child._init_value();
+        utilities::record(
+            flight_operation::spin, child.m_base_vector, 0, false);
+    }
 }
 
 correlation_vector correlation_vector::parse(
     const std::string& correlationVector)
+{
+    utilities::scoped_timer timer{timed_operation::parse};
+    utilities::count(utilities::counter::parse);
+    return _parse(correlationVector);
+}
+
+/* static */
+correlation_vector correlation_vector::_parse(
+    const std::string& correlationVector)
 {
     _validate(correlationVector, _infer_version(correlationVector));
     size_t p = correlationVector.find_last_of('.');
@@ -243,11 +525,100 @@ correlation_vector correlation_vector::parse(
     return {};
 }
 
-std::string correlation_vector::increment()
+size_t correlation_vector::copy_value(char* buffer, size_t capacity) const
+    noexcept
+{
+    return _copy_value(
+        buffer, capacity, m_extension.load(), m_is_immutable.load());
+}
+
+correlation_vector_view correlation_vector::view() const noexcept
 {
+    const bool isImmutable = m_is_immutable.load();
+    char digits[10];
+    size_t digitCount = 0;
+    unsigned int extension = static_cast<unsigned int>(m_extension.load());
+    do
+    {
+        digits[digitCount++] = static_cast<char>('0' + extension % 10);
+        extension /= 10;
+    } while (extension != 0);
+
+    size_t length = m_base_vector.size() + 1;
+    if (length + digitCount + (isImmutable ? 1 : 0) > sizeof(m_value))
+    {
+        // Only a base that was not validated can be this long.
+        return {m_value, 0};
+    }
+
+    while (digitCount != 0)
+    {
+        m_value[length++] = digits[--digitCount];
+    }
+
+    if (isImmutable)
+    {
+        m_value[length++] = TERMINATOR;
+    }
+
+    return {m_value, length};
+}
+
+void correlation_vector::_init_value() noexcept
+{
+    m_max_extension = _max_extension(m_base_vector.size(), m_version);
+    if (m_base_vector.size() < sizeof(m_value))
+    {
+        std::memcpy(m_value, m_base_vector.data(), m_base_vector.size());
+        m_value[m_base_vector.size()] = '.';
+    }
+}
+
+size_t correlation_vector::_copy_value(char* buffer,
+                                       size_t capacity,
+                                       int extensionValue,
+                                       bool isImmutable) const noexcept
+{
+    char digits[10];
+    size_t digitCount = 0;
+    unsigned int extension = static_cast<unsigned int>(extensionValue);
+    do
+    {
+        digits[digitCount++] = static_cast<char>('0' + extension % 10);
+        extension /= 10;
+    } while (extension != 0);
+
+    const size_t baseLength = m_base_vector.size();
+    const size_t length = baseLength + 1 + digitCount + (isImmutable ? 1 : 0);
+    if (length > capacity)
+    {
+        return 0;
+    }
+
+    std::memcpy(buffer, m_base_vector.data(), baseLength);
+    buffer[baseLength] = '.';
+    for (size_t i = 0; i < digitCount; ++i)
+    {
+        buffer[baseLength + 1 + i] = digits[digitCount - 1 - i];
+    }
+
+    if (isImmutable)
+    {
+        buffer[length - 1] = TERMINATOR;
+    }
+
+    return length;
+}
+
+int correlation_vector::_increment(bool& isImmutable) noexcept
+{
+    utilities::scoped_timer timer{timed_operation::increment};
+    utilities::count(utilities::counter::increment);
     if (m_is_immutable)
     {
-        return value();
+        utilities::record(flight_operation::increment, *this);
+        isImmutable = true;
+        return m_extension.load();
     }
 
     int snapshot = 0;
@@ -260,18 +631,43 @@ std::string correlation_vector::increment()
 #undef max
         if (snapshot == std::numeric_limits<int>::max())
         {
-            return value();
+            utilities::count(utilities::counter::int_max_saturation);
+            utilities::record(flight_operation::increment, *this);
+            isImmutable = m_is_immutable;
+            return snapshot;
         }
 #pragma pop_macro("max")
 
         next = snapshot + 1;
-        if (_is_oversized(m_base_vector, next, m_version))
+        if (next > m_max_extension)
         {
+            utilities::count(utilities::counter::oversize_termination);
             m_is_immutable = true;
-            return value();
+            utilities::record(flight_operation::increment, *this);
+            isImmutable = true;
+            return snapshot;
         }
     } while (!m_extension.compare_exchange_weak(snapshot, next));
 
-    return m_base_vector + '.' + std::to_string(next);
+    utilities::record(flight_operation::increment, m_base_vector, next, false);
+    isImmutable = false;
+    return next;
+}
+
+std::string correlation_vector::increment()
+{
+    bool isImmutable = false;
+    const int extension = _increment(isImmutable);
+    char buffer[MAX_VALUE_LENGTH];
+    return {buffer,
+            _copy_value(buffer, sizeof(buffer), extension, isImmutable)};
+}
+
+size_t correlation_vector::increment_into(char* buffer,
+                                          size_t capacity) noexcept
+{
+    bool isImmutable = false;
+    const int extension = _increment(isImmutable);
+    return _copy_value(buffer, capacity, extension, isImmutable);
 }
 } // namespace microsoft
@@ -0,0 +1,50 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_array.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/correlation_vector_array.h"
+
+#include <cstdint>
+#include <new>
+
+namespace microsoft
+{
+constexpr const size_t correlation_vector_array::ALIGNMENT;
+constexpr const size_t correlation_vector_array::SLOT_SIZE;
+
+correlation_vector_array::correlation_vector_array(
+    size_t size, correlation_vector_version version)
+{
+    // Room to align the first slot.
+    m_storage.reset(new unsigned char[size * SLOT_SIZE + ALIGNMENT - 1]);
+    const uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.get());
+    m_slots = m_storage.get() + (ALIGNMENT - address % ALIGNMENT) % ALIGNMENT;
+
+    try
+    {
+        for (; m_size < size; ++m_size)
+        {
+            new (m_slots + m_size * SLOT_SIZE) correlation_vector{version};
+        }
+    }
+    catch (...)
+    {
+        _destroy();
+        throw;
+    }
+}
+
+correlation_vector_array::~correlation_vector_array()
+{
+    _destroy();
+}
+
+void correlation_vector_array::_destroy() noexcept
+{
+    for (; m_size > 0; --m_size)
+    {
+        (*this)[m_size - 1].~correlation_vector();
+    }
+}
+} // namespace microsoft
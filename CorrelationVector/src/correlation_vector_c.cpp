@@ -0,0 +1,475 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_c.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/correlation_vector_c.h"
+
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/guid.h"
+#include "counters.h"
+#include "recorder.h"
+#include "spin.h"
+#include "timing.h"
+#include <climits>
+#include <cstring>
+
+namespace microsoft
+{
+/**
+The implementation of the C interface, with access to the checks of
+correlation_vector. Every entry point returns a status instead of throwing.
+*/
+class c_api
+{
+private:
+    struct state
+    {
+        // The value without the last extension and the terminator.
+        char base_vector[correlation_vector::MAX_VALUE_LENGTH];
+        int32_t extension;
+        uint8_t base_length;
+        uint8_t version;
+        uint8_t immutable;
+        uint8_t reserved;
+    };
+
+    static_assert(sizeof(state) <= sizeof(cv_handle) &&
+                      alignof(state) <= alignof(cv_handle),
+                  "cv_handle must be able to hold a c_api::state");
+
+    static state& _state(cv_handle* cv) noexcept
+    {
+        return *reinterpret_cast<state*>(cv->opaque);
+    }
+
+    static const state& _state(const cv_handle* cv) noexcept
+    {
+        return *reinterpret_cast<const state*>(cv->opaque);
+    }
+
+    static correlation_vector_version _version(const state& s) noexcept
+    {
+        return s.version != 0 ? correlation_vector_version::v2
+                              : correlation_vector_version::v1;
+    }
+
+    static size_t _write_number(uint32_t value, char* out) noexcept
+    {
+        char digits[10];
+        size_t count = 0;
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = digits[count - 1 - i];
+        }
+
+        return count;
+    }
+
+    static cv_status _status(validation_result result) noexcept
+    {
+        switch (result)
+        {
+            case validation_result::valid: return CV_OK;
+            case validation_result::empty: return CV_EMPTY;
+            case validation_result::whitespace: return CV_WHITESPACE;
+            case validation_result::too_long: return CV_TOO_LONG;
+            case validation_result::invalid_base: return CV_INVALID_BASE;
+            case validation_result::invalid_extension:
+                return CV_INVALID_EXTENSION;
+        }
+
+        return CV_ERROR;
+    }
+
+    static cv_status _validate(const char* value,
+                               size_t length,
+                               correlation_vector_version version) noexcept
+    {
+        size_t segmentOffset;
+        size_t segmentLength;
+        const validation_result result{correlation_vector::_check(
+            value, length, version, segmentOffset, segmentLength)};
+        if (result != validation_result::valid)
+        {
+            utilities::count(result);
+        }
+
+        return _status(result);
+    }
+
+    /**
+    Stores a validated value, splitting off its last extension. The last
+    extension must be in canonical form: where correlation_vector::parse
+    falls back to a new vector, this reports CV_INVALID_EXTENSION.
+    */
+    static cv_status _store(state& s,
+                            const char* value,
+                            size_t length,
+                            bool terminate) noexcept
+    {
+        const bool isImmutable =
+            value[length - 1] == correlation_vector::TERMINATOR;
+        const size_t end = isImmutable ? length - 1 : length;
+        size_t dot = end;
+        while (value[dot - 1] != '.')
+        {
+            --dot;
+        }
+
+        uint32_t extension = 0;
+        for (size_t i = dot; i < end; ++i)
+        {
+            extension = extension * 10 + static_cast<uint32_t>(value[i] - '0');
+        }
+
+        if (static_cast<size_t>(correlation_vector::_int_length(
+                static_cast<int>(extension))) != end - dot)
+        {
+            return CV_INVALID_EXTENSION;
+        }
+
+        std::memcpy(s.base_vector, value, dot - 1);
+        s.base_length = static_cast<uint8_t>(dot - 1);
+        s.extension = static_cast<int32_t>(extension);
+        s.version = correlation_vector::_infer_version(value, length) ==
+                            correlation_vector_version::v2
+                        ? 1
+                        : 0;
+        s.immutable = isImmutable || terminate ? 1 : 0;
+        return CV_OK;
+    }
+
+    static cv_status _value(const state& s,
+                            char* out,
+                            size_t capacity,
+                            size_t* length) noexcept
+    {
+        char digits[10];
+        const size_t digitCount =
+            _write_number(static_cast<uint32_t>(s.extension), digits);
+        const size_t required =
+            s.base_length + 1 + digitCount + (s.immutable ? 1 : 0);
+        if (length)
+        {
+            *length = required;
+        }
+
+        if (required > capacity)
+        {
+            return CV_BUFFER_TOO_SMALL;
+        }
+
+        std::memcpy(out, s.base_vector, s.base_length);
+        out[s.base_length] = '.';
+        std::memcpy(out + s.base_length + 1, digits, digitCount);
+        if (s.immutable)
+        {
+            out[required - 1] = correlation_vector::TERMINATOR;
+        }
+
+        return CV_OK;
+    }
+
+    static void _record(flight_operation operation, const state& s) noexcept
+    {
+        char value[correlation_vector::MAX_VALUE_LENGTH];
+        size_t length = 0;
+        _value(s, value, sizeof(value), &length);
+        utilities::record(operation, value, length);
+    }
+
+public:
+    static cv_status create(cv_handle* cv, cv_version version) noexcept
+    {
+        if (!cv || (version != CV_VERSION_1 && version != CV_VERSION_2))
+        {
+            return CV_INVALID_ARGUMENT;
+        }
+
+        utilities::count(utilities::counter::create);
+        try
+        {
+            state& s = _state(cv);
+            const guid id{guid::create()};
+            s.base_length = static_cast<uint8_t>(id.to_base64(
+                s.base_vector, version == CV_VERSION_2 ? 16 : 12));
+            s.extension = 0;
+            s.version = version == CV_VERSION_2 ? 1 : 0;
+            s.immutable = 0;
+            _record(flight_operation::create, s);
+            return CV_OK;
+        }
+        catch (...)
+        {
+            return CV_ERROR;
+        }
+    }
+
+    static cv_status parse(cv_handle* cv,
+                           const char* value,
+                           size_t length) noexcept
+    {
+        if (!cv || (!value && length != 0))
+        {
+            return CV_INVALID_ARGUMENT;
+        }
+
+        utilities::scoped_timer timer{timed_operation::parse};
+        utilities::count(utilities::counter::parse);
+        const cv_status status{_validate(
+            value, length, correlation_vector::_infer_version(value, length))};
+        return status == CV_OK ? _store(_state(cv), value, length, false)
+                               : status;
+    }
+
+    static cv_status extend(cv_handle* cv,
+                            const char* value,
+                            size_t length) noexcept
+    {
+        if (!cv || (!value && length != 0))
+        {
+            return CV_INVALID_ARGUMENT;
+        }
+
+        utilities::scoped_timer timer{timed_operation::extend};
+        utilities::count(utilities::counter::extend);
+        const correlation_vector_version version{
+            correlation_vector::_infer_version(value, length)};
+        cv_status status{_validate(value, length, version)};
+        if (status != CV_OK)
+        {
+            return status;
+        }
+
+        state& s = _state(cv);
+        const bool isImmutable =
+            value[length - 1] == correlation_vector::TERMINATOR;
+        if (isImmutable ||
+            correlation_vector::_is_oversized(length, 0, version))
+        {
+            if (!isImmutable)
+            {
+                utilities::count(utilities::counter::oversize_termination);
+            }
+
+            status = _store(s, value, length, true);
+        }
+        else
+        {
+            std::memcpy(s.base_vector, value, length);
+            s.base_length = static_cast<uint8_t>(length);
+            s.extension = 0;
+            s.version = version == correlation_vector_version::v2 ? 1 : 0;
+            s.immutable = 0;
+        }
+
+        if (status == CV_OK)
+        {
+            _record(flight_operation::extend, s);
+        }
+
+        return status;
+    }
+
+    static cv_status spin(cv_handle* cv,
+                          const char* value,
+                          size_t length,
+                          const cv_spin_parameters* parameters) noexcept
+    {
+        spin_parameters spinParameters;
+        if (parameters)
+        {
+            const int interval = parameters->interval;
+            const int periodicity = parameters->periodicity;
+            const int entropy = parameters->entropy;
+            if ((interval != 16 && interval != 24) ||
+                (periodicity != 0 && periodicity != 16 && periodicity != 24 &&
+                 periodicity != 32) ||
+                entropy < 0 || entropy > 4)
+            {
+                return CV_INVALID_ARGUMENT;
+            }
+
+            spinParameters = {static_cast<spin_counter_interval>(interval),
+                              static_cast<spin_counter_periodicity>(periodicity),
+                              static_cast<spin_entropy>(entropy)};
+        }
+
+        if (!cv || (!value && length != 0))
+        {
+            return CV_INVALID_ARGUMENT;
+        }
+
+        utilities::scoped_timer timer{timed_operation::spin};
+        utilities::count(utilities::counter::spin);
+        const correlation_vector_version version{
+            correlation_vector::_infer_version(value, length)};
+        cv_status status{_validate(value, length, version)};
+        if (status != CV_OK)
+        {
+            return status;
+        }
+
+        state& s = _state(cv);
+        if (value[length - 1] == correlation_vector::TERMINATOR)
+        {
+            status = _store(s, value, length, true);
+            if (status == CV_OK)
+            {
+                _record(flight_operation::spin, s);
+            }
+
+            return status;
+        }
+
+        const uint64_t spinValue{utilities::spin_value(spinParameters)};
+        char segments[22];
+        size_t segmentsLength = 0;
+        if (spinParameters.total_bits() > 32)
+        {
+            segments[segmentsLength++] = '.';
+            segmentsLength += _write_number(
+                static_cast<uint32_t>(spinValue >> 32),
+                segments + segmentsLength);
+        }
+
+        segments[segmentsLength++] = '.';
+        segmentsLength += _write_number(static_cast<uint32_t>(spinValue),
+                                        segments + segmentsLength);
+        if (correlation_vector::_is_oversized(
+                length + segmentsLength, 0, version))
+        {
+            utilities::count(utilities::counter::oversize_termination);
+            status = _store(s, value, length, true);
+        }
+        else
+        {
+            std::memcpy(s.base_vector, value, length);
+            std::memcpy(s.base_vector + length, segments, segmentsLength);
+            s.base_length = static_cast<uint8_t>(length + segmentsLength);
+            s.extension = 0;
+            s.version = version == correlation_vector_version::v2 ? 1 : 0;
+            s.immutable = 0;
+        }
+
+        if (status == CV_OK)
+        {
+            _record(flight_operation::spin, s);
+        }
+
+        return status;
+    }
+
+    static cv_status increment(cv_handle* cv,
+                               char* out,
+                               size_t capacity,
+                               size_t* length) noexcept
+    {
+        if (!cv)
+        {
+            return CV_INVALID_ARGUMENT;
+        }
+
+        utilities::scoped_timer timer{timed_operation::increment};
+        utilities::count(utilities::counter::increment);
+        state& s = _state(cv);
+        if (!s.immutable)
+        {
+            if (s.extension == INT_MAX)
+            {
+                utilities::count(utilities::counter::int_max_saturation);
+            }
+            else if (correlation_vector::_is_oversized(
+                         s.base_length, s.extension + 1, _version(s)))
+            {
+                utilities::count(utilities::counter::oversize_termination);
+                s.immutable = 1;
+            }
+            else
+            {
+                ++s.extension;
+            }
+        }
+
+        _record(flight_operation::increment, s);
+        if (!out)
+        {
+            _value(s, nullptr, 0, length);
+            return CV_OK;
+        }
+
+        return _value(s, out, capacity, length);
+    }
+
+    static cv_status value(const cv_handle* cv,
+                           char* out,
+                           size_t capacity,
+                           size_t* length) noexcept
+    {
+        if (!cv || (!out && capacity != 0))
+        {
+            return CV_INVALID_ARGUMENT;
+        }
+
+        return _value(_state(cv), out, capacity, length);
+    }
+
+    static int is_immutable(const cv_handle* cv) noexcept
+    {
+        return cv && _state(cv).immutable ? 1 : 0;
+    }
+};
+} // namespace microsoft
+
+extern "C" {
+cv_status cv_create(cv_handle* cv, cv_version version)
+{
+    return microsoft::c_api::create(cv, version);
+}
+
+cv_status cv_parse(cv_handle* cv, const char* value, size_t length)
+{
+    return microsoft::c_api::parse(cv, value, length);
+}
+
+cv_status cv_extend(cv_handle* cv, const char* value, size_t length)
+{
+    return microsoft::c_api::extend(cv, value, length);
+}
+
+cv_status cv_spin(cv_handle* cv,
+                  const char* value,
+                  size_t length,
+                  const cv_spin_parameters* parameters)
+{
+    return microsoft::c_api::spin(cv, value, length, parameters);
+}
+
+cv_status cv_increment(cv_handle* cv,
+                       char* out,
+                       size_t capacity,
+                       size_t* length)
+{
+    return microsoft::c_api::increment(cv, out, capacity, length);
+}
+
+cv_status cv_value(const cv_handle* cv,
+                   char* out,
+                   size_t capacity,
+                   size_t* length)
+{
+    return microsoft::c_api::value(cv, out, capacity, length);
+}
+
+int cv_is_immutable(const cv_handle* cv)
+{
+    return microsoft::c_api::is_immutable(cv);
+}
+}
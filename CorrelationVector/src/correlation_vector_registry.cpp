@@ -0,0 +1,203 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_registry.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/correlation_vector_registry.h"
+
+#include "utilities.h"
+#include <cstring>
+#include <utility>
+
+namespace microsoft
+{
+namespace
+{
+constexpr const size_t MIN_SLOTS = 16;
+
+size_t slot_count(size_t vectors)
+{
+    // Keep tables at most half full, so probes stay short.
+    size_t slots = MIN_SLOTS;
+    while (slots < vectors * 2)
+    {
+        slots *= 2;
+    }
+
+    return slots;
+}
+} // namespace
+
+correlation_vector_registry::correlation_vector_registry(size_t expectedSize)
+    : m_shards{new shard[SHARDS]}
+{
+    const size_t slots = slot_count(expectedSize / SHARDS + 1);
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        m_shards[i].slots.resize(slots);
+    }
+}
+
+/* static */
+uint64_t correlation_vector_registry::_hash(const char* baseVector,
+                                            size_t length) noexcept
+{
+    // Finish FNV-1a with a mixer, so that both the top bits, which pick the
+    // shard, and the low bits, which pick the slot, are well distributed.
+    return utilities::hash_base(baseVector, length);
+}
+
+/* static */
+const correlation_vector_registry::slot* correlation_vector_registry::_find(
+    const shard& shard,
+    uint64_t hash,
+    const char* baseVector,
+    size_t length) noexcept
+{
+    const size_t mask = shard.slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        const slot& candidate = shard.slots[i];
+        if (!candidate.vector && !candidate.erased)
+        {
+            return nullptr;
+        }
+
+        if (candidate.vector && candidate.hash == hash)
+        {
+            const std::string& base = candidate.vector->m_base_vector;
+            if (base.size() == length &&
+                std::memcmp(base.data(), baseVector, length) == 0)
+            {
+                return &candidate;
+            }
+        }
+    }
+}
+
+/* static */
+void correlation_vector_registry::_grow(shard& shard)
+{
+    std::vector<slot> slots(slot_count(shard.live + 1));
+    const size_t mask = slots.size() - 1;
+    for (slot& existing : shard.slots)
+    {
+        if (!existing.vector)
+        {
+            continue;
+        }
+
+        size_t i = existing.hash & mask;
+        while (slots[i].vector)
+        {
+            i = (i + 1) & mask;
+        }
+
+        slots[i].hash = existing.hash;
+        slots[i].vector = std::move(existing.vector);
+    }
+
+    shard.slots.swap(slots);
+    shard.used = shard.live;
+}
+
+std::shared_ptr<correlation_vector> correlation_vector_registry::insert(
+    const correlation_vector& correlationVector)
+{
+    const std::string& baseVector = correlationVector.m_base_vector;
+    const uint64_t hash = _hash(baseVector.data(), baseVector.size());
+    std::shared_ptr<correlation_vector> vector{
+        std::make_shared<correlation_vector>(correlationVector)};
+
+    shard& shard = _shard(hash);
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    const slot* existing =
+        _find(shard, hash, baseVector.data(), baseVector.size());
+    if (existing)
+    {
+        return existing->vector;
+    }
+
+    if ((shard.used + 1) * 4 > shard.slots.size() * 3)
+    {
+        _grow(shard);
+    }
+
+    // Reuse the first erased slot of the probe sequence, if any.
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = hash & mask;
+    while (shard.slots[i].vector)
+    {
+        i = (i + 1) & mask;
+    }
+
+    slot& target = shard.slots[i];
+    if (!target.erased)
+    {
+        ++shard.used;
+    }
+
+    target.hash = hash;
+    target.vector = vector;
+    target.erased = false;
+    ++shard.live;
+    return vector;
+}
+
+std::shared_ptr<correlation_vector> correlation_vector_registry::find(
+    const char* baseVector,
+    size_t length) const
+{
+    const uint64_t hash = _hash(baseVector, length);
+    const shard& shard = _shard(hash);
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    const slot* found = _find(shard, hash, baseVector, length);
+    return found ? found->vector : nullptr;
+}
+
+size_t correlation_vector_registry::increment(const char* baseVector,
+                                              size_t length,
+                                              char* buffer,
+                                              size_t capacity)
+{
+    // Holding a reference, rather than the lock, keeps the vector alive if
+    // another thread erases it meanwhile.
+    std::shared_ptr<correlation_vector> vector{find(baseVector, length)};
+    return vector ? vector->increment_into(buffer, capacity) : 0;
+}
+
+bool correlation_vector_registry::erase(const char* baseVector, size_t length)
+{
+    const uint64_t hash = _hash(baseVector, length);
+    shard& shard = _shard(hash);
+    std::shared_ptr<correlation_vector> erased;
+    {
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        slot* found =
+            const_cast<slot*>(_find(shard, hash, baseVector, length));
+        if (!found)
+        {
+            return false;
+        }
+
+        erased.swap(found->vector);
+        found->erased = true;
+        --shard.live;
+    }
+
+    // The vector is freed here, outside the lock, unless it is still in use.
+    return true;
+}
+
+size_t correlation_vector_registry::size() const
+{
+    size_t size = 0;
+    for (size_t i = 0; i < SHARDS; ++i)
+    {
+        std::lock_guard<std::mutex> lock{m_shards[i].mutex};
+        size += m_shards[i].live;
+    }
+
+    return size;
+}
+} // namespace microsoft
@@ -0,0 +1,85 @@
+//---------------------------------------------------------------------
+// <copyright file="correlation_vector_view.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/correlation_vector_view.h"
+
+#include "utilities.h"
+
+namespace microsoft
+{
+correlation_vector_version correlation_vector_view::version() const noexcept
+{
+    return correlation_vector::_infer_version(m_data, m_length);
+}
+
+correlation_vector_view correlation_vector_view::base() const noexcept
+{
+    return {m_data, utilities::base_length(m_data, m_length)};
+}
+
+correlation_vector_view correlation_vector_view::base_vector() const noexcept
+{
+    size_t length = _length();
+    while (length != 0 && m_data[length - 1] != '.')
+    {
+        --length;
+    }
+
+    return {m_data, length == 0 ? 0 : length - 1};
+}
+
+uint64_t correlation_vector_view::base_hash() const noexcept
+{
+    return utilities::fnv1a_64(m_data,
+                               utilities::base_length(m_data, m_length));
+}
+
+correlation_vector_view::segment_range correlation_vector_view::segments()
+    const noexcept
+{
+    const char* end = m_data + _length();
+    const char* first = m_data + utilities::base_length(m_data, _length());
+    if (first != end)
+    {
+        ++first;
+    }
+
+    return {{first, end}, {end, end}};
+}
+
+size_t correlation_vector_view::depth() const noexcept
+{
+    size_t depth = 0;
+    for (size_t i = 0, length = _length(); i < length; ++i)
+    {
+        depth += m_data[i] == '.' ? 1 : 0;
+    }
+
+    return depth;
+}
+
+int correlation_vector_view::last_extension() const noexcept
+{
+    const correlation_vector_view parent{base_vector()};
+    if (parent.m_length == 0)
+    {
+        return -1;
+    }
+
+    const size_t start = parent.m_length + 1;
+    unsigned int extension = 0;
+    for (size_t i = start, length = _length(); i < length; ++i)
+    {
+        extension = extension * 10 + static_cast<unsigned int>(m_data[i] - '0');
+    }
+
+    return static_cast<int>(extension);
+}
+
+correlation_vector correlation_vector_view::to_correlation_vector() const
+{
+    return correlation_vector::parse(to_string());
+}
+} // namespace microsoft
@@ -0,0 +1,60 @@
+//---------------------------------------------------------------------
+// <copyright file="counters.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include "correlation_vector/correlation_vector.h"
+#include "thread_shard.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace microsoft
+{
+namespace utilities
+{
+enum class counter : size_t
+{
+    create,
+    extend,
+    spin,
+    parse,
+    increment,
+    oversize_termination,
+    int_max_saturation,
+    // One counter per validation_result, starting with valid.
+    validation,
+    count = validation + 6
+};
+
+/**
+The counters of one thread, on their own cache lines. Threads that share a
+shard (see thread_shard) use atomic increments.
+*/
+struct alignas(64) counter_shard
+{
+    std::atomic<uint64_t> values[static_cast<size_t>(counter::count)];
+};
+
+extern counter_shard counter_shards[THREAD_SHARDS];
+
+#if defined(CV_INSTRUMENTATION)
+inline void count(counter c) noexcept
+{
+    const thread_shard& shard = current_thread_shard();
+    add(counter_shards[shard.index].values[static_cast<size_t>(c)],
+        1,
+        shard.shared);
+}
+#else
+inline void count(counter) noexcept {}
+#endif
+
+inline void count(validation_result reason) noexcept
+{
+    count(static_cast<counter>(static_cast<size_t>(counter::validation) +
+                               static_cast<size_t>(reason)));
+}
+} // namespace utilities
+} // namespace microsoft
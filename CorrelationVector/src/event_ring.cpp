@@ -0,0 +1,336 @@
+//---------------------------------------------------------------------
+// <copyright file="event_ring.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/event_ring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace microsoft
+{
+namespace
+{
+constexpr const char EVENT_FILE_MAGIC[8] = {
+    'C', 'V', 'E', 'V', 'T', '0', '1', '\0'};
+constexpr const size_t EVENT_FILE_HEADER_SIZE = 16;
+
+// Zeroes what the value and the payload leave of their fields, so that a
+// record reaches the sink without bytes of earlier events.
+void clear_tails(event_record& record) noexcept
+{
+    std::memset(record.cv + record.cv_length,
+                0,
+                sizeof(record.cv) - record.cv_length);
+    std::memset(record.payload + record.payload_length,
+                0,
+                sizeof(record.payload) - record.payload_length);
+}
+} // namespace
+
+constexpr const size_t event_record::PAYLOAD_CAPACITY;
+
+file_event_sink::file_event_sink(const std::string& path)
+    : m_file{std::fopen(path.c_str(), "wb")}
+{
+    if (!m_file)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Cannot open " + path);
+    }
+
+    char header[EVENT_FILE_HEADER_SIZE] = {};
+    const uint32_t recordSize = sizeof(event_record);
+    std::memcpy(header, EVENT_FILE_MAGIC, sizeof(EVENT_FILE_MAGIC));
+    std::memcpy(header + sizeof(EVENT_FILE_MAGIC), &recordSize, 4);
+    m_failed = std::fwrite(header, 1, sizeof(header), m_file) != sizeof(header);
+}
+
+file_event_sink::~file_event_sink()
+{
+    std::fclose(m_file);
+}
+
+void file_event_sink::write(const event_record* records, size_t count)
+{
+    if (std::fwrite(records, sizeof(event_record), count, m_file) != count)
+    {
+        m_failed = true;
+    }
+}
+
+void file_event_sink::flush()
+{
+    if (std::fflush(m_file) != 0)
+    {
+        m_failed = true;
+    }
+}
+
+/* static */
+std::vector<event_record> file_event_sink::read(const std::string& path)
+{
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file{
+        std::fopen(path.c_str(), "rb"), &std::fclose};
+    if (!file)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Cannot open " + path);
+    }
+
+    char header[EVENT_FILE_HEADER_SIZE];
+    uint32_t recordSize = 0;
+    if (std::fread(header, 1, sizeof(header), file.get()) == sizeof(header))
+    {
+        std::memcpy(&recordSize, header + sizeof(EVENT_FILE_MAGIC), 4);
+    }
+
+    if (std::memcmp(header, EVENT_FILE_MAGIC, sizeof(EVENT_FILE_MAGIC)) != 0 ||
+        recordSize != sizeof(event_record))
+    {
+        throw std::invalid_argument(path + " is not an event file.");
+    }
+
+    // A partial record at the end, left by a process that stopped while
+    // writing, is ignored.
+    std::vector<event_record> records;
+    event_record record;
+    while (std::fread(&record, sizeof(record), 1, file.get()) == 1)
+    {
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+/**
+A slot of the ring. The sequence tells producers and the consumer whose turn
+it is: it equals the position of the next producer that may fill the slot,
+and that position plus one once the record is ready to be consumed.
+*/
+struct event_ring::cell
+{
+    std::atomic<size_t> sequence;
+    event_record record;
+};
+
+event_ring::event_ring(event_sink& sink, const event_ring_options& options)
+    : m_sink(sink), m_options(options), m_mask{options.capacity - 1}
+{
+    if (options.capacity < 2 || (options.capacity & m_mask) != 0)
+    {
+        throw std::invalid_argument(
+            "Event ring capacity must be a power of two.");
+    }
+
+    if (options.batch_size == 0)
+    {
+        throw std::invalid_argument("Event ring batch size cannot be zero.");
+    }
+
+    m_cells.reset(new cell[options.capacity]());
+    for (size_t i = 0; i < options.capacity; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    m_consumer = std::thread{&event_ring::_consume, this};
+}
+
+event_ring::~event_ring()
+{
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stopping = true;
+    }
+
+    m_wake.notify_one();
+    m_consumer.join();
+}
+
+/* static */
+uint64_t event_ring::now() noexcept
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+event_ring::cell* event_ring::_claim(size_t& position) noexcept
+{
+    position = m_enqueue_position.value.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell& slot = m_cells[position & m_mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position)
+        {
+            if (m_enqueue_position.value.compare_exchange_weak(
+                    position, position + 1, std::memory_order_relaxed))
+            {
+                return &slot;
+            }
+        }
+        else if (sequence < position)
+        {
+            // The slot still holds the record from the previous lap.
+            if (m_options.policy == backpressure::drop)
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            std::this_thread::yield();
+            position = m_enqueue_position.value.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            position = m_enqueue_position.value.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void event_ring::_publish(cell* claimed, size_t position) noexcept
+{
+    claimed->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool event_ring::emit(const correlation_vector& correlationVector,
+                      uint32_t eventId,
+                      const void* payload,
+                      size_t payloadLength) noexcept
+{
+    if (payloadLength > event_record::PAYLOAD_CAPACITY)
+    {
+        return false;
+    }
+
+    const uint64_t timestamp = now();
+    size_t position;
+    cell* claimed = _claim(position);
+    if (!claimed)
+    {
+        return false;
+    }
+
+    event_record& record = claimed->record;
+    record.timestamp = timestamp;
+    record.event_id = eventId;
+    record.cv_length = static_cast<uint8_t>(
+        correlationVector.copy_value(record.cv, sizeof(record.cv)));
+    record.payload_length = static_cast<uint8_t>(payloadLength);
+    record.reserved = 0;
+    if (payloadLength != 0)
+    {
+        std::memcpy(record.payload, payload, payloadLength);
+    }
+
+    clear_tails(record);
+    _publish(claimed, position);
+    return true;
+}
+
+bool event_ring::emit(const char* cv,
+                      size_t cvLength,
+                      uint32_t eventId,
+                      uint64_t timestamp,
+                      const void* payload,
+                      size_t payloadLength) noexcept
+{
+    if (cvLength > correlation_vector::MAX_VALUE_LENGTH ||
+        payloadLength > event_record::PAYLOAD_CAPACITY)
+    {
+        return false;
+    }
+
+    size_t position;
+    cell* claimed = _claim(position);
+    if (!claimed)
+    {
+        return false;
+    }
+
+    event_record& record = claimed->record;
+    record.timestamp = timestamp;
+    record.event_id = eventId;
+    record.cv_length = static_cast<uint8_t>(cvLength);
+    record.payload_length = static_cast<uint8_t>(payloadLength);
+    record.reserved = 0;
+    std::memcpy(record.cv, cv, cvLength);
+    if (payloadLength != 0)
+    {
+        std::memcpy(record.payload, payload, payloadLength);
+    }
+
+    clear_tails(record);
+    _publish(claimed, position);
+    return true;
+}
+
+void event_ring::flush()
+{
+    const size_t target =
+        m_enqueue_position.value.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_wake.notify_one();
+    m_flushed.wait(lock, [this, target]() {
+        return m_flushed_position >= target;
+    });
+}
+
+void event_ring::_consume()
+{
+    std::vector<event_record> batch(m_options.batch_size);
+    size_t position = 0;
+    bool unflushed = false;
+    for (;;)
+    {
+        size_t count = 0;
+        while (count < batch.size())
+        {
+            cell& slot = m_cells[position & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                break;
+            }
+
+            batch[count++] = slot.record;
+            slot.sequence.store(position + m_mask + 1,
+                                std::memory_order_release);
+            ++position;
+        }
+
+        if (count != 0)
+        {
+            m_sink.write(batch.data(), count);
+            m_written.store(m_written.load(std::memory_order_relaxed) + count,
+                            std::memory_order_relaxed);
+            unflushed = true;
+            continue;
+        }
+
+        if (unflushed)
+        {
+            m_sink.flush();
+            unflushed = false;
+        }
+
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_flushed_position = position;
+        m_flushed.notify_all();
+
+        // Slots claimed but not yet published keep the consumer running.
+        if (m_stopping &&
+            position == m_enqueue_position.value.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        m_wake.wait_for(lock, m_options.idle_wait);
+    }
+}
+} // namespace microsoft
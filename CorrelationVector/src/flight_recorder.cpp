@@ -0,0 +1,401 @@
+//---------------------------------------------------------------------
+// <copyright file="flight_recorder.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/flight_recorder.h"
+
+#include "mapped_file.h"
+#include "recorder.h"
+#include "thread_shard.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <functional>
+#endif
+
+namespace microsoft
+{
+namespace
+{
+// File layout (native byte order): a file_header padded to 64 bytes, then
+// one region per thread shard. A region is a region_header padded to 64
+// bytes followed by its circular buffer of flight_records.
+constexpr const char FLIGHT_MAGIC[8] = {'C', 'V', 'F', 'L', 'T', '0', '1', 0};
+constexpr const size_t FILE_HEADER_SIZE = 64;
+constexpr const size_t REGION_HEADER_SIZE = 64;
+
+struct file_header
+{
+    char magic[8];
+    uint32_t record_size;
+    uint32_t records_per_thread;
+    uint32_t regions;
+    uint32_t reserved;
+};
+
+struct region_header
+{
+    // The sequence of the last complete record of the owner. Threads that
+    // share the region advance it before writing their record.
+    std::atomic<uint64_t> next;
+    uint64_t thread_id;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "region_header must have the layout of two uint64_t");
+
+struct recorder_state
+{
+    utilities::writable_mapped_file file;
+    size_t mask;
+    size_t region_size;
+
+    recorder_state(const std::string& path, size_t recordsPerThread)
+        : file{path,
+               FILE_HEADER_SIZE +
+                   utilities::THREAD_SHARDS *
+                       (REGION_HEADER_SIZE +
+                        recordsPerThread * sizeof(flight_record))}
+        , mask{recordsPerThread - 1}
+        , region_size{REGION_HEADER_SIZE +
+                      recordsPerThread * sizeof(flight_record)}
+    {
+    }
+
+    char* region(size_t index) const
+    {
+        return file.data() + FILE_HEADER_SIZE + index * region_size;
+    }
+};
+
+std::atomic<recorder_state*> active_recorder{nullptr};
+std::mutex start_mutex;
+
+// The number of threads of each shard writing a record. stop() detaches the
+// recorder and waits for them before it unmaps the file. Shards keep the
+// threads of a busy process off each other's counter.
+struct alignas(64) shard_writers
+{
+    std::atomic<uint32_t> count{0};
+};
+
+shard_writers recorder_writers[utilities::THREAD_SHARDS];
+
+/**
+Marks the calling thread as writing to the active recorder, if any, until it
+goes out of scope. The increment is ordered before the load of the recorder
+and stop() detaches it before it reads the counts, so either the thread
+finds no recorder or stop() waits for it.
+*/
+class recorder_writer
+{
+public:
+    recorder_writer() noexcept
+    {
+        if (!active_recorder.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        m_count = &recorder_writers[utilities::current_thread_shard().index]
+                       .count;
+        m_count->fetch_add(1);
+        m_state = active_recorder.load();
+    }
+
+    ~recorder_writer()
+    {
+        if (m_count)
+        {
+            m_count->fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    recorder_writer(const recorder_writer&) = delete;
+    recorder_writer& operator=(const recorder_writer&) = delete;
+
+    recorder_state* state() const noexcept { return m_state; }
+
+private:
+    std::atomic<uint32_t>* m_count{nullptr};
+    recorder_state* m_state{nullptr};
+};
+
+uint32_t current_thread_id() noexcept
+{
+#if defined(_WIN32)
+    static thread_local uint32_t id = GetCurrentThreadId();
+#elif defined(__linux__)
+    static thread_local uint32_t id =
+        static_cast<uint32_t>(::syscall(SYS_gettid));
+#else
+    static thread_local uint32_t id = static_cast<uint32_t>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    return id;
+}
+
+struct slot
+{
+    region_header* region;
+    flight_record* record;
+    uint64_t sequence;
+    bool shared;
+};
+
+/**
+Claims the calling thread's next slot and marks it as being written. The
+compiler barriers keep the stores in program order, so a crash leaves either
+a complete record or one with a zero sequence.
+*/
+slot claim(const recorder_state& state) noexcept
+{
+    const utilities::thread_shard& shard = utilities::current_thread_shard();
+    char* base = state.region(shard.index);
+    slot claimed;
+    claimed.region = reinterpret_cast<region_header*>(base);
+    claimed.shared = shard.shared;
+    claimed.sequence =
+        shard.shared
+            ? claimed.region->next.fetch_add(1, std::memory_order_relaxed) + 1
+            : claimed.region->next.load(std::memory_order_relaxed) + 1;
+    claimed.record =
+        reinterpret_cast<flight_record*>(base + REGION_HEADER_SIZE) +
+        ((claimed.sequence - 1) & state.mask);
+    claimed.record->sequence = 0;
+    std::atomic_signal_fence(std::memory_order_release);
+    const uint32_t threadId = current_thread_id();
+    claimed.region->thread_id = threadId;
+    claimed.record->thread_id = threadId;
+    return claimed;
+}
+
+void commit(const slot& claimed,
+            flight_operation operation,
+            size_t length) noexcept
+{
+    claimed.record->operation = static_cast<uint8_t>(operation);
+    claimed.record->length = static_cast<uint8_t>(length);
+    std::atomic_signal_fence(std::memory_order_release);
+    claimed.record->sequence = claimed.sequence;
+    if (!claimed.shared)
+    {
+        claimed.region->next.store(claimed.sequence,
+                                   std::memory_order_release);
+    }
+}
+} // namespace
+
+namespace utilities
+{
+void record_flight(flight_operation operation,
+                   const correlation_vector& correlationVector) noexcept
+{
+    const recorder_writer writer;
+    recorder_state* state = writer.state();
+    if (!state)
+    {
+        return;
+    }
+
+    const slot claimed{claim(*state)};
+    const size_t length = correlationVector.copy_value(
+        claimed.record->cv, sizeof(claimed.record->cv));
+    commit(claimed, operation, length);
+}
+
+void record_flight(flight_operation operation,
+                   const std::string& baseVector,
+                   int extension,
+                   bool isImmutable) noexcept
+{
+    const recorder_writer writer;
+    recorder_state* state = writer.state();
+    if (!state)
+    {
+        return;
+    }
+
+    char digits[10];
+    size_t digitCount = 0;
+    unsigned int value = static_cast<unsigned int>(extension);
+    do
+    {
+        digits[digitCount++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+#pragma push_macro("min")
+#undef min
+    const size_t baseLength =
+        std::min(baseVector.size(),
+                 correlation_vector::MAX_VALUE_LENGTH - 2 - digitCount);
+#pragma pop_macro("min")
+    const slot claimed{claim(*state)};
+    char* out = claimed.record->cv;
+    std::memcpy(out, baseVector.data(), baseLength);
+    out += baseLength;
+    *out++ = '.';
+    for (size_t i = digitCount; i > 0; --i)
+    {
+        *out++ = digits[i - 1];
+    }
+
+    if (isImmutable)
+    {
+        *out++ = correlation_vector::TERMINATOR;
+    }
+
+    commit(claimed, operation, static_cast<size_t>(out - claimed.record->cv));
+}
+
+void record_flight(flight_operation operation,
+                   const char* value,
+                   size_t length) noexcept
+{
+    const recorder_writer writer;
+    recorder_state* state = writer.state();
+    if (!state)
+    {
+        return;
+    }
+
+    const slot claimed{claim(*state)};
+#pragma push_macro("min")
+#undef min
+    length = std::min(length, sizeof(claimed.record->cv));
+#pragma pop_macro("min")
+    std::memcpy(claimed.record->cv, value, length);
+    commit(claimed, operation, length);
+}
+} // namespace utilities
+
+/* static */
+void flight_recorder::start(const std::string& path, size_t recordsPerThread)
+{
+    std::lock_guard<std::mutex> lock{start_mutex};
+    if (active_recorder.load())
+    {
+        throw std::logic_error("The flight recorder is already started.");
+    }
+
+    if (recordsPerThread == 0 ||
+        (recordsPerThread & (recordsPerThread - 1)) != 0)
+    {
+        throw std::invalid_argument(
+            "Flight recorder records per thread must be a power of two.");
+    }
+
+    std::unique_ptr<recorder_state> state{
+        new recorder_state{path, recordsPerThread}};
+    file_header header{};
+    std::memcpy(header.magic, FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC));
+    header.record_size = sizeof(flight_record);
+    header.records_per_thread = static_cast<uint32_t>(recordsPerThread);
+    header.regions = static_cast<uint32_t>(utilities::THREAD_SHARDS);
+    std::memcpy(state->file.data(), &header, sizeof(header));
+    for (size_t i = 0; i < utilities::THREAD_SHARDS; ++i)
+    {
+        new (state->region(i)) region_header{{0}, 0};
+    }
+
+    active_recorder.store(state.release(), std::memory_order_release);
+}
+
+/* static */
+void flight_recorder::stop()
+{
+    std::lock_guard<std::mutex> lock{start_mutex};
+    std::unique_ptr<recorder_state> state{active_recorder.exchange(nullptr)};
+    if (!state)
+    {
+        return;
+    }
+
+    for (const shard_writers& writers : recorder_writers)
+    {
+        while (writers.count.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    state->file.flush();
+}
+
+/* static */
+bool flight_recorder::active() noexcept
+{
+    return active_recorder.load(std::memory_order_relaxed) != nullptr;
+}
+
+/* static */
+std::vector<flight_thread> flight_recorder::read(const std::string& path)
+{
+    utilities::mapped_file file{path};
+    file_header header{};
+    if (file.size() >= FILE_HEADER_SIZE)
+    {
+        std::memcpy(&header, file.data(), sizeof(header));
+    }
+
+    const size_t perThread = header.records_per_thread;
+    const size_t regionSize =
+        REGION_HEADER_SIZE + perThread * sizeof(flight_record);
+    if (std::memcmp(header.magic, FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC)) != 0 ||
+        header.record_size != sizeof(flight_record) || perThread == 0 ||
+        file.size() != FILE_HEADER_SIZE + header.regions * regionSize)
+    {
+        throw std::invalid_argument(path + " is not a flight recorder file.");
+    }
+
+    std::vector<flight_thread> threads;
+    for (size_t i = 0; i < header.regions; ++i)
+    {
+        const char* region = file.data() + FILE_HEADER_SIZE + i * regionSize;
+        flight_thread thread;
+        std::memcpy(&thread.total, region, sizeof(uint64_t));
+        std::memcpy(
+            &thread.thread_id, region + sizeof(uint64_t), sizeof(uint64_t));
+        if (thread.total == 0)
+        {
+            continue;
+        }
+
+        const flight_record* records =
+            reinterpret_cast<const flight_record*>(region + REGION_HEADER_SIZE);
+        for (size_t r = 0; r < perThread; ++r)
+        {
+            const uint64_t sequence = records[r].sequence;
+            if (sequence != 0 && sequence <= thread.total &&
+                sequence + perThread > thread.total &&
+                records[r].length <= sizeof(records[r].cv))
+            {
+                thread.records.push_back(records[r]);
+            }
+        }
+
+        std::sort(thread.records.begin(),
+                  thread.records.end(),
+                  [](const flight_record& lhs, const flight_record& rhs) {
+                      return lhs.sequence < rhs.sequence;
+                  });
+        threads.push_back(std::move(thread));
+    }
+
+    return threads;
+}
+} // namespace microsoft
@@ -5,8 +5,12 @@
 //---------------------------------------------------------------------
 #include "correlation_vector/guid.h"
 
+#include "simd.h"
 #include "utilities.h"
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
 #ifdef GUID_BOOST
 #include <algorithm> // for std::transform
@@ -80,6 +84,16 @@ guid guid::create()
     return guid{impl::convert_to_array(g)};
 }
 
+guid guid::create(const std::array<unsigned char, 16>& bytes)
+{
+    return guid{bytes};
+}
+
+guid guid::create(std::array<unsigned char, 16>&& bytes)
+{
+    return guid{std::move(bytes)};
+}
+
 std::string guid::to_string() const
 {
     return utilities::to_hex_str(m_bytes.data(), 0, 4) + '-' +
@@ -94,22 +108,27 @@ static constexpr const unsigned char base64_table[65] =
 
 std::string guid::to_base64_string(int len) const
 {
-    int outputLength = static_cast<int>(ceil(len * 8 / 6.0));
-    std::string s(outputLength, ' ');
+    std::string s(static_cast<size_t>(ceil(len * 8 / 6.0)), ' ');
+    to_base64(&s[0], len);
+    return s;
+}
 
-    std::array<unsigned char, 3> buffer{0};
+size_t guid::to_base64(char* out, int len) const noexcept
+{
+    int outputLength = static_cast<int>(ceil(len * 8 / 6.0));
+    std::array<unsigned char, 3> buffer{{0}};
 
     for (int i = 0, j = 0; i < len; i++)
     {
         buffer[i % 3] = m_bytes[i];
         if ((i + 1) % 3 == 0)
         {
-            s[j] = base64_table[(buffer[0] & 0xFC) >> 2];
-            s[j + 1] = base64_table[((buffer[0] & 0x03) << 4) +
-                                    ((buffer[1] & 0xF0) >> 4)];
-            s[j + 2] = base64_table[((buffer[1] & 0x0F) << 2) +
-                                    ((buffer[2] & 0xC0) >> 6)];
-            s[j + 3] = base64_table[buffer[2] & 0x3F];
+            out[j] = base64_table[(buffer[0] & 0xFC) >> 2];
+            out[j + 1] = base64_table[((buffer[0] & 0x03) << 4) +
+                                      ((buffer[1] & 0xF0) >> 4)];
+            out[j + 2] = base64_table[((buffer[1] & 0x0F) << 2) +
+                                      ((buffer[2] & 0xC0) >> 6)];
+            out[j + 3] = base64_table[buffer[2] & 0x3F];
             j += 4;
         }
     }
@@ -125,18 +144,128 @@ std::string guid::to_base64_string(int len) const
         // Remaining Bytes can only be 1 or 2
         if (remainingBytes == 1)
         {
-            s[outputLength - 2] = base64_table[(buffer[0] & 0xFC) >> 2];
-            s[outputLength - 1] = base64_table[((buffer[0] & 0x03) << 4)];
+            out[outputLength - 2] = base64_table[(buffer[0] & 0xFC) >> 2];
+            out[outputLength - 1] = base64_table[((buffer[0] & 0x03) << 4)];
         }
         else
         {
-            s[outputLength - 3] = base64_table[(buffer[0] & 0xFC) >> 2];
-            s[outputLength - 2] = base64_table[((buffer[0] & 0x03) << 4) +
-                                               ((buffer[1] & 0xF0) >> 4)];
-            s[outputLength - 1] = base64_table[((buffer[1] & 0x0F) << 2)];
+            out[outputLength - 3] = base64_table[(buffer[0] & 0xFC) >> 2];
+            out[outputLength - 2] = base64_table[((buffer[0] & 0x03) << 4) +
+                                                 ((buffer[1] & 0xF0) >> 4)];
+            out[outputLength - 1] = base64_table[((buffer[1] & 0x0F) << 2)];
         }
     }
 
-    return s;
+    return static_cast<size_t>(outputLength);
+}
+
+/* static */
+bool guid::try_from_base64(const char* data,
+                           size_t length,
+                           guid& out) noexcept
+{
+    // 22 characters hold 132 bits: the 16 bytes and 4 zero bits. The second
+    // load overlaps the first so that neither reads past the end.
+    unsigned char sextets[22];
+    if (length != 22 || !utilities::base64_sextets(data, sextets) ||
+        !utilities::base64_sextets(data + 6, sextets + 6) ||
+        (sextets[21] & 0x0F) != 0)
+    {
+        return false;
+    }
+
+    unsigned char* bytes = out.m_bytes.data();
+    for (int i = 0; i < 5; ++i)
+    {
+        const unsigned char* s = sextets + i * 4;
+        const uint32_t group = (static_cast<uint32_t>(s[0]) << 18) |
+                               (static_cast<uint32_t>(s[1]) << 12) |
+                               (static_cast<uint32_t>(s[2]) << 6) | s[3];
+        bytes[i * 3] = static_cast<unsigned char>(group >> 16);
+        bytes[i * 3 + 1] = static_cast<unsigned char>(group >> 8);
+        bytes[i * 3 + 2] = static_cast<unsigned char>(group);
+    }
+
+    bytes[15] = static_cast<unsigned char>((sextets[20] << 2) |
+                                           (sextets[21] >> 4));
+    return true;
+}
+
+/* static */
+guid guid::from_base64(const std::string& base64)
+{
+    guid result;
+    if (!try_from_base64(base64.data(), base64.size(), result))
+    {
+        throw std::invalid_argument("Invalid base64 guid: " + base64);
+    }
+
+    return result;
+}
+
+/* static */
+size_t guid::from_base64_many(const char* const* bases,
+                              size_t count,
+                              guid* out) noexcept
+{
+    size_t decoded = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (try_from_base64(bases[i], 22, out[i]))
+        {
+            ++decoded;
+        }
+        else
+        {
+            out[i]._clear();
+        }
+    }
+
+    return decoded;
+}
+
+/* static */
+bool guid::try_parse(const char* data, size_t length, guid& out) noexcept
+{
+    if (length != 36 || data[8] != '-' || data[13] != '-' || data[18] != '-' ||
+        data[23] != '-')
+    {
+        return false;
+    }
+
+    // The 32 digits without the dashes.
+    char digits[32];
+    std::memcpy(digits, data, 8);
+    std::memcpy(digits + 8, data + 9, 4);
+    std::memcpy(digits + 12, data + 14, 4);
+    std::memcpy(digits + 16, data + 19, 4);
+    std::memcpy(digits + 20, data + 24, 12);
+
+    unsigned char nibbles[32];
+    if (!utilities::hex_nibbles(digits, nibbles) ||
+        !utilities::hex_nibbles(digits + 16, nibbles + 16))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        out.m_bytes[i] = static_cast<unsigned char>((nibbles[i * 2] << 4) |
+                                                    nibbles[i * 2 + 1]);
+    }
+
+    return true;
+}
+
+/* static */
+guid guid::parse(const std::string& value)
+{
+    guid result;
+    if (!try_parse(value.data(), value.size(), result))
+    {
+        throw std::invalid_argument("Invalid guid: " + value);
+    }
+
+    return result;
 }
 } // namespace microsoft
\ No newline at end of file
@@ -0,0 +1,302 @@
+//---------------------------------------------------------------------
+// <copyright file="http_headers.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/http_headers.h"
+
+#include "counters.h"
+#include "simd.h"
+#include <climits>
+#include <cstring>
+
+namespace microsoft
+{
+namespace
+{
+constexpr const char FIELD_NAME[] = "ms-cv:";
+constexpr const size_t FIELD_NAME_LENGTH = sizeof(FIELD_NAME) - 1;
+constexpr const char LINE_END[] = "\r\n";
+
+bool is_line_start_candidate(char c)
+{
+    return (c | 0x20) == 'm' || c == '\r' || c == '\n';
+}
+
+// Finds the next '\n' in [begin, end) that is followed by 'm', 'M' or the
+// end of the header block. Other lines cannot hold the field, so they are
+// skipped 16 bytes at a time when SSE2 is available.
+const char* find_line_start(const char* begin, const char* end)
+{
+#if defined(CV_HAS_SSE2)
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i lowercase = _mm_set1_epi8(0x20);
+    const __m128i m = _mm_set1_epi8('m');
+    for (; begin + 17 <= end; begin += 16)
+    {
+        __m128i current =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i next =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 1));
+        __m128i candidates = _mm_or_si128(
+            _mm_cmpeq_epi8(_mm_or_si128(next, lowercase), m),
+            _mm_or_si128(_mm_cmpeq_epi8(next, carriageReturn),
+                         _mm_cmpeq_epi8(next, newline)));
+        int mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(current, newline), candidates));
+        if (mask != 0)
+        {
+            return begin + utilities::count_trailing_zeros(
+                               static_cast<uint32_t>(mask));
+        }
+    }
+#endif
+
+    for (; begin + 1 < end; ++begin)
+    {
+        if (*begin == '\n' && is_line_start_candidate(begin[1]))
+        {
+            return begin;
+        }
+    }
+
+    return end;
+}
+
+bool is_field_name(const char* line, const char* end)
+{
+    if (static_cast<size_t>(end - line) < FIELD_NAME_LENGTH)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < FIELD_NAME_LENGTH; ++i)
+    {
+        const char c = FIELD_NAME[i] >= 'a' ? line[i] | 0x20 : line[i];
+        if (c != FIELD_NAME[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t int_length(unsigned int value)
+{
+    size_t length = 1;
+    for (; value >= 10; value /= 10)
+    {
+        ++length;
+    }
+
+    return length;
+}
+
+void write_int(char* out, size_t length, unsigned int value)
+{
+    for (size_t i = length; i > 0; --i, value /= 10)
+    {
+        out[i - 1] = static_cast<char>('0' + value % 10);
+    }
+}
+} // namespace
+
+/* static */
+header_field http_headers::find(const char* block, size_t length) noexcept
+{
+    header_field field;
+    const char* end = block + length;
+    const char* line = block;
+    while (line < end)
+    {
+        if (*line == '\r' || *line == '\n')
+        {
+            // The empty line ending the header block.
+            break;
+        }
+
+        if (is_field_name(line, end))
+        {
+            const char* value = line + FIELD_NAME_LENGTH;
+            const char* valueEnd = utilities::find_byte(value, end, '\n');
+            while (value < valueEnd && (*value == ' ' || *value == '\t'))
+            {
+                ++value;
+            }
+
+            while (valueEnd > value &&
+                   (valueEnd[-1] == ' ' || valueEnd[-1] == '\t' ||
+                    valueEnd[-1] == '\r'))
+            {
+                --valueEnd;
+            }
+
+            field.status = header_status::ok;
+            field.offset = static_cast<size_t>(value - block);
+            field.length = static_cast<size_t>(valueEnd - value);
+            return field;
+        }
+
+        line = find_line_start(line, end);
+        if (line == end)
+        {
+            break;
+        }
+
+        ++line;
+    }
+
+    return field;
+}
+
+/* static */
+header_result http_headers::extend(const char* block,
+                                   size_t length,
+                                   char* out,
+                                   size_t capacity) noexcept
+{
+    header_result result;
+    header_field field{find(block, length)};
+    if (field.status != header_status::ok)
+    {
+        result.status = field.status;
+        return result;
+    }
+
+    utilities::count(utilities::counter::extend);
+    const char* value = block + field.offset;
+    const correlation_vector_version version{
+        correlation_vector::_infer_version(value, field.length)};
+    size_t segmentOffset;
+    size_t segmentLength;
+    result.validation = correlation_vector::_check(
+        value, field.length, version, segmentOffset, segmentLength);
+    if (result.validation != validation_result::valid)
+    {
+        utilities::count(result.validation);
+        result.status = header_status::invalid;
+        return result;
+    }
+
+    // Like correlation_vector::extend: an immutable value is kept as is, and
+    // a value that cannot be extended any further is terminated.
+    const char* suffix = ".0";
+    if (value[field.length - 1] == correlation_vector::TERMINATOR)
+    {
+        suffix = "";
+    }
+    else if (correlation_vector::_is_oversized(field.length, 0, version))
+    {
+        utilities::count(utilities::counter::oversize_termination);
+        suffix = "!";
+    }
+
+    const size_t suffixLength = std::strlen(suffix);
+    if (capacity < field.length + suffixLength)
+    {
+        result.status = header_status::buffer_too_small;
+        return result;
+    }
+
+    std::memcpy(out, value, field.length);
+    std::memcpy(out + field.length, suffix, suffixLength);
+    result.status = header_status::ok;
+    result.length = field.length + suffixLength;
+    return result;
+}
+
+/* static */
+header_result http_headers::increment(char* value,
+                                      size_t& valueLength,
+                                      size_t valueCapacity,
+                                      char* line,
+                                      size_t lineCapacity) noexcept
+{
+    header_result result;
+    result.status = header_status::invalid;
+    result.validation = validation_result::invalid_extension;
+    if (valueLength == 0)
+    {
+        result.validation = validation_result::empty;
+        return result;
+    }
+
+    size_t newLength = valueLength;
+    size_t dot = valueLength;
+    unsigned int next = 0;
+    bool terminate = false;
+    bool saturated = false;
+    if (value[valueLength - 1] != correlation_vector::TERMINATOR)
+    {
+        unsigned long long extension = 0;
+        while (dot > 0 && value[dot - 1] >= '0' && value[dot - 1] <= '9')
+        {
+            --dot;
+        }
+
+        if (dot == 0 || dot == valueLength || value[dot - 1] != '.' ||
+            valueLength - dot > 10)
+        {
+            return result;
+        }
+
+        for (size_t i = dot; i < valueLength; ++i)
+        {
+            extension = extension * 10 + static_cast<unsigned>(value[i] - '0');
+        }
+
+        if (extension > INT_MAX)
+        {
+            return result;
+        }
+
+        saturated = extension == INT_MAX;
+        if (!saturated)
+        {
+            next = static_cast<unsigned int>(extension) + 1;
+            terminate = correlation_vector::_is_oversized(
+                dot - 1,
+                static_cast<int>(next),
+                correlation_vector::_infer_version(value, valueLength));
+            newLength = terminate ? valueLength + 1 : dot + int_length(next);
+        }
+    }
+
+    result.validation = validation_result::valid;
+    const size_t nameLength = sizeof(correlation_vector::HEADER_NAME) - 1;
+    const size_t lineLength = nameLength + 2 + newLength + 2;
+    if (newLength > valueCapacity || lineLength > lineCapacity)
+    {
+        result.status = header_status::buffer_too_small;
+        return result;
+    }
+
+    utilities::count(utilities::counter::increment);
+    if (saturated)
+    {
+        utilities::count(utilities::counter::int_max_saturation);
+    }
+
+    if (terminate)
+    {
+        utilities::count(utilities::counter::oversize_termination);
+        value[valueLength] = correlation_vector::TERMINATOR;
+    }
+    else if (newLength != valueLength || next != 0)
+    {
+        write_int(value + dot, newLength - dot, next);
+    }
+
+    valueLength = newLength;
+    std::memcpy(line, correlation_vector::HEADER_NAME, nameLength);
+    line[nameLength] = ':';
+    line[nameLength + 1] = ' ';
+    std::memcpy(line + nameLength + 2, value, newLength);
+    std::memcpy(line + nameLength + 2 + newLength, LINE_END, 2);
+    result.status = header_status::ok;
+    result.length = lineLength;
+    return result;
+}
+} // namespace microsoft
@@ -0,0 +1,82 @@
+//---------------------------------------------------------------------
+// <copyright file="instrumentation.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/instrumentation.h"
+
+#include "counters.h"
+
+namespace microsoft
+{
+namespace utilities
+{
+counter_shard counter_shards[THREAD_SHARDS];
+
+namespace
+{
+std::atomic<bool> thread_shard_owned[THREAD_SHARDS - 1];
+} // namespace
+
+thread_shard::thread_shard() noexcept : index{THREAD_SHARDS - 1}, shared{true}
+{
+    for (size_t i = 0; i + 1 < THREAD_SHARDS; ++i)
+    {
+        bool expected = false;
+        if (!thread_shard_owned[i].load(std::memory_order_relaxed) &&
+            thread_shard_owned[i].compare_exchange_strong(
+                expected, true, std::memory_order_acquire))
+        {
+            index = i;
+            shared = false;
+            break;
+        }
+    }
+}
+
+thread_shard::~thread_shard()
+{
+    if (!shared)
+    {
+        thread_shard_owned[index].store(false, std::memory_order_release);
+    }
+}
+} // namespace utilities
+
+/* static */
+instrumentation_counters instrumentation::snapshot() noexcept
+{
+    uint64_t totals[static_cast<size_t>(utilities::counter::count)] = {};
+    for (const utilities::counter_shard& shard : utilities::counter_shards)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(utilities::counter::count);
+             ++i)
+        {
+            totals[i] += shard.values[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    auto total = [&totals](utilities::counter c) {
+        return totals[static_cast<size_t>(c)];
+    };
+
+    instrumentation_counters counters;
+    counters.creates = total(utilities::counter::create);
+    counters.extends = total(utilities::counter::extend);
+    counters.spins = total(utilities::counter::spin);
+    counters.parses = total(utilities::counter::parse);
+    counters.increments = total(utilities::counter::increment);
+    counters.oversize_terminations =
+        total(utilities::counter::oversize_termination);
+    counters.int_max_saturations = total(utilities::counter::int_max_saturation);
+
+    // The valid entry is never counted, so it stays zero.
+    for (size_t i = 0; i < 6; ++i)
+    {
+        counters.validation_failures[i] =
+            totals[static_cast<size_t>(utilities::counter::validation) + i];
+    }
+
+    return counters;
+}
+} // namespace microsoft
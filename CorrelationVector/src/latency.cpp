@@ -0,0 +1,156 @@
+//---------------------------------------------------------------------
+// <copyright file="latency.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/latency.h"
+
+#include "simd.h"
+#include "timing.h"
+#include <new>
+
+namespace microsoft
+{
+constexpr const unsigned int latency_histogram::SUB_BUCKET_BITS;
+constexpr const size_t latency_histogram::SUB_BUCKETS;
+constexpr const unsigned int latency_histogram::MAX_VALUE_BITS;
+constexpr const size_t latency_histogram::BUCKETS;
+
+namespace utilities
+{
+std::atomic<latency_shard*> latency_shards[THREAD_SHARDS];
+
+latency_shard* create_latency_shard(size_t index) noexcept
+{
+    // Shards are never freed: a released shard keeps its counts and is
+    // reused by the next thread claiming its index.
+    latency_shard* created = new (std::nothrow) latency_shard();
+    if (!created)
+    {
+        return nullptr;
+    }
+
+    latency_shard* expected = nullptr;
+    if (!latency_shards[index].compare_exchange_strong(
+            expected, created, std::memory_order_acq_rel))
+    {
+        // Another thread sharing the overflow index got there first.
+        delete created;
+        return expected;
+    }
+
+    return created;
+}
+} // namespace utilities
+
+/* static */
+size_t latency_histogram::bucket(uint64_t nanoseconds)
+{
+    if (nanoseconds >> MAX_VALUE_BITS)
+    {
+        return BUCKETS - 1;
+    }
+
+    // Values below 2 * SUB_BUCKETS map to themselves; above, each power of
+    // two is split into SUB_BUCKETS linear steps of 2^shift.
+    const unsigned int width = utilities::bit_width(nanoseconds);
+    const unsigned int shift =
+        width > SUB_BUCKET_BITS + 1 ? width - SUB_BUCKET_BITS - 1 : 0;
+    return shift * SUB_BUCKETS + static_cast<size_t>(nanoseconds >> shift);
+}
+
+/* static */
+uint64_t latency_histogram::highest_value(size_t bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    const size_t shift = bucket / SUB_BUCKETS - 1;
+    return ((static_cast<uint64_t>(bucket - shift * SUB_BUCKETS) + 1)
+            << shift) -
+           1;
+}
+
+void latency_histogram::merge(const latency_histogram& other)
+{
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        m_counts[i] += other.m_counts[i];
+    }
+
+    m_count += other.m_count;
+    set_max(other.m_max);
+}
+
+uint64_t latency_histogram::value_at_percentile(double percentile) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    const double clamped =
+        percentile < 0.0 ? 0.0 : percentile > 100.0 ? 100.0 : percentile;
+    uint64_t rank = static_cast<uint64_t>(clamped / 100.0 * m_count + 0.5);
+    rank = rank == 0 ? 1 : rank;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        seen += m_counts[i];
+        if (seen >= rank)
+        {
+            const uint64_t value = highest_value(i);
+            return value < m_max ? value : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+/* static */
+latency_histogram latency::snapshot(timed_operation operation)
+{
+    const size_t op = static_cast<size_t>(operation);
+    latency_histogram histogram;
+    for (const std::atomic<utilities::latency_shard*>& slot :
+         utilities::latency_shards)
+    {
+        const utilities::latency_shard* shard =
+            slot.load(std::memory_order_acquire);
+        if (!shard)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < latency_histogram::BUCKETS; ++i)
+        {
+            const uint64_t count =
+                shard->counts[op][i].load(std::memory_order_relaxed);
+            if (count != 0)
+            {
+                histogram.add(i, count);
+            }
+        }
+
+        histogram.set_max(shard->max[op].load(std::memory_order_relaxed));
+    }
+
+    return histogram;
+}
+
+/* static */
+latency_summary latency::summary(timed_operation operation)
+{
+    const latency_histogram histogram{snapshot(operation)};
+    latency_summary summary;
+    summary.count = histogram.count();
+    summary.p50 = histogram.value_at_percentile(50.0);
+    summary.p99 = histogram.value_at_percentile(99.0);
+    summary.p999 = histogram.value_at_percentile(99.9);
+    summary.max = histogram.max();
+    return summary;
+}
+} // namespace microsoft
@@ -0,0 +1,325 @@
+//---------------------------------------------------------------------
+// <copyright file="mapped_file.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "mapped_file.h"
+
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace microsoft
+{
+namespace utilities
+{
+#if defined(_WIN32)
+mapped_file::mapped_file(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::system_error(static_cast<int>(GetLastError()),
+                                std::system_category(),
+                                "Cannot open " + path);
+    }
+
+    m_file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        int error = static_cast<int>(GetLastError());
+        _close();
+        throw std::system_error(
+            error, std::system_category(), "Cannot stat " + path);
+    }
+
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = m_mapping
+                           ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)
+                           : nullptr;
+    if (!view)
+    {
+        int error = static_cast<int>(GetLastError());
+        _close();
+        throw std::system_error(
+            error, std::system_category(), "Cannot map " + path);
+    }
+
+    m_data = static_cast<const char*>(view);
+}
+
+void mapped_file::_close() noexcept
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    if (m_file)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : m_data{other.m_data}
+    , m_size{other.m_size}
+    , m_file{other.m_file}
+    , m_mapping{other.m_mapping}
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_file = nullptr;
+    other.m_mapping = nullptr;
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other)
+    {
+        _close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_file, other.m_file);
+        std::swap(m_mapping, other.m_mapping);
+    }
+
+    return *this;
+}
+
+writable_mapped_file::writable_mapped_file(const std::string& path,
+                                           size_t size)
+{
+    HANDLE file = CreateFileA(path.c_str(),
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::system_error(static_cast<int>(GetLastError()),
+                                std::system_category(),
+                                "Cannot create " + path);
+    }
+
+    m_file = file;
+    const unsigned long long size64 = size;
+    m_mapping = CreateFileMappingA(file,
+                                   nullptr,
+                                   PAGE_READWRITE,
+                                   static_cast<DWORD>(size64 >> 32),
+                                   static_cast<DWORD>(size64),
+                                   nullptr);
+    void* view = m_mapping
+                     ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size)
+                     : nullptr;
+    if (!view)
+    {
+        int error = static_cast<int>(GetLastError());
+        _close();
+        throw std::system_error(
+            error, std::system_category(), "Cannot map " + path);
+    }
+
+    m_data = static_cast<char*>(view);
+    m_size = size;
+}
+
+void writable_mapped_file::flush() noexcept
+{
+    if (m_data)
+    {
+        FlushViewOfFile(m_data, m_size);
+    }
+}
+
+void writable_mapped_file::_close() noexcept
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    if (m_file)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+#else
+mapped_file::mapped_file(const std::string& path)
+{
+    m_file = ::open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Cannot open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(m_file, &status) != 0)
+    {
+        int error = errno;
+        _close();
+        throw std::system_error(
+            error, std::generic_category(), "Cannot stat " + path);
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        int error = errno;
+        _close();
+        throw std::system_error(
+            error, std::generic_category(), "Cannot map " + path);
+    }
+
+    m_data = static_cast<const char*>(data);
+}
+
+void mapped_file::_close() noexcept
+{
+    if (m_data)
+    {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+
+    if (m_file >= 0)
+    {
+        ::close(m_file);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : m_data{other.m_data}, m_size{other.m_size}, m_file{other.m_file}
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_file = -1;
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+{
+    if (this != &other)
+    {
+        _close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_file, other.m_file);
+    }
+
+    return *this;
+}
+
+writable_mapped_file::writable_mapped_file(const std::string& path,
+                                           size_t size)
+{
+    m_file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_file < 0)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Cannot create " + path);
+    }
+
+    if (::ftruncate(m_file, static_cast<off_t>(size)) != 0)
+    {
+        int error = errno;
+        _close();
+        throw std::system_error(
+            error, std::generic_category(), "Cannot resize " + path);
+    }
+
+    void* data =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        int error = errno;
+        _close();
+        throw std::system_error(
+            error, std::generic_category(), "Cannot map " + path);
+    }
+
+    m_data = static_cast<char*>(data);
+    m_size = size;
+}
+
+void writable_mapped_file::flush() noexcept
+{
+    if (m_data)
+    {
+        ::msync(m_data, m_size, MS_SYNC);
+    }
+}
+
+void writable_mapped_file::_close() noexcept
+{
+    if (m_data)
+    {
+        ::munmap(m_data, m_size);
+    }
+
+    if (m_file >= 0)
+    {
+        ::close(m_file);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+#endif
+} // namespace utilities
+} // namespace microsoft
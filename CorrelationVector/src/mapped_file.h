@@ -0,0 +1,82 @@
+//---------------------------------------------------------------------
+// <copyright file="mapped_file.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace microsoft
+{
+namespace utilities
+{
+/**
+Read-only memory mapping of a whole file. Throws std::system_error if the
+file cannot be opened or mapped.
+*/
+class mapped_file
+{
+private:
+    const char* m_data{nullptr};
+    size_t m_size{0};
+#if defined(_WIN32)
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#else
+    int m_file{-1};
+#endif
+
+    void _close() noexcept;
+
+public:
+    explicit mapped_file(const std::string& path);
+    ~mapped_file() { _close(); }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept;
+    mapped_file& operator=(mapped_file&& other) noexcept;
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+};
+
+/**
+Read-write shared memory mapping of a file that is created, or truncated, to a
+fixed size. Stores to the mapping reach the file even if the process dies
+without unmapping it. Throws std::system_error if the file cannot be created
+or mapped.
+*/
+class writable_mapped_file
+{
+private:
+    char* m_data{nullptr};
+    size_t m_size{0};
+#if defined(_WIN32)
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#else
+    int m_file{-1};
+#endif
+
+    void _close() noexcept;
+
+public:
+    writable_mapped_file(const std::string& path, size_t size);
+    ~writable_mapped_file() { _close(); }
+
+    writable_mapped_file(const writable_mapped_file&) = delete;
+    writable_mapped_file& operator=(const writable_mapped_file&) = delete;
+
+    char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    /**
+    Writes the dirty pages of the mapping to the file.
+    */
+    void flush() noexcept;
+};
+} // namespace utilities
+} // namespace microsoft
@@ -0,0 +1,133 @@
+//---------------------------------------------------------------------
+// <copyright file="parallel.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace microsoft
+{
+namespace utilities
+{
+inline unsigned int resolve_thread_count(unsigned int threadCount)
+{
+#pragma push_macro("max")
+#undef max
+    return threadCount == 0
+               ? std::max(1u, std::thread::hardware_concurrency())
+               : threadCount;
+#pragma pop_macro("max")
+}
+
+/**
+Runs task(i) for every i in [0, taskCount) on up to threadCount threads. Tasks
+are handed out dynamically, so uneven task sizes balance themselves. The
+calling thread participates, so a single thread never spawns anything, and
+runs everything if no thread can be started. If a task throws, the tasks not
+started yet are skipped and the first exception is rethrown once every
+thread joined.
+*/
+template <typename Task>
+void parallel_for(size_t taskCount, unsigned int threadCount, Task task)
+{
+    const size_t workers =
+        std::min<size_t>(resolve_thread_count(threadCount), taskCount);
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&next, &task, &error, &errorMutex, taskCount]() {
+        try
+        {
+            for (size_t i = next++; i < taskCount; i = next++)
+            {
+                task(i);
+            }
+        }
+        catch (...)
+        {
+            next = taskCount;
+            std::lock_guard<std::mutex> lock{errorMutex};
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i)
+    {
+        try
+        {
+            threads.emplace_back(worker);
+        }
+        catch (const std::system_error&)
+        {
+            break;
+        }
+    }
+
+    worker();
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+// Chunks smaller than this are not worth a thread of their own.
+constexpr const size_t MIN_PARALLEL_SORT_CHUNK = 1 << 15;
+
+/**
+Sorts the positions [0, count) of a range on up to threadCount threads: the
+range is cut into one chunk per thread, sortRange(begin, end) sorts each
+chunk and mergeRanges(begin, middle, end) merges neighbouring runs pairwise
+until a single run remains. Small ranges are sorted on the calling thread.
+*/
+template <typename SortRange, typename MergeRanges>
+void parallel_sort_ranges(size_t count,
+                          unsigned int threadCount,
+                          SortRange sortRange,
+                          MergeRanges mergeRanges)
+{
+    const size_t chunks = std::min<size_t>(resolve_thread_count(threadCount),
+                                           count / MIN_PARALLEL_SORT_CHUNK);
+    if (chunks < 2)
+    {
+        sortRange(0, count);
+        return;
+    }
+
+    auto bound = [count, chunks](size_t chunk) {
+        return count * chunk / chunks;
+    };
+
+    parallel_for(chunks, threadCount, [&](size_t i) {
+        sortRange(bound(i), bound(i + 1));
+    });
+
+    for (size_t width = 1; width < chunks; width *= 2)
+    {
+        parallel_for(
+            (chunks + width - 1) / (2 * width), threadCount, [&](size_t pair) {
+                const size_t i = pair * 2 * width;
+                mergeRanges(bound(i),
+                            bound(i + width),
+                            bound(std::min<size_t>(i + 2 * width, chunks)));
+            });
+    }
+}
+
+} // namespace utilities
+} // namespace microsoft
@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------
+// <copyright file="recorder.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/flight_recorder.h"
+#include <cstddef>
+#include <string>
+
+namespace microsoft
+{
+namespace utilities
+{
+/**
+Copies a Correlation Vector into the calling thread's next flight recorder
+slot, if the recorder is started.
+*/
+void record_flight(flight_operation operation,
+                   const correlation_vector& correlationVector) noexcept;
+
+/**
+Records the Correlation Vector made of a base vector and an extension, for
+callers that have not built the vector itself.
+*/
+void record_flight(flight_operation operation,
+                   const std::string& baseVector,
+                   int extension,
+                   bool isImmutable) noexcept;
+
+/**
+Records a Correlation Vector given as a string, for callers that only have
+its value.
+*/
+void record_flight(flight_operation operation,
+                   const char* value,
+                   size_t length) noexcept;
+
+#if defined(CV_FLIGHT_RECORDER)
+inline void record(flight_operation operation,
+                   const correlation_vector& correlationVector) noexcept
+{
+    record_flight(operation, correlationVector);
+}
+
+inline void record(flight_operation operation,
+                   const std::string& baseVector,
+                   int extension,
+                   bool isImmutable) noexcept
+{
+    record_flight(operation, baseVector, extension, isImmutable);
+}
+
+inline void record(flight_operation operation,
+                   const char* value,
+                   size_t length) noexcept
+{
+    record_flight(operation, value, length);
+}
+#else
+inline void record(flight_operation, const correlation_vector&) noexcept {}
+
+inline void record(flight_operation, const std::string&, int, bool) noexcept
+{
+}
+
+inline void record(flight_operation, const char*, size_t) noexcept {}
+#endif
+} // namespace utilities
+} // namespace microsoft
@@ -0,0 +1,359 @@
+//---------------------------------------------------------------------
+// <copyright file="shared_correlation_vector.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/shared_correlation_vector.h"
+
+#include "counters.h"
+#include "recorder.h"
+#include "timing.h"
+#include "utilities.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace microsoft
+{
+namespace
+{
+constexpr const uint32_t SEGMENT_MAGIC = 0x48535643; // "CVSH"
+constexpr const uint64_t EXTENSION_MASK = 0xffffffff;
+constexpr const uint64_t TERMINATED = uint64_t{1} << 32;
+
+// How long an attaching process waits for the creator to initialize the
+// counter.
+constexpr const std::chrono::seconds ATTACH_TIMEOUT{1};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "Shared counters need lock-free, address-free atomics");
+
+template <typename Ready>
+bool wait_until(Ready ready)
+{
+    const auto deadline = std::chrono::steady_clock::now() + ATTACH_TIMEOUT;
+    while (!ready())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+} // namespace
+
+/**
+The shared memory of one counter. The creator fills in the vector and
+publishes the segment by setting the magic last.
+*/
+struct shared_correlation_vector::segment
+{
+    // The extension in the low 32 bits and the TERMINATED flag, so that
+    // increments and termination are one compare-and-swap.
+    std::atomic<uint64_t> state;
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t base_length;
+    char base_vector[correlation_vector::MAX_VALUE_LENGTH];
+};
+
+shared_correlation_vector::shared_correlation_vector(
+    const correlation_vector& correlationVector)
+    : m_base_vector{correlationVector.m_base_vector}
+    , m_version{correlationVector.m_version}
+{
+    const std::string name{segment_name(correlationVector)};
+    void* memory = nullptr;
+    bool created = false;
+#if defined(_WIN32)
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                        nullptr,
+                                        PAGE_READWRITE,
+                                        0,
+                                        sizeof(segment),
+                                        name.c_str());
+    if (!mapping)
+    {
+        throw std::system_error(static_cast<int>(GetLastError()),
+                                std::system_category(),
+                                "Cannot create " + name);
+    }
+
+    created = GetLastError() != ERROR_ALREADY_EXISTS;
+    m_mapping = mapping;
+    memory = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(segment));
+    if (!memory)
+    {
+        int error = static_cast<int>(GetLastError());
+        _close();
+        throw std::system_error(
+            error, std::system_category(), "Cannot map " + name);
+    }
+#else
+    int file = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    created = file >= 0;
+    if (!created && errno == EEXIST)
+    {
+        file = ::shm_open(name.c_str(), O_RDWR, 0600);
+    }
+
+    if (file < 0)
+    {
+        throw std::system_error(
+            errno, std::generic_category(), "Cannot open " + name);
+    }
+
+    int error = 0;
+    if (created)
+    {
+        error = ::ftruncate(file, sizeof(segment)) == 0 ? 0 : errno;
+    }
+    else if (!wait_until([file]() {
+                 struct stat status;
+                 return ::fstat(file, &status) == 0 &&
+                        static_cast<size_t>(status.st_size) >= sizeof(segment);
+             }))
+    {
+        error = ETIMEDOUT;
+    }
+
+    if (error == 0)
+    {
+        memory = ::mmap(nullptr,
+                        sizeof(segment),
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        file,
+                        0);
+        error = memory == MAP_FAILED ? errno : 0;
+    }
+
+    ::close(file);
+    if (error != 0)
+    {
+        if (created)
+        {
+            ::shm_unlink(name.c_str());
+        }
+
+        throw std::system_error(
+            error, std::generic_category(), "Cannot map " + name);
+    }
+#endif
+
+    if (created)
+    {
+        m_segment = new (memory) segment{};
+        m_segment->version = static_cast<uint32_t>(m_version);
+        m_segment->base_length = static_cast<uint32_t>(m_base_vector.size());
+        std::memcpy(
+            m_segment->base_vector, m_base_vector.data(), m_base_vector.size());
+        m_segment->state.store(
+            static_cast<uint64_t>(correlationVector.m_extension.load()) |
+                (correlationVector.m_is_immutable ? TERMINATED : 0),
+            std::memory_order_relaxed);
+        m_segment->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+        return;
+    }
+
+    m_segment = static_cast<segment*>(memory);
+    const segment* attached = m_segment;
+    if (!wait_until([attached]() {
+            return attached->magic.load(std::memory_order_acquire) ==
+                   SEGMENT_MAGIC;
+        }))
+    {
+        _close();
+        throw std::system_error(std::make_error_code(std::errc::timed_out),
+                                name + " was not initialized");
+    }
+
+    if (m_segment->version != static_cast<uint32_t>(m_version) ||
+        m_segment->base_length != m_base_vector.size() ||
+        std::memcmp(m_segment->base_vector,
+                    m_base_vector.data(),
+                    m_base_vector.size()) != 0)
+    {
+        _close();
+        throw std::invalid_argument(
+            name + " holds the counter of another correlation vector.");
+    }
+}
+
+shared_correlation_vector::shared_correlation_vector(
+    shared_correlation_vector&& other) noexcept
+    : m_base_vector{std::move(other.m_base_vector)}
+    , m_version{other.m_version}
+    , m_segment{other.m_segment}
+#if defined(_WIN32)
+    , m_mapping{other.m_mapping}
+#endif
+{
+    other.m_segment = nullptr;
+#if defined(_WIN32)
+    other.m_mapping = nullptr;
+#endif
+}
+
+shared_correlation_vector& shared_correlation_vector::operator=(
+    shared_correlation_vector&& other) noexcept
+{
+    if (this != &other)
+    {
+        _close();
+        std::swap(m_base_vector, other.m_base_vector);
+        std::swap(m_version, other.m_version);
+        std::swap(m_segment, other.m_segment);
+#if defined(_WIN32)
+        std::swap(m_mapping, other.m_mapping);
+#endif
+    }
+
+    return *this;
+}
+
+void shared_correlation_vector::_close() noexcept
+{
+#if defined(_WIN32)
+    if (m_segment)
+    {
+        UnmapViewOfFile(m_segment);
+    }
+
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+
+    m_mapping = nullptr;
+#else
+    if (m_segment)
+    {
+        ::munmap(m_segment, sizeof(segment));
+    }
+#endif
+    m_segment = nullptr;
+}
+
+/* static */
+std::string shared_correlation_vector::segment_name(
+    const correlation_vector& correlationVector)
+{
+    const std::string& baseVector = correlationVector.m_base_vector;
+    char name[32];
+    std::snprintf(name,
+                  sizeof(name),
+#if defined(_WIN32)
+                  "Local\\cv-%016llx",
+#else
+                  "/cv-%016llx",
+#endif
+                  static_cast<unsigned long long>(utilities::fnv1a_64(
+                      baseVector.data(), baseVector.size())));
+    return name;
+}
+
+/* static */
+void shared_correlation_vector::remove(
+    const correlation_vector& correlationVector) noexcept
+{
+#if !defined(_WIN32)
+    try
+    {
+        ::shm_unlink(segment_name(correlationVector).c_str());
+    }
+    catch (...)
+    {
+    }
+#else
+    (void)correlationVector;
+#endif
+}
+
+std::string shared_correlation_vector::_value(uint64_t state) const
+{
+    std::string value{m_base_vector + '.' +
+                      std::to_string(state & EXTENSION_MASK)};
+    if ((state & TERMINATED) != 0)
+    {
+        value += correlation_vector::TERMINATOR;
+    }
+
+    return value;
+}
+
+std::string shared_correlation_vector::value() const
+{
+    return _value(m_segment->state.load());
+}
+
+bool shared_correlation_vector::is_immutable() const
+{
+    return (m_segment->state.load() & TERMINATED) != 0;
+}
+
+std::string shared_correlation_vector::increment()
+{
+    utilities::scoped_timer timer{timed_operation::increment};
+    utilities::count(utilities::counter::increment);
+    uint64_t snapshot = m_segment->state.load();
+    for (;;)
+    {
+        const int extension = static_cast<int>(snapshot & EXTENSION_MASK);
+        const bool isImmutable = (snapshot & TERMINATED) != 0;
+        if (isImmutable || extension == INT_MAX)
+        {
+            if (!isImmutable)
+            {
+                utilities::count(utilities::counter::int_max_saturation);
+            }
+
+            utilities::record(flight_operation::increment,
+                              m_base_vector,
+                              extension,
+                              isImmutable);
+            return _value(snapshot);
+        }
+
+        // Like correlation_vector::increment, a vector that would grow past
+        // its maximum length keeps its extension and is terminated instead.
+        const bool terminate = correlation_vector::_is_oversized(
+            m_base_vector, extension + 1, m_version);
+        const uint64_t next = terminate ? snapshot | TERMINATED : snapshot + 1;
+        if (m_segment->state.compare_exchange_weak(snapshot, next))
+        {
+            if (terminate)
+            {
+                utilities::count(utilities::counter::oversize_termination);
+            }
+
+            utilities::record(flight_operation::increment,
+                              m_base_vector,
+                              static_cast<int>(next & EXTENSION_MASK),
+                              terminate);
+            return _value(next);
+        }
+    }
+}
+} // namespace microsoft
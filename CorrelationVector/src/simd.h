@@ -0,0 +1,200 @@
+//---------------------------------------------------------------------
+// <copyright file="simd.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include "utilities.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CV_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace microsoft
+{
+namespace utilities
+{
+inline unsigned int count_trailing_zeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctz(value));
+#endif
+}
+
+inline unsigned int bit_width(uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    return _BitScanReverse64(&index, value) ? index + 1 : 0;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanReverse(&index, static_cast<uint32_t>(value >> 32)))
+    {
+        return index + 33;
+    }
+
+    return _BitScanReverse(&index, static_cast<uint32_t>(value)) ? index + 1
+                                                                 : 0;
+#else
+    return value == 0
+               ? 0
+               : 64 - static_cast<unsigned int>(__builtin_clzll(value));
+#endif
+}
+
+// Hints that the cache line holding address will be read soon.
+inline void prefetch(const void* address)
+{
+#if defined(CV_HAS_SSE2)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+/**
+Finds the first occurrence of a byte in [begin, end), 16 bytes at a time when
+SSE2 is available.
+@return A pointer to the byte, or end if it does not occur.
+*/
+inline const char* find_byte(const char* begin, const char* end, char c)
+{
+#if defined(CV_HAS_SSE2)
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; begin + 16 <= end; begin += 16)
+    {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask != 0)
+        {
+            return begin + count_trailing_zeros(static_cast<uint32_t>(mask));
+        }
+    }
+#endif
+
+    const void* found =
+        begin < end ? std::memchr(begin, c, static_cast<size_t>(end - begin))
+                    : nullptr;
+    return found ? static_cast<const char*>(found) : end;
+}
+#if defined(CV_HAS_SSE2)
+// 0xFF in the bytes of c between low and high, inclusive. Bytes of 0x80 and
+// above are negative and never in an ASCII range.
+inline __m128i bytes_in_range(__m128i c, char low, char high)
+{
+    return _mm_and_si128(
+        _mm_cmpgt_epi8(c, _mm_set1_epi8(static_cast<char>(low - 1))),
+        _mm_cmplt_epi8(c, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+#endif
+
+/**
+Translates 16 base64 characters into their 6-bit values, all at once when
+SSE2 is available.
+@return false if a character is outside the base64 alphabet.
+*/
+inline bool base64_sextets(const char* in, unsigned char* out)
+{
+#if defined(CV_HAS_SSE2)
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i upper = bytes_in_range(c, 'A', 'Z');
+    const __m128i lower = bytes_in_range(c, 'a', 'z');
+    const __m128i digit = bytes_in_range(c, '0', '9');
+    const __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+    const __m128i valid = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)),
+        slash);
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+    {
+        return false;
+    }
+
+    // The difference between each character and its value.
+    const __m128i offset = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                     _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+        _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                         _mm_and_si128(plus, _mm_set1_epi8(62 - '+'))),
+            _mm_and_si128(slash, _mm_set1_epi8(63 - '/'))));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(c, offset));
+    return true;
+#else
+    for (int i = 0; i < 16; ++i)
+    {
+        const int value = base64_value(in[i]);
+        if (value < 0)
+        {
+            return false;
+        }
+
+        out[i] = static_cast<unsigned char>(value);
+    }
+
+    return true;
+#endif
+}
+
+/**
+Translates 16 hexadecimal digits, in either case, into their 4-bit values,
+all at once when SSE2 is available.
+@return false if a character is not a hexadecimal digit.
+*/
+inline bool hex_nibbles(const char* in, unsigned char* out)
+{
+#if defined(CV_HAS_SSE2)
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i digit = bytes_in_range(c, '0', '9');
+    const __m128i upper = bytes_in_range(c, 'A', 'F');
+    const __m128i lower = bytes_in_range(c, 'a', 'f');
+    const __m128i valid = _mm_or_si128(_mm_or_si128(digit, upper), lower);
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+    {
+        return false;
+    }
+
+    const __m128i offset = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(-'0')),
+                     _mm_and_si128(upper, _mm_set1_epi8(10 - 'A'))),
+        _mm_and_si128(lower, _mm_set1_epi8(10 - 'a')));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(c, offset));
+    return true;
+#else
+    for (int i = 0; i < 16; ++i)
+    {
+        const char c = in[i];
+        const int value = c >= '0' && c <= '9'
+                              ? c - '0'
+                              : c >= 'A' && c <= 'F'
+                                    ? c - 'A' + 10
+                                    : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (value < 0)
+        {
+            return false;
+        }
+
+        out[i] = static_cast<unsigned char>(value);
+    }
+
+    return true;
+#endif
+}
+} // namespace utilities
+} // namespace microsoft
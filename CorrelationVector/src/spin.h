@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------
+// <copyright file="spin.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include "correlation_vector/spin_parameters.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <thread>
+
+namespace microsoft
+{
+namespace utilities
+{
+/**
+Computes the segments the spin operator appends: the clock ticks shifted by
+the interval, followed by the entropy bytes, keeping the low total_bits()
+bits. Values of more than 32 bits are written as two segments.
+*/
+inline uint64_t spin_value(const spin_parameters& parameters) noexcept
+{
+    const int entropyBytes{static_cast<int>(parameters.entropy())};
+    unsigned char entropy[4];
+    std::srand(static_cast<unsigned int>(std::time(nullptr)));
+
+    for (int i = 0; i < entropyBytes; ++i)
+    {
+        entropy[i] = static_cast<unsigned char>(rand());
+    }
+
+    long long ticks{
+        std::chrono::system_clock::now().time_since_epoch().count()};
+    long long value{ticks >> static_cast<int>(parameters.interval())};
+    for (int i = 0; i < entropyBytes; ++i)
+    {
+        value = (value << 8) | static_cast<uint64_t>(entropy[i]);
+    }
+
+    int totalBits{parameters.total_bits()};
+    value &= (totalBits == 64 ? 0 : (1LL << totalBits)) - 1;
+    return static_cast<uint64_t>(value);
+}
+
+/**
+Computes the spin values of siblings with one clock read. The entropy of
+each sibling is a bijection of a random seed and its index over the entropy
+bits, so siblings never collide as long as there are at most
+2^(8 * entropy) of them. Values of more than 32 bits are written as two
+segments.
+*/
+class spin_siblings
+{
+private:
+    uint64_t m_seed;
+    uint64_t m_counter;
+    uint64_t m_entropy_mask;
+    uint64_t m_mask;
+    int m_shift;
+
+public:
+    explicit spin_siblings(const spin_parameters& parameters) noexcept
+    {
+        // A splitmix64 sequence per thread, seeded from the clock and the
+        // thread.
+        static thread_local uint64_t state{
+            static_cast<uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count()) ^
+            std::hash<std::thread::id>{}(std::this_thread::get_id())};
+        uint64_t seed = (state += 0x9E3779B97F4A7C15ULL);
+        seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+        m_seed = seed ^ (seed >> 31);
+
+        const int entropyBits{static_cast<int>(parameters.entropy()) * 8};
+        long long ticks{
+            std::chrono::system_clock::now().time_since_epoch().count()};
+        m_counter = static_cast<uint64_t>(
+                        ticks >> static_cast<int>(parameters.interval()))
+                    << entropyBits;
+        m_entropy_mask = (1ULL << entropyBits) - 1;
+        m_shift = entropyBits / 2;
+        const int totalBits{parameters.total_bits()};
+        m_mask = totalBits == 64 ? ~0ULL : (1ULL << totalBits) - 1;
+    }
+
+    uint64_t operator[](size_t index) const noexcept
+    {
+        // Odd multipliers and right xorshifts are bijections modulo 2^k.
+        uint64_t entropy = (m_seed + index) & m_entropy_mask;
+        entropy = (entropy * 0x9E3779B97F4A7C15ULL) & m_entropy_mask;
+        entropy ^= entropy >> m_shift;
+        entropy = (entropy * 0xBF58476D1CE4E5B9ULL) & m_entropy_mask;
+        entropy ^= entropy >> m_shift;
+        return (m_counter | entropy) & m_mask;
+    }
+};
+} // namespace utilities
+} // namespace microsoft
@@ -0,0 +1,55 @@
+//---------------------------------------------------------------------
+// <copyright file="thread_shard.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace microsoft
+{
+namespace utilities
+{
+constexpr const size_t THREAD_SHARDS = 128;
+
+/**
+An index into per-thread statistics. Each thread claims an index from a fixed
+pool and releases it when it exits; the statistics stay in the shard, to be
+continued by the next owner. Threads that find no free index share the last
+one.
+*/
+struct thread_shard
+{
+    size_t index;
+    bool shared;
+
+    thread_shard() noexcept;
+    ~thread_shard();
+};
+
+inline const thread_shard& current_thread_shard() noexcept
+{
+    static thread_local thread_shard shard;
+    return shard;
+}
+
+/**
+Adds to a per-thread statistic. The owner of a shard is its only writer, so it
+can use relaxed loads and stores instead of a locked instruction.
+*/
+inline void add(std::atomic<uint64_t>& value, uint64_t amount, bool shared)
+{
+    if (shared)
+    {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    else
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount,
+                    std::memory_order_relaxed);
+    }
+}
+} // namespace utilities
+} // namespace microsoft
@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------
+// <copyright file="timing.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+#include "correlation_vector/latency.h"
+#include "thread_shard.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace microsoft
+{
+namespace utilities
+{
+constexpr const size_t TIMED_OPERATIONS = 4;
+
+/**
+The histograms of one thread, allocated the first time it records.
+*/
+struct latency_shard
+{
+    std::atomic<uint64_t> counts[TIMED_OPERATIONS][latency_histogram::BUCKETS];
+    std::atomic<uint64_t> max[TIMED_OPERATIONS];
+};
+
+extern std::atomic<latency_shard*> latency_shards[THREAD_SHARDS];
+
+latency_shard* create_latency_shard(size_t index) noexcept;
+
+inline void record(timed_operation operation, uint64_t nanoseconds) noexcept
+{
+    const thread_shard& shard = current_thread_shard();
+    latency_shard* histograms =
+        latency_shards[shard.index].load(std::memory_order_acquire);
+    if (!histograms)
+    {
+        histograms = create_latency_shard(shard.index);
+        if (!histograms)
+        {
+            return;
+        }
+    }
+
+    const size_t op = static_cast<size_t>(operation);
+    add(histograms->counts[op][latency_histogram::bucket(nanoseconds)],
+        1,
+        shard.shared);
+
+    std::atomic<uint64_t>& max = histograms->max[op];
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (nanoseconds > current &&
+           !max.compare_exchange_weak(
+               current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+/**
+Times the enclosing scope, including scopes left by an exception.
+*/
+class scoped_timer
+{
+#if defined(CV_LATENCY_HISTOGRAMS)
+private:
+    timed_operation m_operation;
+    std::chrono::steady_clock::time_point m_start;
+
+public:
+    explicit scoped_timer(timed_operation operation) noexcept
+        : m_operation{operation}, m_start{std::chrono::steady_clock::now()}
+    {
+    }
+
+    ~scoped_timer()
+    {
+        record(m_operation,
+               static_cast<uint64_t>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - m_start)
+                       .count()));
+    }
+#else
+public:
+    explicit scoped_timer(timed_operation) noexcept {}
+#endif
+
+    scoped_timer(const scoped_timer&) = delete;
+    scoped_timer& operator=(const scoped_timer&) = delete;
+};
+} // namespace utilities
+} // namespace microsoft
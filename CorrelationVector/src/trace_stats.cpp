@@ -0,0 +1,339 @@
+//---------------------------------------------------------------------
+// <copyright file="trace_stats.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/trace_stats.h"
+
+#include "correlation_vector/correlation_vector.h"
+#include "parallel.h"
+#include "simd.h"
+#include "utilities.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace microsoft
+{
+constexpr const uint32_t trace_stats::SPIN_THRESHOLD;
+
+trace_stats::trace_stats(size_t expectedBases)
+{
+    size_t capacity = 16;
+    while (capacity * 3 < expectedBases * 4)
+    {
+        capacity *= 2;
+    }
+
+    _allocate(capacity);
+}
+
+trace_stats::trace_stats(trace_stats&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+trace_stats& trace_stats::operator=(trace_stats&& other) noexcept
+{
+    // The other aggregator is left empty, with no table until it grows one.
+    m_storage = std::move(other.m_storage);
+    m_entries = other.m_entries;
+    m_capacity = other.m_capacity;
+    m_size = other.m_size;
+    m_records = other.m_records;
+    m_rejected = other.m_rejected;
+    other.m_entries = nullptr;
+    other.m_capacity = 0;
+    other.m_size = 0;
+    other.m_records = 0;
+    other.m_rejected = 0;
+    return *this;
+}
+
+void trace_stats::_allocate(size_t capacity)
+{
+    static_assert(sizeof(entry) == 64, "An entry fills a cache line.");
+
+    // Room to align the first entry to a cache line.
+    m_storage.reset(new unsigned char[capacity * sizeof(entry) + 63]);
+    const uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.get());
+    m_entries = reinterpret_cast<entry*>(m_storage.get() +
+                                         (64 - address % 64) % 64);
+    m_capacity = capacity;
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        new (m_entries + i) entry{};
+    }
+}
+
+trace_stats::entry& trace_stats::_entry(uint64_t hash,
+                                        const char* base,
+                                        size_t length)
+{
+    // Growing before the lookup keeps a free entry to end the probe.
+    if ((m_size + 1) * 4 > m_capacity * 3)
+    {
+        _grow();
+    }
+
+    const size_t mask = m_capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        entry& candidate = m_entries[i];
+        if (candidate.base_length == 0)
+        {
+            candidate.hash = hash;
+            candidate.base_length = static_cast<uint8_t>(length);
+            std::memcpy(candidate.base, base, length);
+            ++m_size;
+            return candidate;
+        }
+
+        if (candidate.hash == hash && candidate.base_length == length &&
+            std::memcmp(candidate.base, base, length) == 0)
+        {
+            return candidate;
+        }
+    }
+}
+
+void trace_stats::_grow()
+{
+    const std::unique_ptr<unsigned char[]> storage{std::move(m_storage)};
+    const entry* const entries = m_entries;
+    const size_t capacity = m_capacity;
+    _allocate(std::max<size_t>(capacity * 2, 16));
+    const size_t mask = m_capacity - 1;
+    for (size_t j = 0; j < capacity; ++j)
+    {
+        const entry& e = entries[j];
+        if (e.base_length != 0)
+        {
+            size_t i = e.hash & mask;
+            while (m_entries[i].base_length != 0)
+            {
+                i = (i + 1) & mask;
+            }
+
+            m_entries[i] = e;
+        }
+    }
+}
+
+/* static */
+bool trace_stats::_parse(const char* correlationVector,
+                         size_t length,
+                         record& out) noexcept
+{
+    // Accepts exactly what correlation_vector::validate accepts, but checks
+    // and measures the vector in the same pass over its characters.
+    if (length == 0 || length > correlation_vector::MAX_VALUE_LENGTH)
+    {
+        return false;
+    }
+
+    out.is_terminated =
+        correlationVector[length - 1] == correlation_vector::TERMINATOR;
+    const char* const end =
+        correlationVector + length - (out.is_terminated ? 1 : 0);
+    const char* c = correlationVector;
+    while (c != end && utilities::base64_value(*c) >= 0)
+    {
+        ++c;
+    }
+
+    // The length of the base gives the version.
+    const size_t baseLength = static_cast<size_t>(c - correlationVector);
+    if (c == end || *c != '.' ||
+        (baseLength != correlation_vector::BASE_LENGTH_V1 &&
+         baseLength != correlation_vector::BASE_LENGTH_V2) ||
+        static_cast<size_t>(end - correlationVector) >
+            correlation_vector::_max_length(
+                baseLength == correlation_vector::BASE_LENGTH_V2
+                    ? correlation_vector_version::v2
+                    : correlation_vector_version::v1))
+    {
+        return false;
+    }
+
+    // Each segment is a decimal number: spin values are unsigned 32-bit
+    // values and the last one is an int extension.
+    uint32_t depth = 0;
+    uint32_t spins = 0;
+    uint64_t value = 0;
+    bool isSpin = false;
+    while (c != end)
+    {
+        const char* const first = ++c;
+        value = 0;
+        for (; c != end && *c != '.'; ++c)
+        {
+            const unsigned int digit = static_cast<unsigned char>(*c) - '0';
+            if (digit > 9)
+            {
+                return false;
+            }
+
+            value = std::min<uint64_t>(value * 10 + digit,
+                                       static_cast<uint64_t>(UINT_MAX) + 1);
+        }
+
+        if (c == first ||
+            value > (c == end ? static_cast<uint64_t>(INT_MAX) : UINT_MAX))
+        {
+            return false;
+        }
+
+        ++depth;
+        if (c != end)
+        {
+            const bool isSpinSegment = value >= SPIN_THRESHOLD;
+            spins += isSpinSegment && !isSpin ? 1 : 0;
+            isSpin = isSpinSegment;
+        }
+    }
+
+    out.base = correlationVector;
+    out.base_length = baseLength;
+    out.hash = utilities::hash_base(correlationVector, baseLength);
+    out.depth = depth;
+    out.fan_out = static_cast<uint32_t>(value);
+    out.spins = spins;
+    return true;
+}
+
+void trace_stats::_add(const record& r)
+{
+    entry& e = _entry(r.hash, r.base, r.base_length);
+    ++e.records;
+    e.terminated += r.is_terminated ? 1 : 0;
+#pragma push_macro("max")
+#undef max
+    e.max_depth = std::max(e.max_depth, r.depth);
+    e.max_fan_out = std::max(e.max_fan_out, r.fan_out);
+    e.max_spins = std::max(e.max_spins, r.spins);
+#pragma pop_macro("max")
+    ++m_records;
+}
+
+bool trace_stats::add(const char* correlationVector, size_t length)
+{
+    record r;
+    if (!_parse(correlationVector, length, r))
+    {
+        ++m_rejected;
+        return false;
+    }
+
+    _add(r);
+    return true;
+}
+
+void trace_stats::add(const std::string* values, size_t count)
+{
+    // Records are parsed LOOKAHEAD values ahead of being added, and the
+    // first entry each one probes is prefetched in between.
+    constexpr const size_t LOOKAHEAD = 8;
+    record pending[LOOKAHEAD];
+    bool isValid[LOOKAHEAD];
+    for (size_t i = 0; i < count + LOOKAHEAD; ++i)
+    {
+        const size_t slot = i % LOOKAHEAD;
+        if (i >= LOOKAHEAD && isValid[slot])
+        {
+            _add(pending[slot]);
+        }
+
+        if (i < count)
+        {
+            isValid[slot] =
+                _parse(values[i].data(), values[i].size(), pending[slot]);
+            if (isValid[slot] && m_capacity != 0)
+            {
+                utilities::prefetch(
+                    &m_entries[pending[slot].hash & (m_capacity - 1)]);
+            }
+            else
+            {
+                ++m_rejected;
+            }
+        }
+    }
+}
+
+void trace_stats::merge(const trace_stats& other)
+{
+    for (size_t i = 0; i < other.m_capacity; ++i)
+    {
+        const entry& o = other.m_entries[i];
+        if (o.base_length != 0)
+        {
+            entry& e = _entry(o.hash, o.base, o.base_length);
+            e.records += o.records;
+            e.terminated += o.terminated;
+#pragma push_macro("max")
+#undef max
+            e.max_depth = std::max(e.max_depth, o.max_depth);
+            e.max_fan_out = std::max(e.max_fan_out, o.max_fan_out);
+            e.max_spins = std::max(e.max_spins, o.max_spins);
+#pragma pop_macro("max")
+        }
+    }
+
+    m_records += other.m_records;
+    m_rejected += other.m_rejected;
+}
+
+std::vector<trace_summary> trace_stats::summaries() const
+{
+    std::vector<trace_summary> summaries;
+    summaries.reserve(m_size);
+    for (size_t i = 0; i < m_capacity; ++i)
+    {
+        const entry& e = m_entries[i];
+        if (e.base_length != 0)
+        {
+            summaries.push_back({std::string(e.base, e.base_length),
+                                 e.records,
+                                 e.terminated,
+                                 e.max_depth,
+                                 e.max_fan_out,
+                                 e.max_spins});
+        }
+    }
+
+    std::sort(summaries.begin(),
+              summaries.end(),
+              [](const trace_summary& a, const trace_summary& b) {
+                  return a.base < b.base;
+              });
+    return summaries;
+}
+
+/* static */
+trace_stats trace_stats::aggregate(const std::string* values,
+                                   size_t count,
+                                   unsigned int threadCount)
+{
+    // A few shards per thread balance uneven values.
+    const size_t shardCount = std::max<size_t>(
+        std::min<size_t>(utilities::resolve_thread_count(threadCount) * 4,
+                         count / 4096),
+        1);
+    std::vector<trace_stats> shards(shardCount);
+    utilities::parallel_for(shardCount, threadCount, [&](size_t s) {
+        const size_t first = count * s / shardCount;
+        const size_t last = count * (s + 1) / shardCount;
+        shards[s].add(values + first, last - first);
+    });
+
+    for (size_t s = 1; s < shardCount; ++s)
+    {
+        shards[0].merge(shards[s]);
+    }
+
+    return std::move(shards[0]);
+}
+} // namespace microsoft
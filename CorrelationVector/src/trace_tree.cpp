@@ -0,0 +1,406 @@
+//---------------------------------------------------------------------
+// <copyright file="trace_tree.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "correlation_vector/trace_tree.h"
+
+#include "correlation_vector/causal_order.h"
+#include "correlation_vector/correlation_vector.h"
+#include "parallel.h"
+#include "utilities.h"
+#include <algorithm>
+#include <utility>
+
+namespace microsoft
+{
+namespace
+{
+// Walks the extension segments of a Correlation Vector. Returns false once
+// there are no more segments, or if a segment is not a number.
+class segment_reader
+{
+private:
+    const std::string& m_value;
+    size_t m_position;
+
+public:
+    segment_reader(const std::string& value, size_t baseLength)
+        : m_value{value}, m_position{baseLength}
+    {
+    }
+
+    bool next(uint32_t& segment, bool& valid)
+    {
+        valid = true;
+        if (m_position >= m_value.size() || m_value[m_position] != '.')
+        {
+            return false;
+        }
+
+        ++m_position;
+        uint64_t result = 0;
+        size_t start = m_position;
+        while (m_position < m_value.size() && m_value[m_position] >= '0' &&
+               m_value[m_position] <= '9' && result <= 0xFFFFFFFF)
+        {
+            result = result * 10 + (m_value[m_position++] - '0');
+        }
+
+        valid = m_position > start && result <= 0xFFFFFFFF;
+        segment = static_cast<uint32_t>(result);
+        return valid;
+    }
+
+    bool at_end() const
+    {
+        return m_position == m_value.size() ||
+               (m_position + 1 == m_value.size() &&
+                m_value[m_position] == correlation_vector::TERMINATOR);
+    }
+};
+
+bool is_valid(const std::string& correlationVector)
+{
+    if (correlation_vector::validate(correlationVector.data(),
+                                     correlationVector.size()) !=
+        validation_result::valid)
+    {
+        return false;
+    }
+
+    // Segments with leading zeros are rejected: "b.01.2" would share the
+    // node of "b.1.2", and parse() turns a last extension with leading zeros
+    // into a brand new vector. Only canonical values are accepted.
+    for (size_t i = correlationVector.find('.'); i != std::string::npos;
+         i = correlationVector.find('.', i + 1))
+    {
+        if (correlationVector[i + 1] == '0' &&
+            i + 2 < correlationVector.size() &&
+            correlationVector[i + 2] >= '0' && correlationVector[i + 2] <= '9')
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+trace_tree::trace_tree(std::string base) : m_base{std::move(base)}
+{
+    m_nodes.push_back({0, NPOS, 1, 0, 0});
+}
+
+void trace_tree::_close(std::vector<uint32_t>& path, size_t depth)
+{
+    while (path.size() > depth)
+    {
+        uint32_t index = path.back();
+        m_nodes[index].subtree_size =
+            static_cast<uint32_t>(m_nodes.size() - index);
+        path.pop_back();
+    }
+}
+
+void trace_tree::_append(const std::string& correlationVector,
+                         std::vector<uint32_t>& path)
+{
+    segment_reader reader{correlationVector, m_base.length()};
+    uint32_t segment;
+    bool valid;
+    size_t depth = 1;
+    bool matching = true;
+    while (reader.next(segment, valid))
+    {
+        if (matching && depth < path.size() &&
+            m_nodes[path[depth]].extension == segment)
+        {
+            ++depth;
+            continue;
+        }
+
+        if (matching)
+        {
+            _close(path, depth);
+            matching = false;
+        }
+
+        m_nodes.push_back({segment, path.back(), 1, 0, 0});
+        path.push_back(static_cast<uint32_t>(m_nodes.size() - 1));
+        ++depth;
+    }
+
+    node& last = m_nodes[path[depth - 1]];
+    if (!last.observed)
+    {
+        last.observed = 1;
+        ++m_observed;
+    }
+
+    if (correlationVector.back() == correlation_vector::TERMINATOR)
+    {
+        last.terminated = 1;
+    }
+}
+
+uint32_t trace_tree::_find(const std::string& correlationVector) const
+{
+    if (correlationVector.compare(0, m_base.length(), m_base) != 0 ||
+        utilities::base_length(correlationVector.data(),
+                               correlationVector.size()) != m_base.length())
+    {
+        return NPOS;
+    }
+
+    segment_reader reader{correlationVector, m_base.length()};
+    uint32_t segment;
+    bool valid;
+    uint32_t index = 0;
+    while (reader.next(segment, valid))
+    {
+        uint32_t end = index + m_nodes[index].subtree_size;
+        uint32_t child = index + 1;
+        while (child < end && m_nodes[child].extension != segment)
+        {
+            child += m_nodes[child].subtree_size;
+        }
+
+        if (child >= end)
+        {
+            return NPOS;
+        }
+
+        index = child;
+    }
+
+    return valid && reader.at_end() ? index : NPOS;
+}
+
+uint32_t trace_tree::_observed_parent(uint32_t index) const
+{
+    do
+    {
+        index = m_nodes[index].parent;
+    } while (index != NPOS && !m_nodes[index].observed);
+
+    return index;
+}
+
+std::string trace_tree::_value(uint32_t index) const
+{
+    std::vector<uint32_t> segments;
+    bool terminated = m_nodes[index].terminated != 0;
+    for (; index != 0; index = m_nodes[index].parent)
+    {
+        segments.push_back(m_nodes[index].extension);
+    }
+
+    std::string value{m_base};
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it)
+    {
+        value += '.';
+        value += std::to_string(*it);
+    }
+
+    if (terminated)
+    {
+        value += correlation_vector::TERMINATOR;
+    }
+
+    return value;
+}
+
+void trace_tree::_collect(uint32_t index,
+                          bool recursive,
+                          std::vector<std::string>& out) const
+{
+    uint32_t end = index + m_nodes[index].subtree_size;
+    for (uint32_t child = index + 1; child < end;
+         child += m_nodes[child].subtree_size)
+    {
+        if (m_nodes[child].observed)
+        {
+            out.push_back(_value(child));
+        }
+
+        if (recursive || !m_nodes[child].observed)
+        {
+            _collect(child, recursive, out);
+        }
+    }
+}
+
+bool trace_tree::contains(const std::string& correlationVector) const
+{
+    uint32_t index = _find(correlationVector);
+    return index != NPOS && m_nodes[index].observed;
+}
+
+bool trace_tree::is_terminated(const std::string& correlationVector) const
+{
+    uint32_t index = _find(correlationVector);
+    return index != NPOS && m_nodes[index].terminated;
+}
+
+std::string trace_tree::parent(const std::string& correlationVector) const
+{
+    uint32_t index = _find(correlationVector);
+    if (index == NPOS || index == 0)
+    {
+        return {};
+    }
+
+    uint32_t parent = _observed_parent(index);
+    return parent == NPOS ? std::string{} : _value(parent);
+}
+
+std::vector<std::string> trace_tree::children(
+    const std::string& correlationVector) const
+{
+    std::vector<std::string> result;
+    uint32_t index = _find(correlationVector);
+    if (index != NPOS)
+    {
+        _collect(index, false, result);
+    }
+
+    return result;
+}
+
+std::vector<std::string> trace_tree::descendants(
+    const std::string& correlationVector) const
+{
+    std::vector<std::string> result;
+    uint32_t index = _find(correlationVector);
+    if (index != NPOS)
+    {
+        _collect(index, true, result);
+    }
+
+    return result;
+}
+
+const trace_tree* trace_forest::find(const std::string& correlationVector) const
+{
+    std::string base{correlationVector.substr(
+        0,
+        utilities::base_length(correlationVector.data(),
+                               correlationVector.size()))};
+    auto it = std::lower_bound(
+        m_trees.begin(),
+        m_trees.end(),
+        base,
+        [](const trace_tree& tree, const std::string& b) {
+            return tree.base() < b;
+        });
+
+    return it != m_trees.end() && it->base() == base ? &*it : nullptr;
+}
+
+std::vector<std::string> trace_forest::children(
+    const std::string& correlationVector) const
+{
+    const trace_tree* tree = find(correlationVector);
+    return tree ? tree->children(correlationVector)
+                : std::vector<std::string>{};
+}
+
+std::vector<std::string> trace_forest::descendants(
+    const std::string& correlationVector) const
+{
+    const trace_tree* tree = find(correlationVector);
+    return tree ? tree->descendants(correlationVector)
+                : std::vector<std::string>{};
+}
+
+trace_forest trace_forest_builder::build(unsigned int threadCount)
+{
+    std::vector<std::string> vectors;
+    vectors.swap(m_vectors);
+
+    // Spread bases over more shards than threads so that a few large traces
+    // do not leave the other threads idle.
+    threadCount = utilities::resolve_thread_count(threadCount);
+    const size_t shardCount = threadCount == 1 ? 1 : threadCount * 4;
+
+    typedef std::pair<uint64_t, uint32_t> entry;
+    std::vector<std::vector<entry>> shards(shardCount);
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        const std::string& v = vectors[i];
+        uint64_t hash = utilities::fnv1a_64(
+            v.data(), utilities::base_length(v.data(), v.size()));
+        shards[hash % shardCount].push_back(
+            entry{hash, static_cast<uint32_t>(i)});
+    }
+
+    std::vector<std::vector<trace_tree>> shardTrees(shardCount);
+    std::vector<size_t> shardRejected(shardCount, 0);
+    utilities::parallel_for(shardCount, threadCount, [&](size_t s) {
+        std::vector<entry>& entries = shards[s];
+        auto invalid = std::partition(
+            entries.begin(), entries.end(), [&vectors](const entry& e) {
+                return is_valid(vectors[e.second]);
+            });
+        shardRejected[s] = static_cast<size_t>(entries.end() - invalid);
+        entries.erase(invalid, entries.end());
+
+        // Sorting by hash first keeps each base together cheaply; the causal
+        // order within a base is what lets the trie be built in one pass.
+        std::sort(entries.begin(),
+                  entries.end(),
+                  [&vectors](const entry& lhs, const entry& rhs) {
+                      return lhs.first != rhs.first
+                                 ? lhs.first < rhs.first
+                                 : causal_compare(vectors[lhs.second],
+                                                  vectors[rhs.second]) < 0;
+                  });
+
+        std::vector<uint32_t> path;
+        std::vector<trace_tree>& trees = shardTrees[s];
+        for (const entry& e : entries)
+        {
+            const std::string& v = vectors[e.second];
+            const size_t baseLength =
+                utilities::base_length(v.data(), v.size());
+            if (trees.empty() ||
+                trees.back().m_base.compare(0, std::string::npos, v, 0,
+                                            baseLength) != 0)
+            {
+                if (!trees.empty())
+                {
+                    trees.back()._close(path, 0);
+                }
+
+                trees.push_back(trace_tree{v.substr(0, baseLength)});
+                path.assign(1, 0);
+            }
+
+            trees.back()._append(v, path);
+        }
+
+        if (!trees.empty())
+        {
+            trees.back()._close(path, 0);
+        }
+    });
+
+    trace_forest forest;
+    for (size_t s = 0; s < shardCount; ++s)
+    {
+        forest.m_rejected += shardRejected[s];
+        for (trace_tree& tree : shardTrees[s])
+        {
+            forest.m_trees.push_back(std::move(tree));
+        }
+    }
+
+    std::sort(forest.m_trees.begin(),
+              forest.m_trees.end(),
+              [](const trace_tree& lhs, const trace_tree& rhs) {
+                  return lhs.base() < rhs.base();
+              });
+    return forest;
+}
+} // namespace microsoft
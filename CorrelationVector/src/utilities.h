@@ -4,6 +4,8 @@
 // </copyright>
 //---------------------------------------------------------------------
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -44,5 +46,106 @@ inline bool contains_whitespace(const std::string& s)
 {
     return s.find_first_of("\t\n ") != std::string::npos;
 }
+
+// The value of each byte in the base64 alphabet, or -1.
+constexpr const signed char base64_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+
+inline int base64_value(char c)
+{
+    return base64_values[static_cast<unsigned char>(c)];
+}
+
+/**
+Decodes unpadded base64 text into raw bytes. Fails if a character is outside
+the base64 alphabet or if the unused trailing bits are not zero, i.e. when
+encoding the bytes again would not give back the same text.
+@return true if the text was decoded into length * 6 / 8 bytes.
+*/
+inline bool base64_decode(const char* data, size_t length, unsigned char* out)
+{
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        int value = base64_value(data[i]);
+        if (value < 0)
+        {
+            return false;
+        }
+
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            *out++ = static_cast<unsigned char>(accumulator >> bits);
+        }
+    }
+
+    return (accumulator & ((1u << bits) - 1)) == 0;
+}
+
+/**
+Gets the length of the base of a Correlation Vector, i.e. the number of
+characters before the first '.'.
+*/
+inline size_t base_length(const char* data, size_t length)
+{
+    size_t i = 0;
+    while (i < length && data[i] != '.') ++i;
+    return i;
+}
+
+/**
+64-bit FNV-1a hash.
+*/
+inline uint64_t fnv1a_64(const char* data, size_t length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+Finishes a hash with the MurmurHash3 mixer, so that both its top and its low
+bits are well distributed.
+*/
+inline uint64_t mix64(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+The hash of a base for hash tables keyed by base: FNV-1a finished with
+mix64.
+*/
+inline uint64_t hash_base(const char* base, size_t length)
+{
+    return mix64(fnv1a_64(base, length));
+}
 } // namespace utilities
 } // namespace microsoft
\ No newline at end of file
@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------
+// <copyright file="AllocationTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#define CATCH_CONFIG_MAIN
+
+#include "allocation_counter.h"
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_view.h"
+#include "correlation_vector/guid.h"
+#include "correlation_vector/spin_parameters.h"
+#include <new>
+#include <string>
+#include <utility>
+
+// The allocation budget of each operation on the hot path. A budget is an
+// upper bound: standard libraries with a longer small string buffer allocate
+// less. Each operation runs once before it is counted, so that one-time
+// initialization, e.g. of per-thread state, is not counted.
+
+using microsoft::tests::count_allocations;
+
+namespace
+{
+const std::string V2_VALUE{"KZY+dsX2jEaZesgCPjJ2Ng.1.2"};
+const std::string V1_VALUE{"tul4NUsfs9Cl7mOf.1.2"};
+} // namespace
+
+TEST_CASE("Allocations_Counted")
+{
+    std::string* value = nullptr;
+    REQUIRE(count_allocations([&]() { value = new std::string{}; }) == 1);
+    delete value;
+    char* values = nullptr;
+    REQUIRE(count_allocations([&]() { values = new char[16]; }) == 1);
+    delete[] values;
+    REQUIRE(count_allocations([&]() { value = new (std::nothrow) std::string{}; }) == 1);
+    delete value;
+    REQUIRE(count_allocations([&]() { values = new (std::nothrow) char[16]; }) == 1);
+    delete[] values;
+    REQUIRE(count_allocations([]() {}) == 0);
+}
+
+TEST_CASE("Allocations_ExtendParseSpin")
+{
+    for (const std::string& value : {V2_VALUE, V1_VALUE})
+    {
+        microsoft::correlation_vector::extend(value);
+        REQUIRE(count_allocations([&]() { microsoft::correlation_vector::extend(value); }) <= 1);
+
+        microsoft::correlation_vector::parse(value);
+        REQUIRE(count_allocations([&]() { microsoft::correlation_vector::parse(value); }) <= 2);
+
+        microsoft::correlation_vector::spin(value);
+        REQUIRE(count_allocations([&]() { microsoft::correlation_vector::spin(value); }) <= 2);
+    }
+
+    // Spinning into reused children does not allocate once they hold values
+    // as long as the new ones.
+    microsoft::correlation_vector children[8];
+    microsoft::correlation_vector::spin_many(V2_VALUE, {}, 8, children);
+    REQUIRE(count_allocations([&]() { microsoft::correlation_vector::spin_many(V2_VALUE, {}, 8, children); }) == 0);
+}
+
+TEST_CASE("Allocations_IncrementAndValue")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse(V2_VALUE)};
+    cv.increment();
+    REQUIRE(count_allocations([&]() { cv.increment(); }) <= 1);
+    REQUIRE(count_allocations([&]() { cv.value(); }) <= 1);
+
+    // The buffer forms never allocate.
+    char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+    REQUIRE(count_allocations([&]() { cv.increment_into(buffer, sizeof(buffer)); }) == 0);
+    REQUIRE(count_allocations([&]() { cv.copy_value(buffer, sizeof(buffer)); }) == 0);
+    REQUIRE(count_allocations([&]() { cv.view(); }) == 0);
+    REQUIRE(count_allocations([&]() { microsoft::correlation_vector::validate(V2_VALUE.data(), V2_VALUE.size()); }) == 0);
+}
+
+TEST_CASE("Allocations_CopyAndMove")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse(V2_VALUE)};
+    REQUIRE(count_allocations([&]() { microsoft::correlation_vector copy{cv}; }) <= 1);
+    REQUIRE(count_allocations([&]() { microsoft::correlation_vector moved{std::move(cv)}; cv = std::move(moved); }) == 0);
+
+    // Assigning over a vector with room for the value reuses its storage.
+    microsoft::correlation_vector target{microsoft::correlation_vector::parse(V2_VALUE)};
+    REQUIRE(count_allocations([&]() { target = cv; }) == 0);
+
+    const microsoft::guid guid{microsoft::guid::create()};
+    REQUIRE(count_allocations([&]() { microsoft::guid::create(); }) == 0);
+    REQUIRE(count_allocations([&]() {
+                microsoft::guid copy{guid};
+                microsoft::guid moved{std::move(copy)};
+                copy = moved;
+            }) == 0);
+    REQUIRE(count_allocations([&]() { guid.to_base64_string(); }) <= 1);
+    REQUIRE(count_allocations([&]() { microsoft::correlation_vector{guid}; }) <= 2);
+}
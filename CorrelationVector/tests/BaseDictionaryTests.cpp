@@ -0,0 +1,173 @@
+//---------------------------------------------------------------------
+// <copyright file="BaseDictionaryTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/base_dictionary.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/guid.h"
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("BaseDictionary_InternsBases")
+{
+    microsoft::base_dictionary dictionary{16};
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    const std::string value{cv.increment()};
+    const std::string base{value.substr(0, 22)};
+
+    REQUIRE(dictionary.find(value) == microsoft::base_dictionary::NO_ID);
+    const uint32_t id = dictionary.intern(cv);
+    REQUIRE(id < dictionary.capacity());
+    REQUIRE(dictionary.intern(value) == id);
+    REQUIRE(dictionary.intern(base) == id);
+    REQUIRE(dictionary.intern(microsoft::correlation_vector::extend(value)) == id);
+    REQUIRE(dictionary.find(base + ".5.1") == id);
+    REQUIRE(dictionary.resolve(id) == base);
+
+    microsoft::correlation_vector v1{microsoft::correlation_vector_version::v1};
+    const uint32_t v1Id = dictionary.intern(v1);
+    REQUIRE(v1Id != id);
+    REQUIRE(dictionary.resolve(v1Id) == v1.value().substr(0, 16));
+    REQUIRE(dictionary.size() == 2);
+
+    REQUIRE(dictionary.intern(std::string{}) == microsoft::base_dictionary::NO_ID);
+    REQUIRE(dictionary.intern(std::string(23, 'A')) == microsoft::base_dictionary::NO_ID);
+    REQUIRE(dictionary.resolve(15).empty());
+    REQUIRE(dictionary.resolve(16).empty());
+
+    for (size_t i = 2; i < 16; ++i)
+    {
+        REQUIRE(dictionary.intern(microsoft::guid::create().to_base64_string()) != microsoft::base_dictionary::NO_ID);
+    }
+
+    REQUIRE(dictionary.intern(microsoft::guid::create().to_base64_string()) == microsoft::base_dictionary::NO_ID);
+    REQUIRE(dictionary.intern(base) == id);
+    REQUIRE_THROWS_AS(microsoft::base_dictionary(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::base_dictionary(16, 0), std::invalid_argument);
+}
+
+TEST_CASE("BaseDictionary_EvictsByEpoch")
+{
+    microsoft::base_dictionary dictionary{64, 1};
+    std::vector<std::string> bases;
+    for (size_t i = 0; i < 40; ++i)
+    {
+        bases.push_back(microsoft::guid::create().to_base64_string());
+        REQUIRE(dictionary.intern(bases.back()) == i);
+    }
+
+    // Bases used in the epoch that ends or the one before are kept.
+    REQUIRE(dictionary.advance_epoch() == 0);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        REQUIRE(dictionary.find(bases[i]) == i);
+    }
+
+    REQUIRE(dictionary.advance_epoch() == 20);
+    REQUIRE(dictionary.epoch() == 2);
+    REQUIRE(dictionary.size() == 20);
+    for (size_t i = 0; i < 40; ++i)
+    {
+        const uint32_t expected = i < 20 ? static_cast<uint32_t>(i) : microsoft::base_dictionary::NO_ID;
+        REQUIRE(dictionary.find(bases[i]) == expected);
+        REQUIRE(dictionary.resolve(static_cast<uint32_t>(i)) == (i < 20 ? bases[i] : std::string{}));
+    }
+
+    // Evicted ids are reused, and the remaining bases are still found.
+    std::set<uint32_t> ids;
+    for (size_t i = 0; i < 44; ++i)
+    {
+        const uint32_t id = dictionary.intern(microsoft::guid::create().to_base64_string());
+        REQUIRE(id != microsoft::base_dictionary::NO_ID);
+        REQUIRE(id >= 20);
+        ids.insert(id);
+    }
+
+    REQUIRE(ids.size() == 44);
+    for (size_t i = 0; i < 20; ++i)
+    {
+        REQUIRE(dictionary.find(bases[i]) == i);
+    }
+
+    std::ostringstream dump;
+    dictionary.dump(dump);
+    std::istringstream lines{dump.str()};
+    std::string word;
+    uint64_t epoch = 0;
+    REQUIRE(lines >> word >> epoch);
+    REQUIRE(word == "epoch");
+    REQUIRE(epoch == 2);
+    size_t count = 0;
+    uint32_t id = 0;
+    while (lines >> id >> word)
+    {
+        REQUIRE(dictionary.resolve(id) == word);
+        ++count;
+    }
+
+    REQUIRE(count == 64);
+}
+
+TEST_CASE("BaseDictionary_InternsConcurrently")
+{
+    const size_t threadCount = 4;
+    const size_t baseCount = 1000;
+    std::vector<std::string> bases;
+    for (size_t i = 0; i < baseCount; ++i)
+    {
+        bases.push_back(microsoft::guid::create().to_base64_string());
+    }
+
+    const std::set<std::string> known{bases.begin(), bases.end()};
+    microsoft::base_dictionary dictionary{baseCount};
+    std::atomic<size_t> torn{0};
+    std::atomic<bool> stop{false};
+    std::thread epochs{[&]() {
+        while (!stop)
+        {
+            dictionary.advance_epoch();
+            std::this_thread::yield();
+        }
+    }};
+
+    // Bases are evicted while they are looked up, so an id may already
+    // belong to another base when it is resolved, but never to a torn one.
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (size_t round = 0; round < 10; ++round)
+            {
+                for (size_t i = 0; i < baseCount; ++i)
+                {
+                    const std::string& base = bases[(i * (t + 1) + round) % baseCount];
+                    const std::string resolved = dictionary.resolve(dictionary.intern(base));
+                    torn += resolved.empty() || known.count(resolved) != 0 ? 0 : 1;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    stop = true;
+    epochs.join();
+    REQUIRE(torn == 0);
+    for (const std::string& base : bases)
+    {
+        const uint32_t id = dictionary.intern(base);
+        REQUIRE(id != microsoft::base_dictionary::NO_ID);
+        REQUIRE(dictionary.resolve(id) == base);
+        REQUIRE(dictionary.find(base) == id);
+    }
+}
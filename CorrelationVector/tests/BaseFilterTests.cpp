@@ -0,0 +1,115 @@
+//---------------------------------------------------------------------
+// <copyright file="BaseFilterTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/base_filter.h"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/guid.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("BaseFilter_FindsInsertedBases")
+{
+    microsoft::base_filter filter{1000, 0.01};
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    const std::string value{cv.increment()};
+    const std::string base{value.substr(0, 22)};
+
+    REQUIRE_FALSE(filter.contains(value));
+    REQUIRE(filter.insert(value));
+    REQUIRE_FALSE(filter.insert(value));
+
+    // Only the base is used, so every hop of the trace matches.
+    REQUIRE(filter.contains(base));
+    REQUIRE(filter.contains(microsoft::correlation_vector::extend(value).increment()));
+    REQUIRE_FALSE(filter.insert(base + ".7.1"));
+
+    const microsoft::guid guid{microsoft::guid::create()};
+    REQUIRE(filter.insert(guid));
+    REQUIRE(filter.contains(microsoft::correlation_vector{guid}.value()));
+    REQUIRE(filter.contains(guid));
+
+    filter.clear();
+    REQUIRE_FALSE(filter.contains(base));
+    REQUIRE_FALSE(filter.contains(guid));
+    REQUIRE_THROWS_AS(microsoft::base_filter(10, 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::base_filter(10, 1), std::invalid_argument);
+}
+
+TEST_CASE("BaseFilter_KeepsFalsePositiveRate")
+{
+    const size_t count = 20000;
+    for (const double rate : {0.05, 0.01, 0.001})
+    {
+        microsoft::base_filter filter{count, rate};
+        for (size_t i = 0; i < count; ++i)
+        {
+            filter.insert(microsoft::guid::create().to_base64_string());
+        }
+
+        size_t falsePositives = 0;
+        const size_t queries = 100000;
+        for (size_t i = 0; i < queries; ++i)
+        {
+            falsePositives += filter.contains(microsoft::guid::create().to_base64_string()) ? 1 : 0;
+        }
+
+        REQUIRE(static_cast<double>(falsePositives) / queries < rate * 1.5);
+    }
+
+    // Halving the rate costs about 1.44 bits per base.
+    microsoft::base_filter small{1000000, 0.02};
+    microsoft::base_filter large{1000000, 0.01};
+    REQUIRE(large.memory_size() - small.memory_size() > 1000000 * 1.25 / 8);
+    REQUIRE(large.memory_size() - small.memory_size() < 1000000 * 2.0 / 8);
+}
+
+TEST_CASE("BaseFilter_InsertsConcurrently")
+{
+    const size_t threadCount = 4;
+    const size_t perThread = 5000;
+    std::vector<std::vector<std::string>> bases(threadCount);
+    for (std::vector<std::string>& thread : bases)
+    {
+        for (size_t i = 0; i < perThread; ++i)
+        {
+            thread.push_back(microsoft::guid::create().to_base64_string(12));
+        }
+    }
+
+    microsoft::base_filter filter{threadCount * perThread, 0.001};
+    std::atomic<size_t> inserted{0};
+    std::atomic<size_t> missing{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (const std::string& base : bases[t])
+            {
+                inserted += filter.insert(base) ? 1 : 0;
+                missing += filter.contains(base) ? 0 : 1;
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // A few bases may collide with earlier ones, but none is lost.
+    REQUIRE(missing == 0);
+    REQUIRE(inserted > threadCount * perThread * 99 / 100);
+    for (const std::vector<std::string>& thread : bases)
+    {
+        for (const std::string& base : thread)
+        {
+            REQUIRE(filter.contains(base));
+        }
+    }
+}
@@ -0,0 +1,73 @@
+//---------------------------------------------------------------------
+// <copyright file="BulkValidationTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/bulk_validation.h"
+#include "correlation_vector/correlation_vector.h"
+#include <string>
+
+TEST_CASE("BulkValidation_ReportsEveryLine")
+{
+    const std::string buffer{"KZY+dsX2jEaZesgCPjJ2Ng.1.2\n"
+                             "tul4NUsfs9Cl7mOf.1!\r\n"
+                             "\n"
+                             "tul4NUsfs9Cl7mOf. 1\n"
+                             "tul4NUsfs9Cl7mO.1\n"
+                             "tul4NUsfs9Cl7mOf.x\n"
+                             "tul4NUsfs9Cl7mOf.1.2.3.4.5.6.7.8.9.10.11.12.13.14.15.16.17.18.19.20.21.22.23\n"
+                             "tul4NUsfs9Cl7mOf.9"};
+    const microsoft::bulk_result result{microsoft::bulk_validation::validate(buffer.data(), buffer.size(), 2)};
+    REQUIRE(result.records.size() == 8);
+
+    const microsoft::bulk_record& first = result.records[0];
+    REQUIRE(first.status == microsoft::validation_result::valid);
+    REQUIRE(buffer.substr(first.offset, first.length) == "KZY+dsX2jEaZesgCPjJ2Ng.1.2");
+    REQUIRE(first.base_length == 22);
+    REQUIRE(buffer.substr(first.offset, first.base_vector_length) == "KZY+dsX2jEaZesgCPjJ2Ng.1");
+    REQUIRE_FALSE(first.is_immutable);
+
+    const microsoft::bulk_record& terminated = result.records[1];
+    REQUIRE(terminated.status == microsoft::validation_result::valid);
+    REQUIRE(buffer.substr(terminated.offset, terminated.length) == "tul4NUsfs9Cl7mOf.1!");
+    REQUIRE(terminated.base_vector_length == 16);
+    REQUIRE(terminated.is_immutable);
+
+    REQUIRE(result.records[2].status == microsoft::validation_result::empty);
+    REQUIRE(result.records[3].status == microsoft::validation_result::whitespace);
+    REQUIRE(result.records[4].status == microsoft::validation_result::invalid_base);
+    REQUIRE(result.records[5].status == microsoft::validation_result::invalid_extension);
+    REQUIRE(result.records[6].status == microsoft::validation_result::too_long);
+    REQUIRE(buffer.substr(result.records[7].offset, result.records[7].length) == "tul4NUsfs9Cl7mOf.9");
+
+    REQUIRE(result.count(microsoft::validation_result::valid) == 3);
+    REQUIRE(result.count(microsoft::validation_result::too_long) == 1);
+    REQUIRE(microsoft::bulk_validation::validate(buffer.data(), 0).records.empty());
+}
+
+TEST_CASE("BulkValidation_SplitsChunksAtLineBoundaries")
+{
+    // About 3 MB, so that chunk boundaries fall in the middle of lines.
+    std::string buffer;
+    std::vector<std::string> lines;
+    for (int i = 0; buffer.size() < (3 << 20); ++i)
+    {
+        lines.push_back(i % 5 == 0 ? "not a vector" : microsoft::correlation_vector{microsoft::correlation_vector_version::v2}.value() + "." + std::to_string(i));
+        buffer += lines.back() + "\n";
+    }
+
+    const microsoft::bulk_result parallel{microsoft::bulk_validation::validate(buffer.data(), buffer.size(), 4)};
+    const microsoft::bulk_result serial{microsoft::bulk_validation::validate(buffer.data(), buffer.size(), 1)};
+    REQUIRE(parallel.records.size() == lines.size());
+    REQUIRE(serial.records.size() == lines.size());
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const microsoft::bulk_record& record = parallel.records[i];
+        REQUIRE(buffer.compare(record.offset, record.length, lines[i]) == 0);
+        REQUIRE(record.status == microsoft::correlation_vector::validate(lines[i].data(), lines[i].size()));
+        REQUIRE(record.offset == serial.records[i].offset);
+    }
+
+    REQUIRE(parallel.count(microsoft::validation_result::whitespace) == (lines.size() + 4) / 5);
+}
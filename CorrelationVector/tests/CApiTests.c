@@ -0,0 +1,157 @@
+/*---------------------------------------------------------------------
+ * <copyright file="CApiTests.c" company="Microsoft">
+ *     Copyright (c) Microsoft Corporation.  All rights reserved.
+ * </copyright>
+ *---------------------------------------------------------------------*/
+#include "correlation_vector/correlation_vector_c.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+    do                                                                         \
+    {                                                                          \
+        if (!(condition))                                                      \
+        {                                                                      \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,   \
+                    #condition);                                               \
+            ++failures;                                                        \
+        }                                                                      \
+    } while (0)
+
+static int value_equals(const cv_handle* cv, const char* expected)
+{
+    char buffer[CV_MAX_VALUE_LENGTH];
+    size_t length = 0;
+    return cv_value(cv, buffer, sizeof(buffer), &length) == CV_OK &&
+           length == strlen(expected) &&
+           memcmp(buffer, expected, length) == 0;
+}
+
+static void create_and_increment(void)
+{
+    cv_handle cv;
+    char buffer[CV_MAX_VALUE_LENGTH];
+    size_t length = 0;
+
+    CHECK(cv_create(&cv, CV_VERSION_2) == CV_OK);
+    CHECK(cv_value(&cv, buffer, sizeof(buffer), &length) == CV_OK);
+    CHECK(length == 24);
+    CHECK(memcmp(buffer + 22, ".0", 2) == 0);
+    CHECK(cv_increment(&cv, buffer, sizeof(buffer), &length) == CV_OK);
+    CHECK(length == 24 && buffer[23] == '1');
+
+    CHECK(cv_create(&cv, CV_VERSION_1) == CV_OK);
+    CHECK(cv_value(&cv, buffer, sizeof(buffer), &length) == CV_OK);
+    CHECK(length == 18);
+    CHECK(cv_create(&cv, (cv_version)7) == CV_INVALID_ARGUMENT);
+    CHECK(cv_create(NULL, CV_VERSION_2) == CV_INVALID_ARGUMENT);
+}
+
+static void extend_and_parse(void)
+{
+    const char* parent = "tul4NUsfs9Cl7mOf.1";
+    cv_handle cv;
+    char small[8];
+    size_t length = 0;
+
+    CHECK(cv_extend(&cv, parent, strlen(parent)) == CV_OK);
+    CHECK(value_equals(&cv, "tul4NUsfs9Cl7mOf.1.0"));
+    CHECK(cv_increment(&cv, NULL, 0, &length) == CV_OK);
+    CHECK(length == 20);
+    CHECK(value_equals(&cv, "tul4NUsfs9Cl7mOf.1.1"));
+    CHECK(cv_value(&cv, small, sizeof(small), &length) == CV_BUFFER_TOO_SMALL);
+    CHECK(length == 20);
+
+    CHECK(cv_parse(&cv, "KZY+dsX2jEaZesgCPjJ2Ng.1.2", 26) == CV_OK);
+    CHECK(value_equals(&cv, "KZY+dsX2jEaZesgCPjJ2Ng.1.2"));
+    CHECK(!cv_is_immutable(&cv));
+
+    CHECK(cv_parse(&cv, "tul4NUsfs9Cl7mOf.1.2!", 21) == CV_OK);
+    CHECK(cv_is_immutable(&cv));
+    CHECK(cv_increment(&cv, NULL, 0, NULL) == CV_OK);
+    CHECK(value_equals(&cv, "tul4NUsfs9Cl7mOf.1.2!"));
+    CHECK(cv_extend(&cv, "tul4NUsfs9Cl7mOf.1.2!", 21) == CV_OK);
+    CHECK(value_equals(&cv, "tul4NUsfs9Cl7mOf.1.2!"));
+
+    CHECK(cv_extend(&cv, "", 0) == CV_EMPTY);
+    CHECK(cv_extend(&cv, "tul4NUsfs9Cl7mOf. 1", 19) == CV_WHITESPACE);
+    CHECK(cv_extend(&cv, "tul4NUsfs9Cl7mO.1", 17) == CV_INVALID_BASE);
+    CHECK(cv_extend(&cv, "tul4NUsfs9Cl7mOf.x", 18) == CV_INVALID_EXTENSION);
+    CHECK(cv_parse(&cv, "tul4NUsfs9Cl7mOf.01", 19) == CV_INVALID_EXTENSION);
+    CHECK(cv_extend(&cv, NULL, 3) == CV_INVALID_ARGUMENT);
+    CHECK(cv_extend(NULL, parent, strlen(parent)) == CV_INVALID_ARGUMENT);
+}
+
+static void terminates_when_oversized(void)
+{
+    /* 121 characters: the extension can reach 99999 and no further. */
+    const char* parent =
+        "KZY+dsX2jEaZesgCPjJ2Ng.2147483647.2147483647.2147483647.2147483647."
+        "2147483647.2147483647.2147483647.2147483647.2147483647";
+    char value[CV_MAX_VALUE_LENGTH];
+    cv_handle cv;
+    size_t length = strlen(parent);
+
+    memcpy(value, parent, length);
+    memcpy(value + length, ".99999", 6);
+    CHECK(cv_parse(&cv, value, length + 6) == CV_OK);
+    CHECK(cv_increment(&cv, value, sizeof(value), &length) == CV_OK);
+    CHECK(length == 128 && value[127] == '!');
+    CHECK(cv_is_immutable(&cv));
+
+    /* Extending a vector of 127 characters terminates it. */
+    memcpy(value, parent, strlen(parent));
+    memcpy(value + strlen(parent), ".99999", 6);
+    CHECK(cv_extend(&cv, value, 127) == CV_OK);
+    CHECK(cv_is_immutable(&cv));
+    CHECK(cv_spin(&cv, value, 127, NULL) == CV_OK);
+    CHECK(cv_is_immutable(&cv));
+}
+
+static void spins(void)
+{
+    const char* parent = "KZY+dsX2jEaZesgCPjJ2Ng.1";
+    cv_spin_parameters parameters = {16, 32, 4};
+    cv_spin_parameters invalid = {17, 32, 4};
+    char value[CV_MAX_VALUE_LENGTH];
+    size_t length = 0;
+    size_t dots = 0;
+    size_t i;
+    cv_handle cv;
+
+    CHECK(cv_spin(&cv, parent, strlen(parent), NULL) == CV_OK);
+    CHECK(cv_value(&cv, value, sizeof(value), &length) == CV_OK);
+    CHECK(memcmp(value, parent, strlen(parent)) == 0);
+    CHECK(memcmp(value + length - 2, ".0", 2) == 0);
+
+    CHECK(cv_spin(&cv, parent, strlen(parent), &parameters) == CV_OK);
+    CHECK(cv_value(&cv, value, sizeof(value), &length) == CV_OK);
+    for (i = 0; i < length; ++i)
+    {
+        dots += value[i] == '.' ? 1 : 0;
+    }
+
+    /* 64 bits of spin value are written as two segments. */
+    CHECK(dots == 4);
+    CHECK(cv_spin(&cv, parent, strlen(parent), &invalid) ==
+          CV_INVALID_ARGUMENT);
+}
+
+int main(void)
+{
+    create_and_increment();
+    extend_and_parse();
+    terminates_when_oversized();
+    spins();
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("All C interface checks passed\n");
+    return 0;
+}
@@ -0,0 +1,64 @@
+//---------------------------------------------------------------------
+// <copyright file="CausalOrderTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/causal_order.h"
+#include "correlation_vector/correlation_vector.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST_CASE("CausalCompare_NumericSegments")
+{
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.9", "tul4NUsfs9Cl7mOf.10") < 0);
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.1.10", "tul4NUsfs9Cl7mOf.1.9") > 0);
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.2.0", "tul4NUsfs9Cl7mOf.10") < 0);
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.3", "tul4NUsfs9Cl7mOf.3") == 0);
+}
+
+TEST_CASE("CausalCompare_PrefixPrecedesDescendants")
+{
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.1", "tul4NUsfs9Cl7mOf.1.0") < 0);
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.1.0", "tul4NUsfs9Cl7mOf.1") > 0);
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.1.5.7", "tul4NUsfs9Cl7mOf.2") < 0);
+}
+
+TEST_CASE("CausalCompare_TerminatorFollowsUnterminated")
+{
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.1", "tul4NUsfs9Cl7mOf.1!") < 0);
+    REQUIRE(microsoft::causal_compare("tul4NUsfs9Cl7mOf.1!", "tul4NUsfs9Cl7mOf.2") < 0);
+}
+
+TEST_CASE("CausalCompare_GroupsByBase")
+{
+    REQUIRE(microsoft::causal_compare("AAAAAAAAAAAAAAAA.100", "BBBBBBBBBBBBBBBB.0") < 0);
+    REQUIRE(microsoft::causal_compare("KZY+dsX2jEaZesgCPjJ2Ng.0", "KZY+dsX2jEaZesgCPjJ2Nf.9") > 0);
+}
+
+TEST_CASE("CausalSort_MatchesStdSort")
+{
+    microsoft::correlation_vector cv1{microsoft::correlation_vector_version::v2};
+    microsoft::correlation_vector cv2{microsoft::correlation_vector_version::v2};
+
+    std::vector<std::string> vectors;
+    std::mt19937 random{7};
+    for (int i = 0; i < 100000; ++i)
+    {
+        std::string cv{(i % 2 == 0 ? cv1 : cv2).value()};
+        for (int depth = random() % 4; depth > 0; --depth)
+        {
+            cv += '.' + std::to_string(random() % 20);
+        }
+
+        vectors.push_back(cv);
+    }
+
+    std::vector<std::string> expected{vectors};
+    std::sort(expected.begin(), expected.end(), microsoft::causal_less{});
+
+    microsoft::causal_sort(vectors.begin(), vectors.end(), 4);
+    REQUIRE(vectors == expected);
+}
@@ -0,0 +1,118 @@
+//---------------------------------------------------------------------
+// <copyright file="ColumnarTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/columnar.h"
+#include "correlation_vector/correlation_vector.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+std::string write_archive(const std::vector<std::string>& vectors, size_t blockSize)
+{
+    std::string path{"columnar_test_" + std::to_string(blockSize) + ".cvcol"};
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    microsoft::columnar_writer writer{out, blockSize};
+    for (const std::string& v : vectors)
+    {
+        writer.write(v);
+    }
+
+    writer.close();
+    return path;
+}
+} // namespace
+
+TEST_CASE("Columnar_RoundTrip")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    std::vector<std::string> vectors{"tul4NUsfs9Cl7mOf.1",
+                                     "tul4NUsfs9Cl7mOf.1.0",
+                                     "tul4NUsfs9Cl7mOf.1.1",
+                                     "tul4NUsfs9Cl7mOf.1.2.4294967295.0",
+                                     "tul4NUsfs9Cl7mOf.2",
+                                     cv.value(),
+                                     cv.increment(),
+                                     "tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.0!",
+                                     "tul4NUsfs9Cl7mOf.0"};
+
+    for (size_t blockSize : {1, 3, 1000})
+    {
+        std::string path{write_archive(vectors, blockSize)};
+        {
+            microsoft::columnar_reader reader{path};
+            REQUIRE(reader.size() == vectors.size());
+            REQUIRE(reader.base_count() == 2);
+
+            std::vector<std::string> values;
+            microsoft::columnar_reader::cursor cursor{reader.scan()};
+            while (cursor.next())
+            {
+                values.push_back(cursor.value());
+            }
+
+            REQUIRE(values == vectors);
+
+            microsoft::columnar_reader::cursor filtered{reader.scan(cv.value().substr(0, 22))};
+            REQUIRE(filtered.next());
+            REQUIRE(filtered.materialize().value() == cv.value().substr(0, 23) + "0");
+            REQUIRE(filtered.next());
+            REQUIRE(filtered.value() == cv.value());
+            REQUIRE_FALSE(filtered.next());
+
+            REQUIRE_FALSE(reader.scan("AAAAAAAAAAAAAAAA").next());
+        }
+
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("Columnar_RejectsLossyValues")
+{
+    std::ostringstream out;
+    microsoft::columnar_writer writer{out};
+    REQUIRE_THROWS_AS(writer.write("tul4NUsfs9Cl7mO.1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.write("tul4NUsfs9Cl7mOf.01"), std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.write("tul4NUsfs9Cl7mOf.1..2"), std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.write("KZY+dsX2jEaZesgCPjJ2Nh.1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(writer.write("tul4NUsfs9Cl7mOf.4294967296"), std::invalid_argument);
+    REQUIRE(writer.size() == 0);
+}
+
+TEST_CASE("Columnar_RejectsCorruptBlocks")
+{
+    // A 16-byte file header and a 24-byte block header precede the columns:
+    // the base deltas at 40 and 41, then the shared and fresh segment
+    // counts of each record from 42.
+    const std::vector<std::pair<std::streamoff, char>> patches{
+        {41, 2},      // the base of the second record is not in the dictionary
+        {41, '\x80'}, // the base delta runs into the shape column
+        {44, 5}};     // the second record shares more segments than the first has
+    for (const std::pair<std::streamoff, char>& patch : patches)
+    {
+        const std::string path{write_archive({"tul4NUsfs9Cl7mOf.1", "tul4NUsfs9Cl7mOf.1.2"}, 1000)};
+        {
+            std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+            file.seekp(patch.first);
+            file.put(patch.second);
+        }
+
+        {
+            microsoft::columnar_reader reader{path};
+            microsoft::columnar_reader::cursor cursor{reader.scan()};
+            REQUIRE(cursor.next());
+            REQUIRE(cursor.value() == "tul4NUsfs9Cl7mOf.1");
+            REQUIRE_THROWS_AS(cursor.next(), std::invalid_argument);
+        }
+
+        std::remove(path.c_str());
+    }
+}
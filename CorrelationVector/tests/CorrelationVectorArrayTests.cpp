@@ -0,0 +1,71 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorArrayTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_array.h"
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+TEST_CASE("CorrelationVectorArray_PadsSlots")
+{
+    microsoft::correlation_vector_array slots{5};
+    REQUIRE(slots.size() == 5);
+    REQUIRE(microsoft::correlation_vector_array::SLOT_SIZE % microsoft::correlation_vector_array::ALIGNMENT == 0);
+    REQUIRE(microsoft::correlation_vector_array::SLOT_SIZE >= sizeof(microsoft::correlation_vector));
+
+    std::unordered_set<std::string> bases;
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(&slots[i]);
+        REQUIRE(address % microsoft::correlation_vector_array::ALIGNMENT == 0);
+        REQUIRE(slots[i].version() == microsoft::correlation_vector_version::v2);
+        REQUIRE(slots[i].value().size() == 24);
+        bases.insert(slots[i].value());
+    }
+
+    REQUIRE(bases.size() == 5);
+
+    // Slots are replaced by assignment.
+    slots[2] = microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.1");
+    REQUIRE(slots[2].value() == "tul4NUsfs9Cl7mOf.1.0");
+    REQUIRE(slots[2].increment() == "tul4NUsfs9Cl7mOf.1.1");
+
+    const microsoft::correlation_vector_array v1{1, microsoft::correlation_vector_version::v1};
+    REQUIRE(v1[0].version() == microsoft::correlation_vector_version::v1);
+    REQUIRE(microsoft::correlation_vector_array{0}.size() == 0);
+}
+
+TEST_CASE("CorrelationVectorArray_IncrementsConcurrently")
+{
+    const size_t threadCount = 4;
+    const int increments = 10000;
+    microsoft::correlation_vector_array slots{threadCount};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+            for (int i = 0; i < increments; ++i)
+            {
+                slots[t].increment_into(buffer, sizeof(buffer));
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+        const std::string value{slots[t].value()};
+        REQUIRE(value.substr(value.rfind('.') + 1) == std::to_string(increments));
+    }
+}
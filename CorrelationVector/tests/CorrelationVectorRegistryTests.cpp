@@ -0,0 +1,146 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorRegistryTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_registry.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("IncrementInto_MatchesIncrement")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    microsoft::correlation_vector copy{cv};
+    char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+    for (int i = 0; i < 12; ++i)
+    {
+        const size_t length = cv.increment_into(buffer, sizeof(buffer));
+        REQUIRE(std::string(buffer, length) == copy.increment());
+    }
+
+    REQUIRE(cv.increment_into(buffer, 4) == 0);
+    REQUIRE(cv.value() == copy.increment());
+
+    const std::string baseVector{"KZY+dsX2jEaZesgCPjJ2Ng.2147483647.2147483647.2147483647.2147483647."
+                                 "2147483647.2147483647.2147483647.2147483647.2147483647"};
+    microsoft::correlation_vector full{microsoft::correlation_vector::parse(baseVector + ".99999")};
+    const size_t length = full.increment_into(buffer, sizeof(buffer));
+    REQUIRE(std::string(buffer, length) == baseVector + ".99999!");
+}
+
+TEST_CASE("Registry_FindsIncrementsAndErasesByBase")
+{
+    microsoft::correlation_vector_registry registry;
+    const std::string parent{microsoft::correlation_vector{microsoft::correlation_vector_version::v2}.value()};
+    microsoft::correlation_vector cv{microsoft::correlation_vector::extend(parent)};
+
+    std::shared_ptr<microsoft::correlation_vector> stored{registry.insert(cv)};
+    REQUIRE(stored->value() == parent + ".0");
+    REQUIRE(registry.insert(microsoft::correlation_vector::parse(parent + ".7")) == stored);
+    REQUIRE(registry.size() == 1);
+    REQUIRE(registry.find(parent) == stored);
+    REQUIRE(registry.find(parent.data(), parent.size() - 1) == nullptr);
+    REQUIRE(registry.find(cv.value()) == nullptr);
+
+    char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+    size_t length = registry.increment(parent.data(), parent.size(), buffer, sizeof(buffer));
+    REQUIRE(std::string(buffer, length) == parent + ".1");
+    REQUIRE(stored->increment() == parent + ".2");
+    REQUIRE(cv.value() == parent + ".0");
+
+    REQUIRE(registry.erase(parent));
+    REQUIRE_FALSE(registry.erase(parent));
+    REQUIRE(registry.size() == 0);
+    REQUIRE(registry.increment(parent.data(), parent.size(), buffer, sizeof(buffer)) == 0);
+    // The erased vector stays usable by those who hold it.
+    REQUIRE(stored->increment() == parent + ".3");
+
+    REQUIRE(registry.insert(cv)->value() == parent + ".0");
+    REQUIRE(registry.size() == 1);
+}
+
+TEST_CASE("Registry_GrowsAndReusesErasedSlots")
+{
+    microsoft::correlation_vector_registry registry;
+    std::vector<std::string> bases;
+    for (int i = 0; i < 5000; ++i)
+    {
+        bases.push_back(microsoft::correlation_vector{microsoft::correlation_vector_version::v2}.value());
+        registry.insert(microsoft::correlation_vector::parse(bases.back()));
+    }
+
+    REQUIRE(registry.size() == bases.size());
+    for (size_t i = 0; i < bases.size(); i += 2)
+    {
+        REQUIRE(registry.erase(bases[i].substr(0, bases[i].rfind('.'))));
+    }
+
+    REQUIRE(registry.size() == bases.size() / 2);
+    for (size_t i = 0; i < bases.size(); ++i)
+    {
+        const std::string base{bases[i].substr(0, bases[i].rfind('.'))};
+        REQUIRE((registry.find(base) != nullptr) == (i % 2 == 1));
+    }
+
+    // Churn through erased slots without losing the remaining vectors.
+    for (int round = 0; round < 10; ++round)
+    {
+        for (size_t i = 0; i < bases.size(); i += 2)
+        {
+            const std::string base{bases[i].substr(0, bases[i].rfind('.'))};
+            registry.insert(microsoft::correlation_vector::parse(bases[i]));
+            REQUIRE(registry.erase(base));
+        }
+    }
+
+    REQUIRE(registry.size() == bases.size() / 2);
+    for (size_t i = 1; i < bases.size(); i += 2)
+    {
+        REQUIRE(registry.find(bases[i].substr(0, bases[i].rfind('.'))) != nullptr);
+    }
+}
+
+TEST_CASE("Registry_IncrementIsUniqueAcrossThreads")
+{
+    microsoft::correlation_vector_registry registry;
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    const std::string value{cv.value()};
+    const std::string base{value.substr(0, value.rfind('.'))};
+    registry.insert(cv);
+
+    const int threadCount = 4;
+    const int increments = 1000;
+    std::vector<std::vector<std::string>> values(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&registry, &base, &values, t]() {
+            char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+            for (int i = 0; i < increments; ++i)
+            {
+                const size_t length = registry.increment(base.data(), base.size(), buffer, sizeof(buffer));
+                values[t].emplace_back(buffer, length);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<std::string> all;
+    for (const std::vector<std::string>& perThread : values)
+    {
+        all.insert(all.end(), perThread.begin(), perThread.end());
+    }
+
+    std::sort(all.begin(), all.end());
+    REQUIRE(std::unique(all.begin(), all.end()) == all.end());
+    REQUIRE(registry.find(base)->value() == base + "." + std::to_string(threadCount * increments));
+}
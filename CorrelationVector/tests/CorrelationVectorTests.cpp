@@ -6,11 +6,14 @@
 #define CATCH_CONFIG_MAIN
 #include "catch2/catch.hpp"
 #include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_view.h"
 #include "correlation_vector/guid.h"
 #include "correlation_vector/spin_parameters.h"
 #include "utilities.h"
+#include <atomic>
 #include <chrono>
 #include <future>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <unordered_set>
@@ -183,6 +186,14 @@ TEST_CASE("Extend_TooLongExtension")
                       std::invalid_argument);
 }
 
+TEST_CASE("Extend_SpinSegmentAboveIntMax")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector::extend("KZY+dsX2jEaZesgCPjJ2Ng.1.4294967295.0")};
+    REQUIRE(cv.value() == "KZY+dsX2jEaZesgCPjJ2Ng.1.4294967295.0.0");
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("KZY+dsX2jEaZesgCPjJ2Ng.1.4294967296.0"), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::parse("KZY+dsX2jEaZesgCPjJ2Ng.1.2147483648"), std::invalid_argument);
+}
+
 TEST_CASE("Extend_OverMaxLength_V1")
 {
     microsoft::correlation_vector cv{
@@ -309,4 +320,250 @@ TEST_CASE("Spin_SortValidation")
 
     // The counter should wrap at most 1 time.
     REQUIRE(wrappedCounter <= 1);
-}
\ No newline at end of file
+}
+
+TEST_CASE("BaseHash_IsStableAcrossHops")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.1")};
+
+    // 64-bit FNV-1a of "tul4NUsfs9Cl7mOf".
+    REQUIRE(cv.base_hash() == 0x5e26e2bf7b36ccd8ULL);
+
+    microsoft::correlation_vector extended{microsoft::correlation_vector::extend(cv.increment())};
+    microsoft::correlation_vector spun{microsoft::correlation_vector::spin(extended.value())};
+    microsoft::correlation_vector terminated{microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.1.2!")};
+    microsoft::correlation_vector copy{spun};
+    microsoft::correlation_vector assigned;
+    assigned = std::move(copy);
+    REQUIRE(extended.base_hash() == cv.base_hash());
+    REQUIRE(spun.base_hash() == cv.base_hash());
+    REQUIRE(terminated.base_hash() == cv.base_hash());
+    REQUIRE(assigned.base_hash() == cv.base_hash());
+
+    microsoft::correlation_vector v2{microsoft::correlation_vector::extend("KZY+dsX2jEaZesgCPjJ2Ng.1")};
+    REQUIRE(v2.base_hash() == 0x6592d1f8a43c372eULL);
+}
+
+TEST_CASE("ShouldSample_MatchesRate")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    REQUIRE_FALSE(cv.should_sample(0.0));
+    REQUIRE_FALSE(cv.should_sample(-1.0));
+    REQUIRE_FALSE(cv.should_sample(std::nan("")));
+    REQUIRE(cv.should_sample(1.0));
+    REQUIRE(cv.should_sample(2.0));
+    REQUIRE(cv.should_sample(0.5) == microsoft::correlation_vector::extend(cv.increment()).should_sample(0.5));
+
+    const int count = 100000;
+    int sampled = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        microsoft::correlation_vector root{microsoft::correlation_vector_version::v2};
+        sampled += root.should_sample(0.01) ? 1 : 0;
+    }
+
+    REQUIRE(sampled > count / 100 * 8 / 10);
+    REQUIRE(sampled < count / 100 * 12 / 10);
+}
+
+TEST_CASE("Validate_ReportsReason")
+{
+    auto validate = [](const std::string& value) {
+        return microsoft::correlation_vector::validate(value.data(), value.size());
+    };
+
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.1") == microsoft::validation_result::valid);
+    REQUIRE(validate("KZY+dsX2jEaZesgCPjJ2Ng.1.4294967295.2147483647!") == microsoft::validation_result::valid);
+    REQUIRE(validate("") == microsoft::validation_result::empty);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.1 ") == microsoft::validation_result::whitespace);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.123") ==
+            microsoft::validation_result::too_long);
+    REQUIRE(validate("tul4NUsfs9Cl7mO.1") == microsoft::validation_result::invalid_base);
+    REQUIRE(validate("tul4NUsfs9Cl7m*f.1") == microsoft::validation_result::invalid_base);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf") == microsoft::validation_result::invalid_base);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.1.2147483648") == microsoft::validation_result::invalid_extension);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.4294967296.1") == microsoft::validation_result::invalid_extension);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf..1") == microsoft::validation_result::invalid_extension);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.1.") == microsoft::validation_result::invalid_extension);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.+1") == microsoft::validation_result::invalid_extension);
+    REQUIRE(validate("tul4NUsfs9Cl7mOf.1!!") == microsoft::validation_result::invalid_extension);
+}
+
+TEST_CASE("Extend_KeepsEarlierAcceptanceRules")
+{
+    // validate() rejects these, but parse and extend accepted them before it
+    // existed and still do.
+    REQUIRE(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf..1").value() == "tul4NUsfs9Cl7mOf..1.0");
+    REQUIRE(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.+1").value() == "tul4NUsfs9Cl7mOf.+1.0");
+    REQUIRE(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.-0").value() == "tul4NUsfs9Cl7mOf.-0.0");
+    REQUIRE(microsoft::correlation_vector::extend("tul4NUsfs9Cl7m*f.1").value() == "tul4NUsfs9Cl7m*f.1.0");
+    REQUIRE(microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf..1").value() == "tul4NUsfs9Cl7mOf..1");
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.-1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.1a"), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.2147483648"), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("tul4NUsfs9Cl7m.f.1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf..."), std::invalid_argument);
+}
+
+TEST_CASE("Validate_RejectsHugeValuesUpFront")
+{
+    // The length is checked before anything else is read, so a huge value
+    // is too long even if it also has whitespace.
+    const std::string huge{"KZY+dsX2jEaZesgCPjJ2Ng." + std::string(1 << 20, '1') + ' '};
+    REQUIRE(microsoft::correlation_vector::validate(huge.data(), huge.size()) == microsoft::validation_result::too_long);
+    REQUIRE(microsoft::correlation_vector::validate(huge.data(), 128) == microsoft::validation_result::too_long);
+
+    const std::string dots{"KZY+dsX2jEaZesgCPjJ2Ng" + std::string(1 << 20, '.')};
+    REQUIRE(microsoft::correlation_vector::validate(dots.data(), dots.size()) == microsoft::validation_result::too_long);
+
+    // Exception messages quote only the start of the value.
+    for (const std::string& value : {huge, dots, std::string(1 << 20, 'A')})
+    {
+        try
+        {
+            microsoft::correlation_vector::extend(value);
+            FAIL("extend accepted a huge value");
+        }
+        catch (const std::invalid_argument& e)
+        {
+            REQUIRE(std::string{e.what()}.size() < 512);
+        }
+    }
+}
+
+TEST_CASE("Value_FollowsIncrementAcrossDigits")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse("KZY+dsX2jEaZesgCPjJ2Ng.1.97")};
+    // The view points into the vector itself.
+    const char* const first = reinterpret_cast<const char*>(&cv);
+    const char* const last = reinterpret_cast<const char*>(&cv + 1);
+    for (int i = 98; i <= 1001; ++i)
+    {
+        const std::string expected{"KZY+dsX2jEaZesgCPjJ2Ng.1." + std::to_string(i)};
+        REQUIRE(cv.increment() == expected);
+        REQUIRE(cv.value() == expected);
+        REQUIRE(cv.view().to_string() == expected);
+        REQUIRE(cv.view().data() >= first);
+        REQUIRE(cv.view().data() < last);
+    }
+
+    microsoft::correlation_vector copy{cv};
+    REQUIRE(copy.view().to_string() == "KZY+dsX2jEaZesgCPjJ2Ng.1.1001");
+    REQUIRE((copy.view().data() < first || copy.view().data() >= last));
+    copy = microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.9!");
+    REQUIRE(copy.value() == "tul4NUsfs9Cl7mOf.9!");
+    REQUIRE(copy.view().is_immutable());
+}
+
+TEST_CASE("Value_ShowsTerminatorWhenOversized")
+{
+    microsoft::correlation_vector cv{
+        microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.98")};
+    cv.increment();
+    REQUIRE(cv.view().to_string() == "tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.99");
+    REQUIRE(cv.increment() == "tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.99!");
+    REQUIRE(cv.view().to_string() == "tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.99!");
+    REQUIRE(cv.view().last_extension() == 99);
+}
+
+TEST_CASE("Value_IsNewestAfterConcurrentIncrements")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse("KZY+dsX2jEaZesgCPjJ2Ng.0")};
+    std::atomic<bool> isDone{false};
+    std::atomic<bool> isConsistent{true};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&]() {
+            // A thread reads at least the extension of its own increment.
+            const size_t prefixLength = std::string{"KZY+dsX2jEaZesgCPjJ2Ng."}.size();
+            for (int i = 0; i < 2500; ++i)
+            {
+                const unsigned long extension = std::stoul(cv.increment().substr(prefixLength));
+                if (std::stoul(cv.value().substr(prefixLength)) < extension)
+                {
+                    isConsistent = false;
+                }
+            }
+        });
+    }
+
+    // Reads made meanwhile are never torn and never go back.
+    std::thread reader{[&]() {
+        const std::string prefix{"KZY+dsX2jEaZesgCPjJ2Ng."};
+        char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+        unsigned long previous = 0;
+        while (!isDone.load())
+        {
+            const std::string value{buffer, cv.copy_value(buffer, sizeof(buffer))};
+            const std::string digits{value.size() > prefix.size() ? value.substr(prefix.size()) : ""};
+            if (value.compare(0, prefix.size(), prefix) != 0 ||
+                digits.find_first_not_of("0123456789") != std::string::npos || digits.empty() ||
+                std::stoul(digits) < previous)
+            {
+                isConsistent = false;
+                continue;
+            }
+
+            previous = std::stoul(digits);
+        }
+    }};
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    isDone = true;
+    reader.join();
+    REQUIRE(isConsistent.load());
+    REQUIRE(cv.value() == "KZY+dsX2jEaZesgCPjJ2Ng.10000");
+}
+
+TEST_CASE("SpinMany_CreatesDistinctChildren")
+{
+    const std::string parent{"KZY+dsX2jEaZesgCPjJ2Ng.1"};
+    microsoft::spin_parameters parameters{microsoft::spin_counter_interval::fine,
+                                          microsoft::spin_counter_periodicity::long_length,
+                                          microsoft::spin_entropy::one};
+    std::vector<microsoft::correlation_vector> children(256);
+    microsoft::correlation_vector::spin_many(parent, parameters, children.size(), children.data());
+
+    std::unordered_set<std::string> values;
+    for (microsoft::correlation_vector& child : children)
+    {
+        std::vector<std::string> splitVector{microsoft::utilities::split_str(child.value(), '.')};
+
+        // 40 bits of spin value are written as two segments after the parent.
+        REQUIRE(splitVector.size() == 5);
+        REQUIRE(child.value().compare(0, parent.size() + 1, parent + '.') == 0);
+        REQUIRE(splitVector[4] == "0");
+        REQUIRE(std::stoul(splitVector[2]) < 256);
+        REQUIRE(child.base_hash() == children[0].base_hash());
+        REQUIRE(child.version() == microsoft::correlation_vector_version::v2);
+        const std::string incremented{child.increment()};
+        REQUIRE(incremented == child.value());
+        values.insert(splitVector[2] + '.' + splitVector[3]);
+    }
+
+    REQUIRE(values.size() == children.size());
+    REQUIRE_THROWS_AS(
+        microsoft::correlation_vector::spin_many(parent, parameters, 257, children.data()), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::spin_many("tul4NUsfs9Cl7mOf. 1", parameters, 1, children.data()),
+                      std::invalid_argument);
+}
+
+TEST_CASE("SpinMany_TerminatesLikeSpin")
+{
+    const std::string immutable{"tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.0!"};
+    const std::string full{"tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.0"};
+    std::vector<microsoft::correlation_vector> children(2);
+
+    microsoft::correlation_vector::spin_many(immutable, {}, children.size(), children.data());
+    REQUIRE(children[0].value() == immutable);
+    REQUIRE(children[1].value() == immutable);
+
+    microsoft::correlation_vector::spin_many(full, {}, children.size(), children.data());
+    REQUIRE(children[0].value() == full + '!');
+    REQUIRE(children[1].value() == microsoft::correlation_vector::spin(full).value());
+}
@@ -0,0 +1,73 @@
+//---------------------------------------------------------------------
+// <copyright file="CorrelationVectorViewTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/correlation_vector_view.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("CorrelationVectorView_ExposesParts")
+{
+    const char* text = "KZY+dsX2jEaZesgCPjJ2Ng.1.4294967295.7";
+    microsoft::correlation_vector_view view{text, std::strlen(text)};
+    REQUIRE(view.validate() == microsoft::validation_result::valid);
+    REQUIRE(view.version() == microsoft::correlation_vector_version::v2);
+    REQUIRE_FALSE(view.is_immutable());
+    REQUIRE(view.base().to_string() == "KZY+dsX2jEaZesgCPjJ2Ng");
+    REQUIRE(view.base_vector().to_string() == "KZY+dsX2jEaZesgCPjJ2Ng.1.4294967295");
+    REQUIRE(view.depth() == 3);
+    REQUIRE(view.last_extension() == 7);
+
+    std::vector<uint32_t> segments;
+    for (uint32_t segment : view.segments())
+    {
+        segments.push_back(segment);
+    }
+
+    REQUIRE(segments == std::vector<uint32_t>{1, 4294967295u, 7});
+
+    const microsoft::correlation_vector parsed{view.to_correlation_vector()};
+    REQUIRE(parsed.value() == text);
+    REQUIRE(view.base_hash() == parsed.base_hash());
+}
+
+TEST_CASE("CorrelationVectorView_HandlesTerminatorAndV1")
+{
+    const std::string text{"tul4NUsfs9Cl7mOf.2.15!"};
+    microsoft::correlation_vector_view view{text};
+    REQUIRE(view.validate() == microsoft::validation_result::valid);
+    REQUIRE(view.version() == microsoft::correlation_vector_version::v1);
+    REQUIRE(view.is_immutable());
+    REQUIRE(view.base_vector().to_string() == "tul4NUsfs9Cl7mOf.2");
+    REQUIRE(view.depth() == 2);
+    REQUIRE(view.last_extension() == 15);
+
+    std::vector<uint32_t> segments(view.segments().begin(), view.segments().end());
+    REQUIRE(segments == std::vector<uint32_t>{2, 15});
+}
+
+TEST_CASE("CorrelationVectorView_ValidatesOnlyOnRequest")
+{
+    microsoft::correlation_vector_view empty;
+    REQUIRE(empty.validate() == microsoft::validation_result::empty);
+    REQUIRE(empty.depth() == 0);
+    REQUIRE(empty.last_extension() == -1);
+    REQUIRE(empty.segments().begin() == empty.segments().end());
+
+    const std::string baseOnly{"tul4NUsfs9Cl7mOf"};
+    microsoft::correlation_vector_view view{baseOnly};
+    REQUIRE(view.validate() == microsoft::validation_result::invalid_base);
+    REQUIRE(view.base_vector().size() == 0);
+    REQUIRE(view.last_extension() == -1);
+    REQUIRE(view.segments().begin() == view.segments().end());
+
+    const std::string invalid{"tul4NUsfs9Cl7mOf.x"};
+    REQUIRE(microsoft::correlation_vector_view{invalid}.validate() ==
+            microsoft::validation_result::invalid_extension);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector_view{invalid}.to_correlation_vector(), std::invalid_argument);
+}
@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------
+// <copyright file="EventRingTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/event_ring.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class memory_sink : public microsoft::event_sink
+{
+public:
+    std::vector<microsoft::event_record> records;
+    std::atomic<bool> stalled{false};
+    size_t flushes{0};
+
+    void write(const microsoft::event_record* batch, size_t count) override
+    {
+        while (stalled)
+        {
+            std::this_thread::yield();
+        }
+
+        records.insert(records.end(), batch, batch + count);
+    }
+
+    void flush() override { ++flushes; }
+};
+
+std::string cv_of(const microsoft::event_record& record)
+{
+    return std::string(record.cv, record.cv_length);
+}
+} // namespace
+
+TEST_CASE("CopyValue_MatchesValue")
+{
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    cv.increment();
+    char buffer[microsoft::correlation_vector::MAX_VALUE_LENGTH];
+    size_t length = cv.copy_value(buffer, sizeof(buffer));
+    REQUIRE(std::string(buffer, length) == cv.value());
+    REQUIRE(cv.copy_value(buffer, cv.value().size() - 1) == 0);
+
+    microsoft::correlation_vector terminated{microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.1.2!")};
+    length = terminated.copy_value(buffer, sizeof(buffer));
+    REQUIRE(std::string(buffer, length) == terminated.value());
+}
+
+TEST_CASE("EventRing_KeepsOrderOfEachProducer")
+{
+    const int producerCount = 4;
+    const uint32_t eventsPerProducer = 5000;
+    memory_sink sink;
+    {
+        microsoft::event_ring_options options;
+        options.capacity = 64;
+        options.batch_size = 16;
+        options.policy = microsoft::backpressure::block;
+        microsoft::event_ring ring{sink, options};
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producerCount; ++p)
+        {
+            producers.emplace_back([&ring, p, eventsPerProducer]() {
+                microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+                for (uint32_t i = 0; i < eventsPerProducer; ++i)
+                {
+                    ring.emit(cv, i, &p, sizeof(p));
+                    cv.increment();
+                }
+            });
+        }
+
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        ring.flush();
+        REQUIRE(ring.dropped() == 0);
+        REQUIRE(ring.written() == producerCount * eventsPerProducer);
+        REQUIRE(sink.flushes >= 1);
+    }
+
+    REQUIRE(sink.records.size() == producerCount * eventsPerProducer);
+    std::vector<uint32_t> next(producerCount, 0);
+    for (const microsoft::event_record& record : sink.records)
+    {
+        int producer;
+        REQUIRE(record.payload_length == sizeof(producer));
+        std::memcpy(&producer, record.payload, sizeof(producer));
+        REQUIRE(record.event_id == next[producer]);
+        const std::string value{cv_of(record)};
+        REQUIRE(value.substr(value.rfind('.') + 1) == std::to_string(record.event_id));
+        ++next[producer];
+    }
+}
+
+TEST_CASE("EventRing_DropsWhenFull")
+{
+    memory_sink sink;
+    sink.stalled = true;
+    microsoft::event_ring_options options;
+    options.capacity = 8;
+    options.batch_size = 1;
+    microsoft::event_ring ring{sink, options};
+
+    const char cv[] = "tul4NUsfs9Cl7mOf.1";
+    size_t accepted = 0;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        accepted += ring.emit(cv, sizeof(cv) - 1, i, microsoft::event_ring::now()) ? 1 : 0;
+    }
+
+    // The consumer holds at most one record while the sink is stalled.
+    REQUIRE(accepted >= 8);
+    REQUIRE(accepted <= 9);
+    REQUIRE(ring.dropped() == 100 - accepted);
+
+    sink.stalled = false;
+    ring.flush();
+    REQUIRE(sink.records.size() == accepted);
+    REQUIRE(sink.records.front().event_id == 0);
+}
+
+TEST_CASE("EventRing_ZeroesUnusedBytes")
+{
+    memory_sink sink;
+    microsoft::event_ring_options options;
+    options.capacity = 2;
+    microsoft::event_ring ring{sink, options};
+
+    // Short events reuse the slots of long ones.
+    const std::string longCv{"KZY+dsX2jEaZesgCPjJ2Ng." + std::string(100, '1')};
+    const std::string longPayload(microsoft::event_record::PAYLOAD_CAPACITY, 'x');
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.1")};
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            REQUIRE(ring.emit(longCv.data(), longCv.size(), i, 0, longPayload.data(), longPayload.size()));
+        }
+        else
+        {
+            REQUIRE(ring.emit(cv, i, "p", 1));
+        }
+
+        ring.flush();
+    }
+
+    REQUIRE(sink.records.size() == 8);
+    for (const microsoft::event_record& record : sink.records)
+    {
+        for (size_t i = record.cv_length; i < sizeof(record.cv); ++i)
+        {
+            REQUIRE(record.cv[i] == 0);
+        }
+
+        for (size_t i = record.payload_length; i < sizeof(record.payload); ++i)
+        {
+            REQUIRE(record.payload[i] == 0);
+        }
+    }
+}
+
+TEST_CASE("EventRing_RejectsOversizedInput")
+{
+    memory_sink sink;
+    microsoft::event_ring ring{sink};
+    const std::string longValue(microsoft::correlation_vector::MAX_VALUE_LENGTH + 1, 'a');
+    const char payload[microsoft::event_record::PAYLOAD_CAPACITY + 1] = {};
+    REQUIRE_FALSE(ring.emit(longValue.data(), longValue.size(), 1, 0));
+    REQUIRE_FALSE(ring.emit(longValue.data(), 16, 1, 0, payload, sizeof(payload)));
+    REQUIRE(ring.emit(longValue.data(), longValue.size() - 1, 1, 0, payload, sizeof(payload) - 1));
+    REQUIRE(ring.dropped() == 0);
+
+    microsoft::event_ring_options options;
+    options.capacity = 100;
+    REQUIRE_THROWS_AS(microsoft::event_ring(sink, options), std::invalid_argument);
+}
+
+TEST_CASE("EventRing_FileSinkRoundTrip")
+{
+    const std::string path{"event_ring_test.cvevt"};
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v1};
+    std::vector<std::string> values;
+    {
+        microsoft::file_event_sink sink{path};
+        microsoft::event_ring ring{sink};
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            values.push_back(cv.value());
+            REQUIRE(ring.emit(cv, i, "payload", 7));
+            cv.increment();
+        }
+
+        ring.flush();
+        REQUIRE_FALSE(sink.failed());
+    }
+
+    const std::vector<microsoft::event_record> records{microsoft::file_event_sink::read(path)};
+    std::remove(path.c_str());
+    REQUIRE(records.size() == values.size());
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        REQUIRE(records[i].event_id == i);
+        REQUIRE(cv_of(records[i]) == values[i]);
+        REQUIRE(std::string(records[i].payload, records[i].payload_length) == "payload");
+    }
+
+    REQUIRE(records.front().timestamp <= records.back().timestamp);
+    REQUIRE_THROWS_AS(microsoft::file_event_sink::read(CV_FIXTURES_DIR "/http/duplicate.http"),
+                      std::invalid_argument);
+}
@@ -0,0 +1,162 @@
+//---------------------------------------------------------------------
+// <copyright file="FlightRecorderTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/flight_recorder.h"
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::string cv_of(const microsoft::flight_record& record)
+{
+    return std::string(record.cv, record.length);
+}
+} // namespace
+
+TEST_CASE("FlightRecorder_KeepsLastRecordsOfEachThread")
+{
+    const std::string path{"flight_recorder_test.cvflt"};
+    microsoft::flight_recorder::start(path, 8);
+    REQUIRE(microsoft::flight_recorder::active());
+    REQUIRE_THROWS_AS(microsoft::flight_recorder::start(path), std::logic_error);
+
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    for (int i = 0; i < 20; ++i)
+    {
+        cv.increment();
+    }
+
+    microsoft::correlation_vector extended{microsoft::correlation_vector::extend(cv.value())};
+    microsoft::flight_recorder::stop();
+    REQUIRE_FALSE(microsoft::flight_recorder::active());
+    extended.increment();
+
+    const std::vector<microsoft::flight_thread> threads{microsoft::flight_recorder::read(path)};
+    std::remove(path.c_str());
+    if (!microsoft::flight_recorder::enabled())
+    {
+        REQUIRE(threads.empty());
+        return;
+    }
+
+    REQUIRE(threads.size() == 1);
+    const microsoft::flight_thread& thread = threads.front();
+    REQUIRE(thread.total == 22);
+    REQUIRE(thread.records.size() == 8);
+    REQUIRE(thread.records.front().sequence == 15);
+    REQUIRE(thread.records.back().sequence == 22);
+    REQUIRE(thread.records.back().thread_id == thread.thread_id);
+    REQUIRE(thread.records.back().operation ==
+            static_cast<uint8_t>(microsoft::flight_operation::extend));
+    REQUIRE(cv_of(thread.records.back()) == cv.value() + ".0");
+    REQUIRE(cv_of(thread.records[6]) == cv.value());
+    REQUIRE(thread.records[6].operation ==
+            static_cast<uint8_t>(microsoft::flight_operation::increment));
+}
+
+TEST_CASE("FlightRecorder_StopsWhileThreadsRecord")
+{
+    const std::string path{"flight_recorder_stop.cvflt"};
+    microsoft::flight_recorder::start(path, 16);
+    std::atomic<bool> isDone{false};
+    std::atomic<int> started{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&]() {
+            microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+            ++started;
+            while (!isDone.load())
+            {
+                cv.increment();
+            }
+        });
+    }
+
+    while (started.load() != 4)
+    {
+        std::this_thread::yield();
+    }
+
+    // Recording threads must not write to the file once it is unmapped.
+    microsoft::flight_recorder::stop();
+    REQUIRE_FALSE(microsoft::flight_recorder::active());
+    isDone = true;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const std::vector<microsoft::flight_thread> recorded{microsoft::flight_recorder::read(path)};
+    std::remove(path.c_str());
+    REQUIRE(recorded.size() <= 4);
+}
+
+TEST_CASE("FlightRecorder_RejectsInvalidInput")
+{
+    REQUIRE_THROWS_AS(microsoft::flight_recorder::start("flight_recorder_invalid.cvflt", 100),
+                      std::invalid_argument);
+    REQUIRE_FALSE(microsoft::flight_recorder::active());
+    REQUIRE_THROWS_AS(microsoft::flight_recorder::read(CV_FIXTURES_DIR "/http/duplicate.http"),
+                      std::invalid_argument);
+}
+
+#if !defined(_WIN32)
+TEST_CASE("FlightRecorder_SurvivesKilledProcess")
+{
+    if (!microsoft::flight_recorder::enabled())
+    {
+        return;
+    }
+
+    const std::string path{"flight_recorder_killed.cvflt"};
+    const std::string base{"KZY+dsX2jEaZesgCPjJ2Ng"};
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0)
+    {
+        // The child must never return into the test runner.
+        try
+        {
+            microsoft::flight_recorder::start(path, 16);
+            microsoft::correlation_vector cv{microsoft::correlation_vector::extend(base + ".1")};
+            for (int i = 0; i < 100; ++i)
+            {
+                cv.increment();
+            }
+
+            kill(getpid(), SIGKILL);
+        }
+        catch (...)
+        {
+        }
+
+        _exit(1);
+    }
+
+    int status = 0;
+    REQUIRE(waitpid(child, &status, 0) == child);
+    REQUIRE(WIFSIGNALED(status));
+
+    const std::vector<microsoft::flight_thread> threads{microsoft::flight_recorder::read(path)};
+    std::remove(path.c_str());
+    REQUIRE(threads.size() == 1);
+    REQUIRE(threads.front().total == 101);
+    REQUIRE(threads.front().records.size() == 16);
+    REQUIRE(cv_of(threads.front().records.back()) == base + ".1.100");
+}
+#endif
@@ -0,0 +1,103 @@
+//---------------------------------------------------------------------
+// <copyright file="GuidTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/guid.h"
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("FromBase64_RoundTripsToBase64String")
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        const microsoft::guid guid{microsoft::guid::create()};
+        const std::string base64{guid.to_base64_string()};
+        microsoft::guid decoded{microsoft::guid::empty()};
+        REQUIRE(microsoft::guid::try_from_base64(base64.data(), base64.size(), decoded));
+        REQUIRE(decoded == guid);
+        REQUIRE(microsoft::guid::from_base64(base64) == guid);
+
+        // The base of a v2 vector is the base64 string of its guid.
+        const std::string value{microsoft::correlation_vector{guid}.value()};
+        REQUIRE(microsoft::guid::from_base64(value.substr(0, 22)) == guid);
+    }
+}
+
+TEST_CASE("FromBase64_RejectsInvalidText")
+{
+    const std::array<unsigned char, 16> bytes{
+        {0xFF, 0xFE, 0xFD, 0xFC, 0xFB, 0xFA, 0xF9, 0xF8, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00}};
+    const microsoft::guid guid{microsoft::guid::create(bytes)};
+    const std::string base64{guid.to_base64_string()};
+    REQUIRE(base64 == "//79/Pv6+fgHBgUEAwIBAA");
+
+    microsoft::guid decoded{guid};
+    for (size_t i = 0; i < base64.size(); ++i)
+    {
+        for (const char c : {'.', '=', '-', ' ', '\0', '\x80'})
+        {
+            std::string invalid{base64};
+            invalid[i] = c;
+            REQUIRE_FALSE(microsoft::guid::try_from_base64(invalid.data(), invalid.size(), decoded));
+        }
+    }
+
+    // The 4 bits after the 16 bytes must be zero.
+    REQUIRE_FALSE(microsoft::guid::try_from_base64("//79/Pv6+fgHBgUEAwIBAB", 22, decoded));
+    REQUIRE_FALSE(microsoft::guid::try_from_base64(base64.data(), 21, decoded));
+    REQUIRE(decoded == guid);
+    REQUIRE_THROWS_AS(microsoft::guid::from_base64("tul4NUsfs9Cl7mOf"), std::invalid_argument);
+}
+
+TEST_CASE("FromBase64Many_DecodesEachBase")
+{
+    std::vector<microsoft::guid> guids;
+    std::vector<std::string> values;
+    for (int i = 0; i < 64; ++i)
+    {
+        guids.push_back(microsoft::guid::create());
+        values.push_back(microsoft::correlation_vector{guids.back()}.increment());
+    }
+
+    values[7] = "KZY+dsX2jEaZesgCPjJ2N*.1";
+    std::vector<const char*> bases;
+    for (const std::string& value : values)
+    {
+        bases.push_back(value.data());
+    }
+
+    std::vector<microsoft::guid> decoded(bases.size(), microsoft::guid::create());
+    REQUIRE(microsoft::guid::from_base64_many(bases.data(), bases.size(), decoded.data()) == 63);
+    for (size_t i = 0; i < guids.size(); ++i)
+    {
+        REQUIRE(decoded[i] == (i == 7 ? microsoft::guid::empty() : guids[i]));
+    }
+}
+
+TEST_CASE("Parse_RoundTripsToString")
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        const microsoft::guid guid{microsoft::guid::create()};
+        REQUIRE(microsoft::guid::parse(guid.to_string()) == guid);
+    }
+
+    const std::array<unsigned char, 16> bytes{
+        {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10}};
+    const microsoft::guid guid{microsoft::guid::create(bytes)};
+    REQUIRE(guid.to_string() == "01234567-89AB-CDEF-FEDC-BA9876543210");
+    REQUIRE(microsoft::guid::parse("01234567-89ab-cdef-fedc-ba9876543210") == guid);
+
+    microsoft::guid parsed{guid};
+    REQUIRE_FALSE(microsoft::guid::try_parse("01234567-89AB-CDEF-FEDC-BA987654321G", 36, parsed));
+    REQUIRE_FALSE(microsoft::guid::try_parse("01234567+89AB-CDEF-FEDC-BA9876543210", 36, parsed));
+    REQUIRE_FALSE(microsoft::guid::try_parse("0123456789AB-CDEF-FEDC-BA9876543210", 35, parsed));
+    REQUIRE_FALSE(microsoft::guid::try_parse("{1234567-89AB-CDEF-FEDC-BA9876543210", 36, parsed));
+    REQUIRE(parsed == guid);
+    REQUIRE_THROWS_AS(microsoft::guid::parse("0123456789ABCDEFFEDCBA9876543210"), std::invalid_argument);
+}
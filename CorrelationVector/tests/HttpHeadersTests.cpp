@@ -0,0 +1,139 @@
+//---------------------------------------------------------------------
+// <copyright file="HttpHeadersTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/http_headers.h"
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+std::string read_fixture(const std::string& name)
+{
+    std::ifstream in{std::string{CV_FIXTURES_DIR} + "/http/" + name, std::ios::binary};
+    REQUIRE(in);
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+struct fixture_case
+{
+    const char* file;
+    microsoft::header_status status;
+    microsoft::validation_result validation;
+    const char* value;
+};
+} // namespace
+
+TEST_CASE("HttpHeaders_Fixtures")
+{
+    using microsoft::header_status;
+    using microsoft::validation_result;
+
+    const fixture_case cases[] = {
+        {"request_v1.http", header_status::ok, validation_result::valid, "tul4NUsfs9Cl7mOf.1"},
+        {"request_v2_lowercase.http", header_status::ok, validation_result::valid, "KZY+dsX2jEaZesgCPjJ2Ng.2.5"},
+        {"response_mixed_case.http", header_status::ok, validation_result::valid, "KZY+dsX2jEaZesgCPjJ2Ng.7"},
+        {"request_lf_only.http", header_status::ok, validation_result::valid, "tul4NUsfs9Cl7mOf.3.1"},
+        {"terminated.http", header_status::ok, validation_result::valid, "tul4NUsfs9Cl7mOf.2.4!"},
+        {"oversized_v1.http",
+         header_status::ok,
+         validation_result::valid,
+         "tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.1"},
+        {"duplicate.http", header_status::ok, validation_result::valid, "tul4NUsfs9Cl7mOf.5"},
+        {"fields_only.http", header_status::ok, validation_result::valid, "KZY+dsX2jEaZesgCPjJ2Ng.1.2.3"},
+        {"long_headers.http", header_status::ok, validation_result::valid, "KZY+dsX2jEaZesgCPjJ2Ng.4294967295.0"},
+        {"missing.http", header_status::not_found, validation_result::valid, ""},
+        {"invalid_base.http", header_status::invalid, validation_result::invalid_base, "tul4NUsfs9Cl7mO.1"},
+        {"invalid_extension.http", header_status::invalid, validation_result::invalid_extension, "tul4NUsfs9Cl7mOf.1a"},
+        {"empty_value.http", header_status::invalid, validation_result::empty, ""},
+    };
+
+    for (const fixture_case& c : cases)
+    {
+        INFO(c.file);
+        const std::string block{read_fixture(c.file)};
+
+        microsoft::header_field field{microsoft::http_headers::find(block.data(), block.size())};
+        if (c.status != header_status::not_found)
+        {
+            REQUIRE(field.status == header_status::ok);
+            REQUIRE(block.substr(field.offset, field.length) == c.value);
+        }
+
+        char value[128];
+        microsoft::header_result extended{
+            microsoft::http_headers::extend(block.data(), block.size(), value, sizeof(value))};
+        REQUIRE(extended.status == c.status);
+        REQUIRE(extended.validation == c.validation);
+        if (c.status != header_status::ok)
+        {
+            continue;
+        }
+
+        // The results match the std::string based API.
+        microsoft::correlation_vector cv{microsoft::correlation_vector::extend(c.value)};
+        size_t valueLength = extended.length;
+        REQUIRE(std::string(value, valueLength) == cv.value());
+
+        for (int i = 0; i < 3; ++i)
+        {
+            char line[137];
+            microsoft::header_result outbound{
+                microsoft::http_headers::increment(value, valueLength, sizeof(value), line, sizeof(line))};
+            REQUIRE(outbound.status == header_status::ok);
+            REQUIRE(std::string(line, outbound.length) == "MS-CV: " + cv.increment() + "\r\n");
+            REQUIRE(std::string(value, valueLength) == cv.value());
+        }
+    }
+}
+
+TEST_CASE("HttpHeaders_IncrementTerminatesAtMaxLength")
+{
+    // 61 characters; the extended vector reaches the v1 limit of 63.
+    const std::string inbound{"tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.100000000.1"};
+    const std::string block{"GET / HTTP/1.1\r\nMS-CV: " + inbound + "\r\n\r\n"};
+    microsoft::correlation_vector cv{microsoft::correlation_vector::extend(inbound)};
+
+    char value[128];
+    microsoft::header_result extended{microsoft::http_headers::extend(block.data(), block.size(), value, sizeof(value))};
+    REQUIRE(extended.status == microsoft::header_status::ok);
+    size_t valueLength = extended.length;
+    for (int i = 0; i < 12; ++i)
+    {
+        char line[137];
+        microsoft::header_result outbound{
+            microsoft::http_headers::increment(value, valueLength, sizeof(value), line, sizeof(line))};
+        REQUIRE(outbound.status == microsoft::header_status::ok);
+        REQUIRE(std::string(line, outbound.length) == "MS-CV: " + cv.increment() + "\r\n");
+    }
+
+    REQUIRE(std::string(value, valueLength) == inbound + ".9!");
+}
+
+TEST_CASE("HttpHeaders_BufferTooSmall")
+{
+    const std::string block{"MS-CV: tul4NUsfs9Cl7mOf.1\r\n\r\n"};
+    char value[20];
+    microsoft::header_result extended{microsoft::http_headers::extend(block.data(), block.size(), value, 19)};
+    REQUIRE(extended.status == microsoft::header_status::buffer_too_small);
+
+    extended = microsoft::http_headers::extend(block.data(), block.size(), value, sizeof(value));
+    REQUIRE(extended.status == microsoft::header_status::ok);
+    REQUIRE(extended.length == 20);
+
+    // The value is left untouched when the line does not fit.
+    size_t valueLength = extended.length;
+    char line[29];
+    microsoft::header_result outbound{
+        microsoft::http_headers::increment(value, valueLength, sizeof(value), line, sizeof(line) - 1)};
+    REQUIRE(outbound.status == microsoft::header_status::buffer_too_small);
+    REQUIRE(std::string(value, valueLength) == "tul4NUsfs9Cl7mOf.1.0");
+
+    outbound = microsoft::http_headers::increment(value, valueLength, sizeof(value), line, sizeof(line));
+    REQUIRE(outbound.status == microsoft::header_status::ok);
+    REQUIRE(std::string(line, outbound.length) == "MS-CV: tul4NUsfs9Cl7mOf.1.1\r\n");
+}
@@ -0,0 +1,82 @@
+//---------------------------------------------------------------------
+// <copyright file="InstrumentationTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/instrumentation.h"
+#include <climits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Instrumentation_CountsLifecycleEvents")
+{
+    const microsoft::instrumentation_counters before{microsoft::instrumentation::snapshot()};
+
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    microsoft::correlation_vector extended{microsoft::correlation_vector::extend(cv.increment())};
+    microsoft::correlation_vector spun{microsoft::correlation_vector::spin(extended.value())};
+    microsoft::correlation_vector parsed{microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.2147483647")};
+    parsed.increment();
+    microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.1");
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::extend(""), std::invalid_argument);
+    REQUIRE_THROWS_AS(microsoft::correlation_vector::parse("tul4NUsfs9Cl7mOf.x"), std::invalid_argument);
+
+    const microsoft::instrumentation_counters after{microsoft::instrumentation::snapshot()};
+    if (!microsoft::instrumentation::enabled())
+    {
+        REQUIRE(after.creates == 0);
+        REQUIRE(after.increments == 0);
+        REQUIRE(after.validation_failure(microsoft::validation_result::empty) == 0);
+        return;
+    }
+
+    // Other tests may run concurrently in the same process, so only lower
+    // bounds can be checked.
+    REQUIRE(after.creates - before.creates >= 1);
+    REQUIRE(after.extends - before.extends >= 3);
+    REQUIRE(after.spins - before.spins >= 1);
+    REQUIRE(after.parses - before.parses >= 2);
+    REQUIRE(after.increments - before.increments >= 2);
+    REQUIRE(after.int_max_saturations - before.int_max_saturations >= 1);
+    REQUIRE(after.oversize_terminations - before.oversize_terminations >= 1);
+    REQUIRE(after.validation_failure(microsoft::validation_result::empty) -
+                before.validation_failure(microsoft::validation_result::empty) >=
+            1);
+    REQUIRE(after.validation_failure(microsoft::validation_result::invalid_extension) -
+                before.validation_failure(microsoft::validation_result::invalid_extension) >=
+            1);
+    REQUIRE(after.validation_failure(microsoft::validation_result::valid) == 0);
+}
+
+TEST_CASE("Instrumentation_SumsAllThreads")
+{
+    const int threadCount = 200;
+    const int increments = 1000;
+    const microsoft::instrumentation_counters before{microsoft::instrumentation::snapshot()};
+
+    // More threads than shards, so some of them share the overflow shard.
+    microsoft::correlation_vector cv;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&cv]() {
+            for (int i = 0; i < increments; ++i)
+            {
+                cv.increment();
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const microsoft::instrumentation_counters after{microsoft::instrumentation::snapshot()};
+    const uint64_t expected = microsoft::instrumentation::enabled() ? threadCount * increments : 0;
+    REQUIRE(after.increments - before.increments >= expected);
+}
@@ -0,0 +1,81 @@
+//---------------------------------------------------------------------
+// <copyright file="LatencyTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/latency.h"
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+TEST_CASE("LatencyHistogram_BucketsAreLogLinear")
+{
+    using microsoft::latency_histogram;
+
+    size_t previous = 0;
+    for (uint64_t value = 0; value < (uint64_t{1} << 20); value += 1 + value / 7)
+    {
+        const size_t bucket = latency_histogram::bucket(value);
+        REQUIRE(bucket >= previous);
+        REQUIRE(latency_histogram::highest_value(bucket) >= value);
+        REQUIRE(latency_histogram::highest_value(bucket) - value <= value / latency_histogram::SUB_BUCKETS);
+        previous = bucket;
+    }
+
+    REQUIRE(latency_histogram::bucket(31) == 31);
+    REQUIRE(latency_histogram::bucket(uint64_t{1} << 40) == latency_histogram::BUCKETS - 1);
+    REQUIRE(latency_histogram::bucket(UINT64_MAX) == latency_histogram::BUCKETS - 1);
+    REQUIRE(latency_histogram::bucket((uint64_t{1} << 40) - 1) == latency_histogram::BUCKETS - 1);
+}
+
+TEST_CASE("LatencyHistogram_PercentilesAndMerge")
+{
+    microsoft::latency_histogram low;
+    microsoft::latency_histogram high;
+    REQUIRE(low.value_at_percentile(50.0) == 0);
+
+    for (uint64_t value = 1; value <= 10000; ++value)
+    {
+        (value <= 5000 ? low : high).record(value);
+    }
+
+    low.merge(high);
+    REQUIRE(low.count() == 10000);
+    REQUIRE(low.max() == 10000);
+    REQUIRE(low.value_at_percentile(50.0) >= 5000);
+    REQUIRE(low.value_at_percentile(50.0) <= 5000 + 5000 / 16);
+    REQUIRE(low.value_at_percentile(99.0) >= 9900);
+    REQUIRE(low.value_at_percentile(99.0) <= 9900 + 9900 / 16);
+    REQUIRE(low.value_at_percentile(100.0) == 10000);
+    REQUIRE(low.value_at_percentile(0.0) == 1);
+}
+
+TEST_CASE("Latency_RecordsOperations")
+{
+    const microsoft::latency_summary before{microsoft::latency::summary(microsoft::timed_operation::extend)};
+
+    std::thread worker{[]() {
+        microsoft::correlation_vector cv{microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.1")};
+        cv.increment();
+        REQUIRE_THROWS_AS(microsoft::correlation_vector::extend("tul4NUsfs9Cl7mOf.x"), std::invalid_argument);
+    }};
+    worker.join();
+
+    const microsoft::latency_summary after{microsoft::latency::summary(microsoft::timed_operation::extend)};
+    if (!microsoft::latency::enabled())
+    {
+        REQUIRE(after.count == 0);
+        REQUIRE(after.max == 0);
+        return;
+    }
+
+    // Rejected input is timed too.
+    REQUIRE(after.count - before.count >= 2);
+    REQUIRE(after.p50 > 0);
+    REQUIRE(after.p50 <= after.p99);
+    REQUIRE(after.p99 <= after.p999);
+    REQUIRE(after.p999 <= after.max);
+    REQUIRE(microsoft::latency::summary(microsoft::timed_operation::increment).count >= 1);
+}
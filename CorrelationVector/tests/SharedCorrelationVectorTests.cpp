@@ -0,0 +1,130 @@
+//---------------------------------------------------------------------
+// <copyright file="SharedCorrelationVectorTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/shared_correlation_vector.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+TEST_CASE("SharedCorrelationVector_SharesCounterByBase")
+{
+    const std::string parent{microsoft::correlation_vector{microsoft::correlation_vector_version::v2}.value()};
+    microsoft::correlation_vector cv{microsoft::correlation_vector::extend(parent)};
+    cv.increment();
+    cv.increment();
+    microsoft::shared_correlation_vector::remove(cv);
+
+    microsoft::shared_correlation_vector first{cv};
+    // Attaching again ignores the extension of the second vector.
+    microsoft::shared_correlation_vector second{microsoft::correlation_vector::extend(parent)};
+    REQUIRE(first.value() == cv.value());
+    REQUIRE(second.value() == cv.value());
+
+    const std::string prefix{parent + "."};
+    REQUIRE(first.increment() == prefix + "3");
+    REQUIRE(second.increment() == prefix + "4");
+    REQUIRE(first.value() == prefix + "4");
+    REQUIRE(second.to_correlation_vector().value() == prefix + "4");
+    REQUIRE_FALSE(first.is_immutable());
+
+    microsoft::shared_correlation_vector moved{std::move(first)};
+    REQUIRE(moved.increment() == prefix + "5");
+    microsoft::shared_correlation_vector::remove(cv);
+}
+
+TEST_CASE("SharedCorrelationVector_TerminatesForEveryAttachedVector")
+{
+    // 121 characters, so the extension can reach 99999 before the vector
+    // would exceed 127 characters.
+    const std::string baseVector{"KZY+dsX2jEaZesgCPjJ2Ng.2147483647.2147483647.2147483647."
+                                 "2147483647.2147483647.2147483647.2147483647.2147483647.2147483647"};
+    microsoft::correlation_vector cv{microsoft::correlation_vector::parse(baseVector + ".99998")};
+    microsoft::shared_correlation_vector::remove(cv);
+    microsoft::shared_correlation_vector first{cv};
+    microsoft::shared_correlation_vector second{cv};
+
+    REQUIRE(first.increment() == baseVector + ".99999");
+    REQUIRE(second.increment() == baseVector + ".99999!");
+    REQUIRE(first.is_immutable());
+    REQUIRE(first.increment() == baseVector + ".99999!");
+    REQUIRE(first.value() == second.value());
+    microsoft::shared_correlation_vector::remove(cv);
+}
+
+#if !defined(_WIN32)
+TEST_CASE("SharedCorrelationVector_IncrementsUniquelyAcrossProcesses")
+{
+    const int processCount = 4;
+    const int increments = 2000;
+    microsoft::correlation_vector cv{microsoft::correlation_vector_version::v2};
+    const std::string value{cv.value()};
+    microsoft::shared_correlation_vector::remove(cv);
+
+    // Each child reports the extensions it received in its own slice.
+    const size_t resultsSize = sizeof(int) * processCount * increments;
+    void* memory = mmap(nullptr, resultsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    REQUIRE(memory != MAP_FAILED);
+    int* results = static_cast<int*>(memory);
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < processCount; ++p)
+    {
+        pid_t child = fork();
+        REQUIRE(child >= 0);
+        if (child == 0)
+        {
+            // The child must never return into the test runner.
+            int status = 1;
+            try
+            {
+                microsoft::shared_correlation_vector shared{microsoft::correlation_vector::parse(value)};
+                for (int i = 0; i < increments; ++i)
+                {
+                    const std::string next{shared.increment()};
+                    results[p * increments + i] = std::stoi(next.substr(next.rfind('.') + 1));
+                }
+
+                status = 0;
+            }
+            catch (...)
+            {
+            }
+
+            _exit(status);
+        }
+
+        children.push_back(child);
+    }
+
+    for (pid_t child : children)
+    {
+        int status = 0;
+        REQUIRE(waitpid(child, &status, 0) == child);
+        REQUIRE(WIFEXITED(status));
+        REQUIRE(WEXITSTATUS(status) == 0);
+    }
+
+    std::vector<int> extensions(results, results + processCount * increments);
+    munmap(memory, resultsSize);
+    std::sort(extensions.begin(), extensions.end());
+    for (size_t i = 0; i < extensions.size(); ++i)
+    {
+        REQUIRE(extensions[i] == static_cast<int>(i) + 1);
+    }
+
+    microsoft::shared_correlation_vector shared{cv};
+    REQUIRE(shared.value() == value.substr(0, value.size() - 1) +
+                                  std::to_string(processCount * increments));
+    microsoft::shared_correlation_vector::remove(cv);
+}
+#endif
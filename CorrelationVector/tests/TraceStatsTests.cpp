@@ -0,0 +1,136 @@
+//---------------------------------------------------------------------
+// <copyright file="TraceStatsTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/trace_stats.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST_CASE("TraceStats_SummarizesEachBase")
+{
+    microsoft::trace_stats stats;
+    for (const char* value : {"tul4NUsfs9Cl7mOf.1",
+                              "tul4NUsfs9Cl7mOf.1.0",
+                              "tul4NUsfs9Cl7mOf.1.7",
+                              "tul4NUsfs9Cl7mOf.1.2.3.4!",
+                              "tul4NUsfs9Cl7mOf.1.2.3.4!",
+                              "KZY+dsX2jEaZesgCPjJ2Ng.3.2969846784.0",
+                              "KZY+dsX2jEaZesgCPjJ2Ng.3.2969846784.0.1",
+                              "KZY+dsX2jEaZesgCPjJ2Ng.3.2969846784.0.1.38.1283954176.0",
+                              "KZY+dsX2jEaZesgCPjJ2Ng.3.12.2969846784.0",
+                              "tul4NUsfs9Cl7mOf. 1",
+                              "tul4NUsfs9Cl7mOf",
+                              ""})
+    {
+        stats.add(value);
+    }
+
+    REQUIRE(stats.size() == 2);
+    REQUIRE(stats.records() == 9);
+    REQUIRE(stats.rejected() == 3);
+
+    const std::vector<microsoft::trace_summary> summaries{stats.summaries()};
+    REQUIRE(summaries.size() == 2);
+    REQUIRE(summaries[0].base == "KZY+dsX2jEaZesgCPjJ2Ng");
+    REQUIRE(summaries[0].records == 4);
+    REQUIRE(summaries[0].terminated == 0);
+    REQUIRE(summaries[0].max_depth == 7);
+    REQUIRE(summaries[0].max_fan_out == 1);
+    REQUIRE(summaries[0].max_spins == 2);
+    REQUIRE(summaries[1].base == "tul4NUsfs9Cl7mOf");
+    REQUIRE(summaries[1].records == 5);
+    REQUIRE(summaries[1].terminated == 2);
+    REQUIRE(summaries[1].max_depth == 4);
+    REQUIRE(summaries[1].max_fan_out == 7);
+    REQUIRE(summaries[1].max_spins == 0);
+}
+
+TEST_CASE("TraceStats_MergesShards")
+{
+    std::vector<std::string> values;
+    for (int b = 0; b < 3000; ++b)
+    {
+        microsoft::correlation_vector root{microsoft::correlation_vector_version::v2};
+        values.push_back(root.value());
+        for (int i = 0; i <= b % 5; ++i)
+        {
+            values.push_back(root.increment());
+            values.push_back(microsoft::correlation_vector::extend(values.back()).value());
+        }
+
+        values.push_back("not a vector");
+    }
+
+    microsoft::trace_stats sequential;
+    for (const std::string& value : values)
+    {
+        sequential.add(value);
+    }
+
+    const microsoft::trace_stats parallel{microsoft::trace_stats::aggregate(values.data(), values.size(), 4)};
+    REQUIRE(parallel.size() == 3000);
+    REQUIRE(parallel.records() == sequential.records());
+    REQUIRE(parallel.rejected() == 3000);
+
+    const std::vector<microsoft::trace_summary> expected{sequential.summaries()};
+    const std::vector<microsoft::trace_summary> actual{parallel.summaries()};
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0; i < actual.size(); ++i)
+    {
+        REQUIRE(actual[i].base == expected[i].base);
+        REQUIRE(actual[i].records == expected[i].records);
+        REQUIRE(actual[i].max_depth == 2);
+        REQUIRE(actual[i].max_fan_out == expected[i].max_fan_out);
+        REQUIRE(actual[i].records == actual[i].max_fan_out * 2 + 1);
+    }
+}
+
+TEST_CASE("TraceStats_AcceptsWhatValidateAccepts")
+{
+    const std::string v1{"tul4NUsfs9Cl7mOf"};
+    const std::string v2{"KZY+dsX2jEaZesgCPjJ2Ng"};
+    microsoft::trace_stats stats;
+    const std::vector<std::string> values{
+        v1 + ".1",
+        v2 + ".0.4294967295.2147483647!",
+        v2 + ".1.4294967296.1",
+        v2 + ".1.2147483648",
+        v2 + ".00000000001.1",
+        v1 + "." + std::string(46, '0'),
+        v1 + "." + std::string(47, '0'),
+        v1 + ".1." + std::string(44, '0') + "!",
+        v2 + "." + std::string(104, '0'),
+        v2 + "." + std::string(105, '0'),
+        v2 + ".1.",
+        v2 + "..1",
+        v2 + ".1!.2",
+        v2 + ".1!!",
+        v2 + ".-1",
+        v2 + "!",
+        v2.substr(1) + ".1",
+        "tul4NUsfs9Cl7mO=.1",
+        v1 + v1 + ".1",
+        v2 + v2 + ".1",
+        "." + v1,
+        "!"};
+    for (const std::string& value : values)
+    {
+        INFO(value);
+        REQUIRE(stats.add(value) ==
+                (microsoft::correlation_vector::validate(value.data(), value.size()) ==
+                 microsoft::validation_result::valid));
+    }
+
+    REQUIRE(stats.records() == 6);
+
+    // Moving an aggregator leaves the source empty and usable.
+    microsoft::trace_stats moved{std::move(stats)};
+    REQUIRE(moved.size() == 2);
+    REQUIRE(stats.size() == 0);
+    REQUIRE(stats.add(v1 + ".2"));
+    REQUIRE(stats.size() == 1);
+}
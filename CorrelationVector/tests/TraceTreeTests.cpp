@@ -0,0 +1,99 @@
+//---------------------------------------------------------------------
+// <copyright file="TraceTreeTests.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "catch2/catch.hpp"
+#include "correlation_vector/correlation_vector.h"
+#include "correlation_vector/trace_tree.h"
+#include "parallel.h"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+microsoft::trace_forest build_forest(const std::vector<std::string>& vectors, unsigned int threads)
+{
+    microsoft::trace_forest_builder builder;
+    for (const std::string& v : vectors)
+    {
+        builder.add(v);
+    }
+
+    return builder.build(threads);
+}
+} // namespace
+
+TEST_CASE("TraceTree_ChildrenAndDescendants")
+{
+    microsoft::trace_forest forest{build_forest({"tul4NUsfs9Cl7mOf.1.0",
+                                                 "tul4NUsfs9Cl7mOf.1",
+                                                 "tul4NUsfs9Cl7mOf.1.10",
+                                                 "tul4NUsfs9Cl7mOf.1.2",
+                                                 "tul4NUsfs9Cl7mOf.1.2.0",
+                                                 "tul4NUsfs9Cl7mOf.2",
+                                                 "KZY+dsX2jEaZesgCPjJ2Ng.0"},
+                                                2)};
+
+    REQUIRE(forest.trees().size() == 2);
+    REQUIRE(forest.rejected() == 0);
+    REQUIRE(forest.children("tul4NUsfs9Cl7mOf") ==
+            std::vector<std::string>{"tul4NUsfs9Cl7mOf.1", "tul4NUsfs9Cl7mOf.2"});
+    REQUIRE(forest.children("tul4NUsfs9Cl7mOf.1") ==
+            std::vector<std::string>{"tul4NUsfs9Cl7mOf.1.0", "tul4NUsfs9Cl7mOf.1.2", "tul4NUsfs9Cl7mOf.1.10"});
+    REQUIRE(forest.descendants("tul4NUsfs9Cl7mOf.1") == std::vector<std::string>{"tul4NUsfs9Cl7mOf.1.0",
+                                                                                 "tul4NUsfs9Cl7mOf.1.2",
+                                                                                 "tul4NUsfs9Cl7mOf.1.2.0",
+                                                                                 "tul4NUsfs9Cl7mOf.1.10"});
+    REQUIRE(forest.find("tul4NUsfs9Cl7mOf.1.2.0")->parent("tul4NUsfs9Cl7mOf.1.2.0") == "tul4NUsfs9Cl7mOf.1.2");
+    REQUIRE(forest.children("KZY+dsX2jEaZesgCPjJ2Ng") == std::vector<std::string>{"KZY+dsX2jEaZesgCPjJ2Ng.0"});
+    REQUIRE(forest.children("tul4NUsfs9Cl7mOf.7").empty());
+    REQUIRE(forest.find("AAAAAAAAAAAAAAAA.1") == nullptr);
+}
+
+TEST_CASE("TraceTree_SpinSegmentsAreSkipped")
+{
+    microsoft::correlation_vector root{microsoft::correlation_vector::extend("KZY+dsX2jEaZesgCPjJ2Ng.1")};
+    microsoft::correlation_vector spun{microsoft::correlation_vector::spin(root.value())};
+    std::string spunValue{spun.value()};
+    std::string spunChild{spun.increment()};
+
+    microsoft::trace_forest forest{build_forest({root.value(), spunValue, spunChild}, 1)};
+    const microsoft::trace_tree* tree = forest.find(root.value());
+    REQUIRE(tree != nullptr);
+    REQUIRE(tree->size() == 3);
+    REQUIRE(tree->children(root.value()) == std::vector<std::string>{spunValue, spunChild});
+    REQUIRE(tree->parent(spunValue) == root.value());
+    REQUIRE(tree->parent(spunChild) == root.value());
+}
+
+TEST_CASE("TraceTree_TerminatedAndRejected")
+{
+    std::string terminated{"tul4NUsfs9Cl7mOf.2147483647.2147483647.2147483647.2147483647.0!"};
+    microsoft::trace_forest forest{build_forest({terminated, "tul4NUsfs9Cl7mOf.1", "not a cv", "tul4NUsfs9Cl7mOf.01", "tul4NUsfs9Cl7mOf.00!", "tul4NUsfs9Cl7mOf.01.2"}, 1)};
+
+    REQUIRE(forest.rejected() == 4);
+    const microsoft::trace_tree* tree = forest.find(terminated);
+    REQUIRE(tree->size() == 2);
+    REQUIRE(tree->contains(terminated));
+    REQUIRE(tree->is_terminated(terminated));
+    REQUIRE(tree->descendants("tul4NUsfs9Cl7mOf") == std::vector<std::string>{"tul4NUsfs9Cl7mOf.1", terminated});
+}
+
+TEST_CASE("ParallelFor_RethrowsFirstException")
+{
+    // The forest is built with utilities::parallel_for; a throwing task must
+    // reach the caller instead of terminating the process.
+    std::atomic<size_t> ran{0};
+    REQUIRE_THROWS_AS(microsoft::utilities::parallel_for(1000, 4, [&ran](size_t i) {
+                          ++ran;
+                          if (i == 10)
+                          {
+                              throw std::runtime_error("task failed");
+                          }
+                      }),
+                      std::runtime_error);
+    REQUIRE(ran.load() >= 11);
+}
@@ -0,0 +1,102 @@
+//---------------------------------------------------------------------
+// <copyright file="allocation_counter.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<uint64_t> g_allocations{0};
+thread_local uint64_t t_allocations = 0;
+} // namespace
+
+namespace microsoft
+{
+namespace tests
+{
+uint64_t allocations() noexcept
+{
+    return t_allocations;
+}
+
+uint64_t total_allocations() noexcept
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+} // namespace tests
+} // namespace microsoft
+
+namespace
+{
+void* allocate(std::size_t size) noexcept
+{
+    ++t_allocations;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+// Every replaceable form is defined, so that memory from one of them is never
+// released by the library's counterpart, e.g. after new (std::nothrow).
+void* operator new(std::size_t size)
+{
+    void* memory = allocate(size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+
+    return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    std::free(memory);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+#endif
@@ -0,0 +1,40 @@
+//---------------------------------------------------------------------
+// <copyright file="allocation_counter.h" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+
+namespace microsoft
+{
+namespace tests
+{
+/**
+Gets the number of allocations the calling thread made through the global
+operator new. Only executables linking allocation_counter.cpp, which
+replaces every form of the global operator new and delete, count anything.
+*/
+uint64_t allocations() noexcept;
+
+/**
+Gets the number of allocations all threads made through the global operator
+new.
+*/
+uint64_t total_allocations() noexcept;
+
+/**
+Counts the allocations the calling thread makes while running a function.
+@param function The function.
+@return The number of allocations
+*/
+template <typename Function>
+uint64_t count_allocations(Function&& function)
+{
+    const uint64_t start = allocations();
+    function();
+    return allocations() - start;
+}
+} // namespace tests
+} // namespace microsoft
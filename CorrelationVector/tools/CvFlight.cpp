@@ -0,0 +1,109 @@
+//---------------------------------------------------------------------
+// <copyright file="CvFlight.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+// cv_flight decodes a flight recorder file, e.g. after the process that wrote
+// it crashed or was killed, and prints the last Correlation Vectors of each
+// thread, oldest first. --thread keeps the records of one thread.
+//
+//   cv_flight <recorder-file> [--last <count>] [--thread <id>]
+#include "correlation_vector/flight_recorder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace
+{
+const char* operation_name(uint8_t operation)
+{
+    switch (static_cast<microsoft::flight_operation>(operation))
+    {
+        case microsoft::flight_operation::create:
+            return "create";
+        case microsoft::flight_operation::extend:
+            return "extend";
+        case microsoft::flight_operation::spin:
+            return "spin";
+        case microsoft::flight_operation::increment:
+            return "increment";
+    }
+
+    return "unknown";
+}
+
+int usage()
+{
+    std::fprintf(
+        stderr,
+        "usage: cv_flight <recorder-file> [--last <count>] [--thread <id>]\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        return usage();
+    }
+
+    size_t last = 0;
+    unsigned long long threadId = 0;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--last") == 0 && i + 1 < argc)
+        {
+            last = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--thread") == 0 && i + 1 < argc)
+        {
+            threadId = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            return usage();
+        }
+    }
+
+    try
+    {
+        const std::vector<microsoft::flight_thread> threads{
+            microsoft::flight_recorder::read(argv[1])};
+        for (const microsoft::flight_thread& thread : threads)
+        {
+            std::printf("region of thread %llu: %llu records\n",
+                        static_cast<unsigned long long>(thread.thread_id),
+                        static_cast<unsigned long long>(thread.total));
+            const size_t first =
+                last != 0 && thread.records.size() > last
+                    ? thread.records.size() - last
+                    : 0;
+            for (size_t r = first; r < thread.records.size(); ++r)
+            {
+                const microsoft::flight_record& record = thread.records[r];
+                if (threadId != 0 && record.thread_id != threadId)
+                {
+                    continue;
+                }
+
+                std::printf("  %10llu  thread %-8u %-9s %.*s\n",
+                            static_cast<unsigned long long>(record.sequence),
+                            static_cast<unsigned int>(record.thread_id),
+                            operation_name(record.operation),
+                            static_cast<int>(record.length),
+                            record.cv);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "cv_flight: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,426 @@
+//---------------------------------------------------------------------
+// <copyright file="CvScan.cpp" company="Microsoft">
+//     Copyright (c) Microsoft Corporation.  All rights reserved.
+// </copyright>
+//---------------------------------------------------------------------
+// cv_scan finds every Correlation Vector in a set of log files and writes an
+// index from base to file offsets, so that the lines of one trace can later
+// be retrieved without rescanning the logs.
+//
+//   cv_scan index <index-file> <log-file>...
+//   cv_scan query <index-file> <base-or-prefix> [--offsets-only]
+//
+// Index layout (native endianness): an index_header, the log file paths as
+// length-prefixed strings, then index_entry records sorted by base.
+#include "correlation_vector/causal_order.h"
+#include "correlation_vector/correlation_vector.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr const char INDEX_MAGIC[8] = {'C', 'V', 'I', 'D', 'X', '0', '1', 0};
+constexpr const size_t MAX_BASE_LENGTH = 22;
+constexpr const size_t CHUNK_SIZE = 16 << 20;
+
+struct index_header
+{
+    char magic[8];
+    uint32_t file_count;
+    uint32_t reserved;
+    uint64_t entry_count;
+    uint64_t entries_offset;
+};
+
+struct index_entry
+{
+    char base[MAX_BASE_LENGTH];
+    uint8_t base_length;
+    uint8_t reserved;
+    uint32_t file;
+    uint64_t offset;
+};
+
+bool operator<(const index_entry& lhs, const index_entry& rhs)
+{
+    int result = std::memcmp(lhs.base, rhs.base, MAX_BASE_LENGTH);
+    if (result != 0) return result < 0;
+    if (lhs.file != rhs.file) return lhs.file < rhs.file;
+    return lhs.offset < rhs.offset;
+}
+
+bool is_base64(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || c == '+' || c == '/';
+}
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+bool is_valid(const char* token, size_t length)
+{
+    std::string value{token, length};
+    try
+    {
+        return microsoft::correlation_vector::parse(value).value() == value;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return false;
+    }
+}
+
+// Finds the Correlation Vectors whose first '.' lies in [begin, end). Each
+// dot is a candidate: it must be preceded by exactly 16 or 22 base64
+// characters and followed by a digit before the token is validated.
+void scan_chunk(const char* data,
+                size_t size,
+                size_t begin,
+                size_t end,
+                uint32_t file,
+                std::vector<index_entry>& out)
+{
+    const char* last = data + end;
+    const char* dot = microsoft::utilities::find_byte(data + begin, last, '.');
+    while (dot < last)
+    {
+        const size_t p = static_cast<size_t>(dot - data);
+        size_t baseLength = 0;
+        while (baseLength <= MAX_BASE_LENGTH && baseLength < p &&
+               is_base64(data[p - baseLength - 1]))
+        {
+            ++baseLength;
+        }
+
+        const size_t start = p - baseLength;
+        if ((baseLength == 16 || baseLength == MAX_BASE_LENGTH) &&
+            (start == 0 || data[start - 1] != '.') && p + 1 < size &&
+            is_digit(data[p + 1]))
+        {
+            size_t e = p + 1;
+            while (e < size && (is_digit(data[e]) || data[e] == '.')) ++e;
+            while (data[e - 1] == '.') --e;
+            if (e < size &&
+                data[e] == microsoft::correlation_vector::TERMINATOR)
+            {
+                ++e;
+            }
+
+            if (is_valid(data + start, e - start))
+            {
+                index_entry entry{};
+                std::memcpy(entry.base, data + start, baseLength);
+                entry.base_length = static_cast<uint8_t>(baseLength);
+                entry.file = file;
+                entry.offset = start;
+                out.push_back(entry);
+            }
+
+            dot = data + e;
+        }
+        else
+        {
+            ++dot;
+        }
+
+        dot = microsoft::utilities::find_byte(dot, last, '.');
+    }
+}
+
+// The absolute path of an existing file, so that an index can be queried
+// from any directory.
+std::string absolute_path(const std::string& path)
+{
+#if defined(_WIN32)
+    char* resolved = _fullpath(nullptr, path.c_str(), 0);
+#else
+    char* resolved = realpath(path.c_str(), nullptr);
+#endif
+    if (!resolved)
+    {
+        throw std::runtime_error("Cannot resolve " + path);
+    }
+
+    std::string result{resolved};
+    std::free(resolved);
+    return result;
+}
+
+int build_index(const std::string& indexPath,
+                const std::vector<std::string>& logs)
+{
+    struct task
+    {
+        uint32_t file;
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<microsoft::utilities::mapped_file> files;
+    std::vector<task> tasks;
+    size_t totalBytes = 0;
+    for (const std::string& log : logs)
+    {
+        files.emplace_back(log);
+        const size_t size = files.back().size();
+        totalBytes += size;
+        for (size_t begin = 0; begin < size; begin += CHUNK_SIZE)
+        {
+#pragma push_macro("min")
+#undef min
+            tasks.push_back({static_cast<uint32_t>(files.size() - 1),
+                             begin,
+                             std::min(begin + CHUNK_SIZE, size)});
+#pragma pop_macro("min")
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<index_entry>> found(tasks.size());
+    microsoft::utilities::parallel_for(tasks.size(), 0, [&](size_t i) {
+        const task& t = tasks[i];
+        scan_chunk(files[t.file].data(),
+                   files[t.file].size(),
+                   t.begin,
+                   t.end,
+                   t.file,
+                   found[i]);
+    });
+    double scanSeconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+    std::vector<index_entry> entries;
+    for (std::vector<index_entry>& chunk : found)
+    {
+        entries.insert(entries.end(), chunk.begin(), chunk.end());
+    }
+
+    microsoft::impl::parallel_sort(
+        entries.begin(), entries.end(), std::less<index_entry>{}, 0);
+
+    std::ofstream out{indexPath, std::ios::binary | std::ios::trunc};
+    if (!out)
+    {
+        throw std::runtime_error("Cannot create " + indexPath);
+    }
+
+    index_header header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.file_count = static_cast<uint32_t>(logs.size());
+    header.entry_count = entries.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::string& log : logs)
+    {
+        const std::string path{absolute_path(log)};
+        uint32_t length = static_cast<uint32_t>(path.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(path.data(), length);
+    }
+
+    // Keep the entries 8-byte aligned so the reader can use them in place.
+    uint64_t position = static_cast<uint64_t>(out.tellp());
+    header.entries_offset = (position + 7) & ~static_cast<uint64_t>(7);
+    const char padding[8] = {};
+    out.write(padding, static_cast<std::streamsize>(header.entries_offset -
+                                                    position));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() *
+                                           sizeof(index_entry)));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out.flush())
+    {
+        throw std::runtime_error("Cannot write " + indexPath);
+    }
+
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    std::fprintf(stderr,
+                 "scanned %zu file(s), %.3f GB in %.3f s (%.3f GB/s), "
+                 "indexed %zu vector(s) in %.3f s total\n",
+                 logs.size(),
+                 totalBytes / 1e9,
+                 scanSeconds,
+                 totalBytes / 1e9 / scanSeconds,
+                 entries.size(),
+                 seconds);
+    return 0;
+}
+
+int query_index(const std::string& indexPath,
+                const std::string& prefix,
+                bool offsetsOnly)
+{
+    if (prefix.empty() || prefix.size() > MAX_BASE_LENGTH)
+    {
+        throw std::invalid_argument("Invalid base or prefix: " + prefix);
+    }
+
+    microsoft::utilities::mapped_file indexFile{indexPath};
+    const char* data = indexFile.data();
+    index_header header;
+    if (indexFile.size() < sizeof(header) ||
+        std::memcmp(data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+    {
+        throw std::runtime_error(indexPath + " is not a cv_scan index");
+    }
+
+    // Every field read from the index is checked against its size, so that a
+    // truncated or corrupt index is reported rather than read out of bounds.
+    const size_t size = indexFile.size();
+    const std::runtime_error corrupt{indexPath + " is truncated or corrupt"};
+    std::memcpy(&header, data, sizeof(header));
+    std::vector<std::string> paths;
+    size_t position = sizeof(header);
+    for (uint32_t i = 0; i < header.file_count; ++i)
+    {
+        uint32_t length;
+        if (size - position < sizeof(length))
+        {
+            throw corrupt;
+        }
+
+        std::memcpy(&length, data + position, sizeof(length));
+        position += sizeof(length);
+        if (size - position < length)
+        {
+            throw corrupt;
+        }
+
+        paths.emplace_back(data + position, length);
+        position += length;
+    }
+
+    if (header.entries_offset < position || header.entries_offset > size ||
+        header.entries_offset % alignof(index_entry) != 0 ||
+        header.entry_count >
+            (size - header.entries_offset) / sizeof(index_entry))
+    {
+        throw corrupt;
+    }
+
+    const index_entry* first =
+        reinterpret_cast<const index_entry*>(data + header.entries_offset);
+    const index_entry* last = first + header.entry_count;
+    const index_entry* it = std::lower_bound(
+        first, last, prefix, [](const index_entry& e, const std::string& p) {
+            return std::memcmp(e.base, p.data(), p.size()) < 0;
+        });
+
+    std::vector<microsoft::utilities::mapped_file> logs;
+    std::vector<int> opened(paths.size(), -1);
+    std::vector<size_t> skipped(paths.size(), 0);
+    for (; it != last &&
+           std::memcmp(it->base, prefix.data(), prefix.size()) == 0;
+         ++it)
+    {
+        if (it->file >= paths.size())
+        {
+            throw corrupt;
+        }
+
+        if (offsetsOnly)
+        {
+            std::printf("%s:%llu\n",
+                        paths[it->file].c_str(),
+                        static_cast<unsigned long long>(it->offset));
+            continue;
+        }
+
+        if (opened[it->file] < 0)
+        {
+            opened[it->file] = static_cast<int>(logs.size());
+            logs.emplace_back(paths[it->file]);
+        }
+
+        // A log that was truncated or rotated since it was indexed may no
+        // longer reach the offset.
+        const microsoft::utilities::mapped_file& log = logs[opened[it->file]];
+        if (it->offset >= log.size())
+        {
+            ++skipped[it->file];
+            continue;
+        }
+
+        size_t begin = it->offset;
+        size_t end = it->offset;
+        while (begin > 0 && log.data()[begin - 1] != '\n') --begin;
+        while (end < log.size() && log.data()[end] != '\n') ++end;
+        std::printf("%s:%llu: %.*s\n",
+                    paths[it->file].c_str(),
+                    static_cast<unsigned long long>(it->offset),
+                    static_cast<int>(end - begin),
+                    log.data() + begin);
+    }
+
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (skipped[i] != 0)
+        {
+            std::fprintf(stderr,
+                         "cv_scan: warning: skipped %zu offset(s) past the "
+                         "end of %s, which changed since it was indexed\n",
+                         skipped[i],
+                         paths[i].c_str());
+        }
+    }
+
+    return 0;
+}
+
+int usage()
+{
+    std::fprintf(stderr,
+                 "usage: cv_scan index <index-file> <log-file>...\n"
+                 "       cv_scan query <index-file> <base-or-prefix> "
+                 "[--offsets-only]\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        return usage();
+    }
+
+    try
+    {
+        const std::string command{argv[1]};
+        if (command == "index")
+        {
+            return build_index(argv[2],
+                               std::vector<std::string>(argv + 3, argv + argc));
+        }
+
+        if (command == "query")
+        {
+            bool offsetsOnly =
+                argc > 4 && std::strcmp(argv[4], "--offsets-only") == 0;
+            return query_index(argv[2], argv[3], offsetsOnly);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "cv_scan: %s\n", e.what());
+        return 1;
+    }
+
+    return usage();
+}